@@ -0,0 +1,20 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec2 fragmentTextureCoordinates;
+
+// Every texture, at binding 2 of the bindless set, after the storage buffers at binding 1
+layout(set = 0, binding = 2) uniform sampler2D textures[];
+
+// The resource indexes of the object, after the model matrix
+layout(push_constant) uniform Indexes {
+	layout(offset = 64) uint uniformBufferIndex;
+	uint textureIndex;
+} indexes;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	outColor = texture(textures[indexes.textureIndex], fragmentTextureCoordinates);
+}
@@ -0,0 +1,32 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTextureCoordinates;
+layout(location = 2) in vec3 inNormal;
+
+// Instance rate, model matrix columns
+layout(location = 3) in vec4 inModel0;
+layout(location = 4) in vec4 inModel1;
+layout(location = 5) in vec4 inModel2;
+layout(location = 6) in vec4 inModel3;
+
+// Every uniform buffer, at binding 0 of the bindless set
+layout(set = 0, binding = 0) uniform UniformObject {
+	mat4 viewProjection;
+} uniformBuffers[];
+
+// The resource indexes of the object, after the model matrix
+layout(push_constant) uniform Indexes {
+	layout(offset = 64) uint uniformBufferIndex;
+	uint textureIndex;
+} indexes;
+
+layout(location = 0) out vec2 fragmentTextureCoordinates;
+
+void main()
+{
+	const mat4 model = mat4(inModel0, inModel1, inModel2, inModel3);
+	gl_Position = uniformBuffers[indexes.uniformBufferIndex].viewProjection * model * vec4(inPosition, 1.0);
+	fragmentTextureCoordinates = inTextureCoordinates;
+}
@@ -1,4 +1,5 @@
 #include <float.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -11,9 +12,17 @@
  * Define flags
  * - sameForward: when true, the camera moves in the direction where it is looking
  * - capture: when true, the mouse is captured
+ * - fxaa: when true, the FXAA post-process pass is enabled
+ * - vsync: when true, a vertically synchronized present mode is requested
+ * - requestedSamples: the requested MSAA sample count
+ * - cachePipelines: when true, the pipeline cache is loaded and saved, false with --no-pipeline-cache
  */
 static bool sameForward = false;
 static bool capture = true;
+static bool fxaa = true;
+static bool vsync = true;
+static VkSampleCountFlagBits requestedSamples = VK_SAMPLE_COUNT_1_BIT;
+static bool cachePipelines = true;
 
 // Light position
 static FrVec3 lightPosition;
@@ -49,6 +58,44 @@ void myKeyHandler(FrKey key, FrKeyState state, void* pUserData)
 			sameForward = !sameForward;
 			break;
 
+		case FR_KEY_V:
+			// Toggle vertical synchronization
+			// The requested mode is toggled, as the surface may not support it
+			vsync = !vsync;
+			frSetPresentMode(vsync ? FR_PRESENT_MODE_FIFO : FR_PRESENT_MODE_IMMEDIATE);
+			break;
+
+		case FR_KEY_N:
+			// Cycle through 1x, 2x, 4x and 8x MSAA
+			// The requested count is cycled, as the device may clamp it
+			requestedSamples = requestedSamples >= VK_SAMPLE_COUNT_8_BIT ? VK_SAMPLE_COUNT_1_BIT : requestedSamples << 1;
+			frSetMsaaSamples(requestedSamples);
+			break;
+
+		case FR_KEY_B:
+			fxaa = !fxaa;
+			frSetPostProcessAntiAliasing(fxaa);
+			break;
+
+		case FR_KEY_I:
+		{
+			FrDrawStatistics statistics;
+			frGetDrawStatistics(&statistics);
+			printf(
+				"%"PRIu32" draws, %"PRIu32" indirect commands, %"PRIu32" instances, %"PRIu32" pipeline binds, %"PRIu32" descriptor set binds, %"PRIu32" vertex buffer binds, %"PRIu32" culled on the CPU, %"PRIu32" recording threads\n",
+				statistics.drawCount,
+				statistics.indirectCommandCount,
+				statistics.instanceCount,
+				statistics.pipelineBindCount,
+				statistics.descriptorSetBindCount,
+				statistics.vertexBufferBindCount,
+				statistics.culledCount,
+				statistics.recorderCount
+			);
+			printf("Pipelines created in %.1f ms\n", frGetPipelineCreationTime() * 1000.f);
+			break;
+		}
+
 		case FR_KEY_M:
 			capture = !capture;
 			frCaptureMouse(capture);
@@ -90,8 +137,20 @@ void myMouseMoveHandler(int32_t dx, int32_t dy, void* pUserData)
 
 // Define number of objects and buffer for lowest Zs
 #define OBJECT_COUNT 5
+#define COPY_COUNT 8
 static float lowestZs[OBJECT_COUNT];
 
+/*
+ * Main thread job writing the light to the uniform buffer of the next frame.
+ *
+ * Parameters:
+ * - pLightVoid: The light position.
+ */
+void writeLightJob(void* pLightVoid)
+{
+	memcpy(uniformBuffers.data[1].bufferDatas[frameInFlightIndex], pLightVoid, sizeof(lightPosition));
+}
+
 /*
  * Update handler called every frame.
  *
@@ -220,7 +279,11 @@ void myUpdateHandler(float elapsed, void* pUserData)
 		camera.position = frAdd(&camera.position, &movement);
 	}
 
-	memcpy(uniformBuffers.data[1].bufferDatas[frameInFlightIndex], &lightPosition, sizeof(lightPosition));
+	// The update runs while the previous frame is rendered, its buffers are written on the main thread
+	static FrVec3 pendingLightPosition;
+	pendingLightPosition = lightPosition;
+	const FrJob writeLight = {.function = writeLightJob, .pData = &pendingLightPosition};
+	frRunMainThreadJobs(1, &writeLight, NULL);
 }
 
 #define TRUC 10.f
@@ -237,12 +300,31 @@ float heightToVk(float size)
  * Main function.
  * Create and run the application.
  */
-int main(void)
+int main(int argc, char** argv)
 {
+	// Compare the pipeline creation times without the cache
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--no-pipeline-cache") == 0)
+		{
+			cachePipelines = false;
+		}
+	}
+
 	lightPosition.z = 4.f;
 
 	// Create application
-	if(frCreateApplication("My super Fraus application", 1)!= FR_SUCCESS)
+	// FXAA without MSAA, the cheapest anti-aliasing
+	const FrVulkanCreateInfo vulkanCreateInfo = {
+		.msaaSamples = requestedSamples,
+		.postProcessVertexShaderPath = "fxaa_vert.spv",
+		.postProcessFragmentShaderPath = "fxaa_frag.spv",
+		.cullComputeShaderPath = "cull_comp.spv",
+		.depthPyramidComputeShaderPath = "hiz_comp.spv",
+		.pipelineCachePath = cachePipelines ? "pipeline_cache.bin" : NULL,
+		.shaderCachePath = "shader_cache.bin"
+	};
+	if(frCreateApplication("My super Fraus application", 1, &vulkanCreateInfo)!= FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
@@ -251,6 +333,9 @@ int main(void)
 	frSetKeyHandler(myKeyHandler, NULL);
 	frSetMouseMoveHandler(myMouseMoveHandler, NULL);
 	frSetUpdateHandler(myUpdateHandler, NULL);
+	frSetUpdatePipelining(true);
+	// Simulate at 60 Hz whatever the frame rate, the renderer interpolates between the steps
+	frSetFixedTimestep(1.f / 60.f, 8);
 
 	// Capture mouse
 	frCaptureMouse(capture);
@@ -260,19 +345,35 @@ int main(void)
 	camera.yaw = 225.f * PI / 180.f;
 	camera.pitch = 2.f * PI / 3.f;
 
-	// Create pipelines
+	// Create pipelines, the scene ones compile while the assets load
+	// With the bindless set, the textured objects push the indexes of their camera and texture instead of binding a set
+	const bool useBindless = frIsBindlessAvailable();
+	const VkDescriptorType bindlessIndexTypes[] = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER};
 	FrPipelineCreateInfo pipelineInfo = {
-		.vertexShaderPath = "shader_vert.spv",
-		.fragmentShaderPath = "shader_frag.spv"
+		.vertexShaderPath = useBindless ? "bindless_vert.spv" : "shader_vert.spv",
+		.fragmentShaderPath = useBindless ? "bindless_frag.spv" : "shader_frag.spv",
+		.instanceTransforms = true,
+		.bindless = useBindless,
+		.bindlessIndexCount = useBindless ? FR_LEN(bindlessIndexTypes) : 0,
+		.bindlessIndexTypes = bindlessIndexTypes
 	};
-	if(frCreateGraphicsPipeline(&pipelineInfo) != FR_SUCCESS)
+	uint32_t pipelineIndex;
+	if(frCreateGraphicsPipelineAsync(&pipelineInfo, &pipelineIndex) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
 
+	// The ambient light of the phong shader is a specialization constant
+	const FrSpecializationConstant phongConstants[] = {
+		{.id = 0, .floatValue = 0.05f}
+	};
 	pipelineInfo.vertexShaderPath = "phong_vert.spv";
 	pipelineInfo.fragmentShaderPath = "phong_frag.spv";
-	if(frCreateGraphicsPipeline(&pipelineInfo) != FR_SUCCESS)
+	pipelineInfo.bindless = false;
+	pipelineInfo.bindlessIndexCount = 0;
+	pipelineInfo.specializationConstantCount = FR_LEN(phongConstants);
+	pipelineInfo.specializationConstants = phongConstants;
+	if(frCreateGraphicsPipelineAsync(&pipelineInfo, &pipelineIndex) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
@@ -283,6 +384,13 @@ int main(void)
 		return EXIT_FAILURE;
 	}
 
+	// Record every upload in a single batch
+	FrUploadBatch uploadBatch;
+	if(frBeginUploadBatch(&uploadBatch) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+
 	// Create objects
 	#define BUFFER_SIZE 32
 	char modelFileName[BUFFER_SIZE];
@@ -298,8 +406,9 @@ int main(void)
 			return EXIT_FAILURE;
 		}
 
-		if(frCreateTexture(textureFileName) != FR_SUCCESS) return EXIT_FAILURE;
+		if(frCreateTexture(&uploadBatch, textureFileName) != FR_SUCCESS) return EXIT_FAILURE;
 		if(frCreateObject(
+			&uploadBatch,
 			modelFileName,
 			objectIndex == 2 ? 1 : 0,
 			objectIndex == 2 ? (uint32_t[]){0, objectIndex, 1} : (uint32_t[]){0, objectIndex}
@@ -326,13 +435,20 @@ int main(void)
 	pipelineInfo.vertexInputRateCount = FR_LEN(vertexInputRates);
 	pipelineInfo.vertexInputRates = vertexInputRates;
 	pipelineInfo.vertexInputStrides = vertexInputStrides;
+	pipelineInfo.instanceTransforms = false;
 	pipelineInfo.depthTestDisable = true;
 	pipelineInfo.alphaBlendEnable = true;
+	pipelineInfo.specializationConstantCount = 0;
+	pipelineInfo.specializationConstants = NULL;
 	if(frCreateGraphicsPipeline(&pipelineInfo) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
 
+	// Much shorter from the second launch on, once the pipeline cache was saved, unless it is disabled
+	// The scene pipelines compile in the background, the I key prints the total once they are done
+	printf("Pipelines created at startup in %.1f ms, scene pipelines still compiling\n", frGetPipelineCreationTime() * 1000.f);
+
 	FrFont font;
 	if(frLoadFont("assets/font.ttf", &font) != FR_SUCCESS)
 	{
@@ -345,7 +461,7 @@ int main(void)
 	{
 		return EXIT_FAILURE;
 	}
-	if(frSetStorageBufferData(0, font.contourInfos, contourInfoSize) != FR_SUCCESS)
+	if(frSetStorageBufferData(&uploadBatch, 0, font.contourInfos, contourInfoSize) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
@@ -355,7 +471,7 @@ int main(void)
 	{
 		return EXIT_FAILURE;
 	}
-	if(frSetStorageBufferData(1, font.glyphOffsets, offsetsSize) != FR_SUCCESS)
+	if(frSetStorageBufferData(&uploadBatch, 1, font.glyphOffsets, offsetsSize) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
@@ -365,12 +481,28 @@ int main(void)
 	{
 		return EXIT_FAILURE;
 	}
-	if(frSetStorageBufferData(2, font.points, pointsSize) != FR_SUCCESS)
+	if(frSetStorageBufferData(&uploadBatch, 2, font.points, pointsSize) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
 
-	if(frCreateObject("assets/model_0.obj", 2, (uint32_t[]){1, 0, 2}) != FR_SUCCESS)
+	if(frCreateObject(&uploadBatch, "assets/model_0.obj", 2, (uint32_t[]){1, 0, 2}) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Copies of the fourth object, sharing its mesh and material, drawn as instances of a single draw
+	for(uint32_t copyIndex = 0; copyIndex < COPY_COUNT; ++copyIndex)
+	{
+		if(frCreateObject(&uploadBatch, "assets/model_3.obj", 0, (uint32_t[]){0, 3}) != FR_SUCCESS)
+		{
+			return EXIT_FAILURE;
+		}
+		frTranslation(frObjects.data[frObjects.size - 1].transformation, 4.f + 2.f * (copyIndex + 1), -5.f, -lowestZs[3]);
+	}
+
+	// The uploads run on the device while the text is laid out
+	if(frSubmitUploadBatch(&uploadBatch) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
@@ -466,11 +598,29 @@ int main(void)
 	free(truc);
 	free(truc2);
 
+	// Draw the text object as instanced quads
+	const FrObjectGeometry textGeometry = {
+		.buffer = instanceBuffer,
+		.vertexBindingCount = 2,
+		.vertexOffsets = {0, sizeof(textQuadPoints) + sizeof(textQuadIndices)},
+		.indexOffset = sizeof(textQuadPoints),
+		.indexType = VK_INDEX_TYPE_UINT16,
+		.indexCount = FR_LEN(textQuadIndices),
+		.instanceCount = instanceCount
+	};
+	if(frSetObjectGeometry(OBJECT_COUNT, &textGeometry) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+
 	if(frFreeFont(&font) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
 
+	// Wait for the uploads and release the staging buffers
+	frDestroyUploadBatch(&uploadBatch);
+
 	// Main loop
 	const int exitValue = frRunApplication();
 
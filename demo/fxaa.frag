@@ -0,0 +1,60 @@
+#version 460
+
+layout(location = 0) in vec2 fragmentUV;
+
+layout(binding = 0) uniform sampler2D scene;
+
+layout(location = 0) out vec4 fragColor;
+
+const float EDGE_THRESHOLD = 1.0 / 8.0;
+const float EDGE_THRESHOLD_MIN = 1.0 / 24.0;
+const float REDUCE_MIN = 1.0 / 128.0;
+const float REDUCE_MUL = 1.0 / 8.0;
+const float SPAN_MAX = 8.0;
+
+float luma(vec3 color)
+{
+	return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+	const vec2 texel = 1.0 / vec2(textureSize(scene, 0));
+
+	const vec4 center = texture(scene, fragmentUV);
+	const float lumaCenter = luma(center.rgb);
+	const float lumaNW = luma(texture(scene, fragmentUV + vec2(-1.0, -1.0) * texel).rgb);
+	const float lumaNE = luma(texture(scene, fragmentUV + vec2(1.0, -1.0) * texel).rgb);
+	const float lumaSW = luma(texture(scene, fragmentUV + vec2(-1.0, 1.0) * texel).rgb);
+	const float lumaSE = luma(texture(scene, fragmentUV + vec2(1.0, 1.0) * texel).rgb);
+
+	const float lumaMin = min(lumaCenter, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+	const float lumaMax = max(lumaCenter, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+	// Skip pixels that are not on an edge
+	if(lumaMax - lumaMin < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD))
+	{
+		fragColor = center;
+		return;
+	}
+
+	vec2 direction = vec2(
+		-((lumaNW + lumaNE) - (lumaSW + lumaSE)),
+		(lumaNW + lumaSW) - (lumaNE + lumaSE)
+	);
+	const float directionReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);
+	const float inverseDirectionMin = 1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+	direction = clamp(direction * inverseDirectionMin, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texel;
+
+	const vec3 colorA = 0.5 * (
+		texture(scene, fragmentUV + direction * (1.0 / 3.0 - 0.5)).rgb +
+		texture(scene, fragmentUV + direction * (2.0 / 3.0 - 0.5)).rgb
+	);
+	const vec3 colorB = colorA * 0.5 + 0.25 * (
+		texture(scene, fragmentUV - direction * 0.5).rgb +
+		texture(scene, fragmentUV + direction * 0.5).rgb
+	);
+
+	const float lumaB = luma(colorB);
+	fragColor = vec4(lumaB < lumaMin || lumaB > lumaMax ? colorA : colorB, center.a);
+}
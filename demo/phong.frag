@@ -12,9 +12,12 @@ layout(binding = 2) uniform Factor
 
 layout(location = 0) out vec4 outColor;
 
+// Light received by the faces turned away from it
+layout(constant_id = 0) const float AMBIENT = 0.05;
+
 void main()
 {
 	vec3 lightDirection = normalize(f.lightPosition - fragmentPosition);
-	float brightness = max(dot(fragmentNormal, lightDirection), 0.05);
+	float brightness = max(dot(fragmentNormal, lightDirection), AMBIENT);
 	outColor = texture(textureSampler, fragmentTextureCoordinates) * brightness;
 }
@@ -4,19 +4,21 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTextureCoordinates;
 layout(location = 2) in vec3 inNormal;
 
+// Instance rate, model matrix columns
+layout(location = 3) in vec4 inModel0;
+layout(location = 4) in vec4 inModel1;
+layout(location = 5) in vec4 inModel2;
+layout(location = 6) in vec4 inModel3;
+
 layout(binding = 0) uniform UniformObject {
 	mat4 viewProjection;
 } ubo;
 
-layout(push_constant) uniform constants
-{
-	mat4 model;
-} pc;
-
 layout(location = 0) out vec2 fragmentTextureCoordinates;
 
 void main()
 {
-	gl_Position = ubo.viewProjection * pc.model * vec4(inPosition, 1.0);
+	const mat4 model = mat4(inModel0, inModel1, inModel2, inModel3);
+	gl_Position = ubo.viewProjection * model * vec4(inPosition, 1.0);
 	fragmentTextureCoordinates = inTextureCoordinates;
 }
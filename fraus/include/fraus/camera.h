@@ -34,4 +34,13 @@ void frCreateCamera(void);
  */
 void frGetCameraMatrix(float matrix[16]);
 
+/*
+ * Get the view and projection matrix of a copy of the camera.
+ *
+ * Parameters:
+ * - pCamera: The camera.
+ * - matrix: The matrix to store the result.
+ */
+void frComputeCameraMatrix(const FrCamera* pCamera, float matrix[16]);
+
 #endif
@@ -5,12 +5,18 @@
 #include "./fonts/fonts.h"
 #include "./images/images.h"
 #include "./input.h"
+#include "./jobs.h"
 #include "./math.h"
 #include "./models/models.h"
+#include "./thread.h"
 #include "./utils.h"
 #include "./vulkan/vulkan.h"
 #include "./window.h"
 
+/*
+ * The update handler, called once per frame before rendering.
+ * It can spread its work with frRunJobs, and queue window calls with frRunMainThreadJobs.
+ */
 typedef void (*FrUpdateHandler)(float elapsed, void* pUserData);
 
 /*
@@ -19,13 +25,15 @@ typedef void (*FrUpdateHandler)(float elapsed, void* pUserData);
  * Parameters:
  * - name: The name of the application.
  * - version: The version of the application.
+ * - pCreateInfo: Renderer options, or NULL for the defaults.
  * 
  * Returns:
  * - FR_SUCCESS if everything went well
  * - FR_ERROR_FILE_NOT_FOUND if the Vulkan library could not be found
+ * - FR_ERROR_INVALID_ARGUMENT if an option is out of range
  * - FR_ERROR_UNKNOWN if some other error occured
  */
-FrResult frCreateApplication(const char* name, uint32_t version);
+FrResult frCreateApplication(const char* name, uint32_t version, const FrVulkanCreateInfo* pCreateInfo);
 
 /*
  * Destroy a Fraus application.
@@ -45,6 +53,39 @@ FrResult frDestroyApplication(void);
  */
 void frSetUpdateHandler(FrUpdateHandler handler, void* pUserData);
 
+/*
+ * Run the update handler of the next frame while the current one is rendered, disabled by default.
+ * The handler then runs on a job thread and must not create or destroy renderer resources,
+ * nor write the buffers of the frames in flight: it queues these calls with frRunMainThreadJobs.
+ * The renderer draws the camera and object transforms captured after the previous update.
+ * Call it from the main thread, outside the update handler.
+ *
+ * Parameters:
+ * - enabled: Whether the update is pipelined.
+ */
+void frSetUpdatePipelining(bool enabled);
+
+/*
+ * Call the update handler with a fixed elapsed time, as many times as needed to keep up with the real time,
+ * instead of once per frame with the time elapsed since the last one. Disabled by default.
+ * The renderer blends the camera and object transforms of the last two steps with frGetInterpolationAlpha,
+ * so frames can be rendered faster than the steps.
+ * Call it from the main thread, outside the update handler.
+ *
+ * Parameters:
+ * - step: The elapsed time of a step in seconds, 0 to disable.
+ * - maxStepCount: The most steps per frame, the simulation slows down past it instead of falling further behind.
+ */
+void frSetFixedTimestep(float step, uint32_t maxStepCount);
+
+/*
+ * Get how far the rendered frame is between the last two fixed steps.
+ *
+ * Returns:
+ * - The time elapsed since the last step, as a fraction of a step, 1 without a fixed timestep.
+ */
+float frGetInterpolationAlpha(void);
+
 /*
  * Main loop of the application.
  *
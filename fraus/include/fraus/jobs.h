@@ -0,0 +1,130 @@
+#ifndef FRAUS_JOBS_H
+#define FRAUS_JOBS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "./thread.h"
+#include "./utils.h"
+
+// Jobs each thread can queue before running the next ones immediately, a power of two
+#define FR_JOB_QUEUE_CAPACITY 1024
+// Index of the threads not started by the job system, whose jobs go to the queue of the main thread
+#define FR_JOB_THREAD_INDEX_NONE UINT32_MAX
+
+/*
+ * The function run by a job.
+ *
+ * Parameters:
+ * - pData: The data of the job.
+ */
+typedef void (*FrJobFunction)(void* pData);
+
+typedef struct FrJob
+{
+	FrJobFunction function;
+	void* pData;
+} FrJob;
+
+/*
+ * The number of jobs of a group that did not complete yet.
+ * A job depending on others waits for their counter, running other jobs meanwhile.
+ * Zero initialize it before its first use, it can be reused once it reached zero.
+ */
+typedef struct FrJobCounter
+{
+	FrAtomic pendingCount;
+} FrJobCounter;
+
+/*
+ * Start the job threads, one per logical processor besides the main thread.
+ * Called by frCreateApplication.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frCreateJobSystem(void);
+
+/*
+ * Stop the job threads. The jobs still queued are dropped, so their counters must be waited for first.
+ */
+void frDestroyJobSystem(void);
+
+/*
+ * Get the number of threads running jobs.
+ *
+ * Returns:
+ * - The number of threads running jobs, the main thread included.
+ */
+uint32_t frGetJobThreadCount(void);
+
+/*
+ * Get the index of the calling thread among the threads running jobs.
+ *
+ * Returns:
+ * - 0 on the main thread.
+ * - FR_JOB_THREAD_INDEX_NONE on a thread not started by the job system.
+ * - The index of the job thread otherwise.
+ */
+uint32_t frGetJobThreadIndex(void);
+
+/*
+ * Queue jobs on the calling thread, from which idle threads steal them.
+ * Jobs may run in any order and on any thread, the main thread included.
+ *
+ * Parameters:
+ * - jobCount: The number of jobs.
+ * - pJobs: The jobs.
+ * - pCounter: The counter incremented by the number of jobs and decremented as they complete, or NULL.
+ */
+void frRunJobs(uint32_t jobCount, const FrJob* pJobs, FrJobCounter* pCounter);
+
+/*
+ * Queue jobs that must run on the main thread, like window or queue calls.
+ * They run while the main thread waits for a counter, and once per frame before rendering.
+ *
+ * Parameters:
+ * - jobCount: The number of jobs.
+ * - pJobs: The jobs.
+ * - pCounter: The counter incremented by the number of jobs and decremented as they complete, or NULL.
+ */
+void frRunMainThreadJobs(uint32_t jobCount, const FrJob* pJobs, FrJobCounter* pCounter);
+
+/*
+ * Check whether the jobs of a counter completed, without waiting.
+ *
+ * Parameters:
+ * - pCounter: The counter.
+ *
+ * Returns:
+ * - true if the counter is zero.
+ * - false otherwise.
+ */
+bool frIsJobCounterDone(FrJobCounter* pCounter);
+
+/*
+ * Run queued jobs until the jobs of a counter completed.
+ * Job threads never run main thread jobs, so a job must not wait for them.
+ *
+ * Parameters:
+ * - pCounter: The counter.
+ */
+void frWaitJobCounter(FrJobCounter* pCounter);
+
+/*
+ * Run the queued jobs of a counter until they completed, without running any other job.
+ * Used in the middle of work other jobs must not interleave with, like the main thread ones.
+ *
+ * Parameters:
+ * - pCounter: The counter.
+ */
+void frFinishJobs(FrJobCounter* pCounter);
+
+/*
+ * Run the main thread jobs queued so far. Called by frRunApplication once per frame.
+ */
+void frRunPendingMainThreadJobs(void);
+
+#endif
@@ -38,6 +38,18 @@ typedef struct FrVertex
 	FrVec3 normal;
 } FrVertex;
 
+typedef struct FrSphere
+{
+	FrVec3 center;
+	float radius;
+} FrSphere;
+
+// Planes (a, b, c, d) facing inwards, a point is inside a plane when a * x + b * y + c * z + d >= 0
+typedef struct FrFrustum
+{
+	float planes[6][4];
+} FrFrustum;
+
 float frDot(const FrVec3* pFirst, const FrVec3* pSecond);
 void frNormalize(FrVec3* pVector);
 FrVec3 frCross(const FrVec3* pFirst, const FrVec3* pSecond);
@@ -57,4 +69,8 @@ void frPerspectiveInfiniteFar(float matrix[16], float fov, float aspect, float n
 
 void frMultiply(const float* restrict pFirst, const float* restrict pSecond, float* restrict pResult);
 
+FrSphere frBoundingSphere(uint32_t vertexCount, const FrVertex* pVertices);
+FrSphere frTransformSphere(const FrSphere* pSphere, const float matrix[16]);
+void frExtractFrustum(const float matrix[16], FrFrustum* pFrustum);
+
 #endif
@@ -0,0 +1,169 @@
+#ifndef FRAUS_THREAD_H
+#define FRAUS_THREAD_H
+
+#include <stdint.h>
+
+#include "./utils.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+/*
+ * The entry point of a thread.
+ *
+ * Parameters:
+ * - pData: The data given when creating the thread.
+ */
+typedef void (*FrThreadFunction)(void* pData);
+
+typedef struct FrThread
+{
+	#ifdef _WIN32
+	HANDLE handle;
+	#else
+	pthread_t thread;
+	#endif
+} FrThread;
+
+typedef struct FrMutex
+{
+	#ifdef _WIN32
+	SRWLOCK lock;
+	#else
+	pthread_mutex_t mutex;
+	#endif
+} FrMutex;
+
+/*
+ * A 32 bits unsigned integer accessed atomically, with sequentially consistent ordering.
+ * Zero initialization sets it to 0.
+ */
+typedef struct FrAtomic
+{
+	#ifdef _WIN32
+	volatile LONG value;
+	#else
+	_Atomic uint32_t value;
+	#endif
+} FrAtomic;
+
+typedef struct FrCondition
+{
+	#ifdef _WIN32
+	CONDITION_VARIABLE condition;
+	#else
+	pthread_cond_t condition;
+	#endif
+} FrCondition;
+
+/*
+ * Create a thread.
+ *
+ * Parameters:
+ * - function: The entry point of the thread.
+ * - pData: The data given to the entry point.
+ * - pThread: A pointer to the created thread.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frCreateThread(FrThreadFunction function, void* pData, FrThread* pThread);
+
+/*
+ * Wait for a thread to return and release it.
+ *
+ * Parameters:
+ * - thread: The thread.
+ */
+void frJoinThread(FrThread thread);
+
+/*
+ * Let another thread run on the processor of the calling one.
+ */
+void frYieldThread(void);
+
+/*
+ * Get the number of logical processors.
+ *
+ * Returns:
+ * - The number of logical processors, at least 1.
+ */
+uint32_t frGetProcessorCount(void);
+
+/*
+ * Create a mutex.
+ *
+ * Parameters:
+ * - pMutex: The mutex.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+FrResult frCreateMutex(FrMutex* pMutex);
+
+void frDestroyMutex(FrMutex* pMutex);
+void frLockMutex(FrMutex* pMutex);
+void frUnlockMutex(FrMutex* pMutex);
+
+/*
+ * Create a condition variable.
+ *
+ * Parameters:
+ * - pCondition: The condition variable.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+FrResult frCreateCondition(FrCondition* pCondition);
+
+void frDestroyCondition(FrCondition* pCondition);
+
+/*
+ * Release a locked mutex and wait for the condition to be signaled, then lock the mutex again.
+ * Wakeups may be spurious, so the waited state must be checked in a loop.
+ *
+ * Parameters:
+ * - pCondition: The condition variable.
+ * - pMutex: The mutex, locked by the calling thread.
+ */
+void frWaitCondition(FrCondition* pCondition, FrMutex* pMutex);
+
+/*
+ * Wake a thread waiting on a condition variable.
+ *
+ * Parameters:
+ * - pCondition: The condition variable.
+ */
+void frSignalCondition(FrCondition* pCondition);
+
+/*
+ * Wake every thread waiting on a condition variable.
+ *
+ * Parameters:
+ * - pCondition: The condition variable.
+ */
+void frBroadcastCondition(FrCondition* pCondition);
+
+uint32_t frAtomicLoad(FrAtomic* pAtomic);
+void frAtomicStore(FrAtomic* pAtomic, uint32_t value);
+
+/*
+ * Add to an atomic integer, wrapping around.
+ *
+ * Parameters:
+ * - pAtomic: The atomic integer.
+ * - value: The value to add, subtracting is adding its two's complement.
+ *
+ * Returns:
+ * - The new value.
+ */
+uint32_t frAtomicAdd(FrAtomic* pAtomic, uint32_t value);
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef FRAUS_UTILS_H
 #define FRAUS_UTILS_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 
 /*
  * Result type returned by most Fraus functions.
@@ -61,4 +63,54 @@ typedef int (*FrCompareFunction)(const void* pFirstVoid, const void* pSecondVoid
  */
 void frMergeSorted(size_t firstCount, const void* first, size_t secondCount, const void* second, void* restrict final, size_t elementSize, FrCompareFunction compare);
 
+/*
+ * A file written to a temporary file next to it, which replaces the file once every write succeeded,
+ * so a failed or interrupted write keeps the previous file.
+ */
+typedef struct FrFileWriter
+{
+	FILE* file;
+	const char* path;
+	char* temporaryPath;
+	// Set by the first failed write
+	bool failed;
+} FrFileWriter;
+
+/*
+ * Start writing a file.
+ *
+ * Parameters:
+ * - path: The path of the file, which must outlive the writer.
+ * - pWriter: The writer.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if the temporary file could not be created.
+ */
+FrResult frOpenFileWriter(const char* path, FrFileWriter* pWriter);
+
+/*
+ * Write data to a file, nothing is written once a write failed.
+ *
+ * Parameters:
+ * - pWriter: The writer.
+ * - data: The data.
+ * - size: The size of the data.
+ */
+void frWriteFileData(FrFileWriter* pWriter, const void* data, size_t size);
+
+/*
+ * Finish writing a file, replacing it with the temporary file if every write succeeded.
+ * The temporary file is removed otherwise.
+ *
+ * Parameters:
+ * - pWriter: The writer.
+ *
+ * Returns:
+ * - FR_SUCCESS if the file was replaced.
+ * - FR_ERROR_UNKNOWN otherwise.
+ */
+FrResult frCloseFileWriter(FrFileWriter* pWriter);
+
 #endif
@@ -0,0 +1,108 @@
+#ifndef FRAUS_VULKAN_DRAW_LIST_H
+#define FRAUS_VULKAN_DRAW_LIST_H
+
+#include <stdint.h>
+
+#include "../math.h"
+#include "../vector.h"
+
+/*
+ * Passes, drawn in this order.
+ */
+typedef enum FrDrawPass
+{
+	// Sorted by state, then front to back
+	FR_DRAW_PASS_OPAQUE,
+	// Sorted back to front, then by state
+	FR_DRAW_PASS_TRANSPARENT,
+	// Drawn last without depth test (e.g. text), sorted like opaque
+	FR_DRAW_PASS_OVERLAY
+} FrDrawPass;
+
+/*
+ * Draw key layout, from the most to the least significant bits:
+ * - pass (4 bits)
+ * - opaque and overlay: pipeline (12 bits), material (16 bits), mesh (16 bits), depth (16 bits)
+ * - transparent: depth (32 bits, reversed), pipeline (12 bits), material (16 bits)
+ * Sorting the keys in increasing order groups draws sharing a pipeline, a material and a mesh,
+ * which can then be instanced.
+ */
+#define FR_DRAW_KEY_PASS_BITS 4
+#define FR_DRAW_KEY_PIPELINE_BITS 12
+#define FR_DRAW_KEY_MATERIAL_BITS 16
+#define FR_DRAW_KEY_MESH_BITS 16
+#define FR_DRAW_KEY_DEPTH_BITS 16
+#define FR_DRAW_KEY_TRANSPARENT_DEPTH_BITS 32
+
+/*
+ * A draw submitted to the draw list.
+ */
+typedef struct FrDrawPacket
+{
+	uint64_t key;
+	uint32_t objectIndex;
+} FrDrawPacket;
+
+FR_DECLARE_VECTOR(FrDrawPacket, DrawPacket)
+FR_DECLARE_VECTOR(FrSphere, Sphere)
+
+/*
+ * State changes recorded by the last frame.
+ */
+typedef struct FrDrawStatistics
+{
+	// Draw calls recorded, an indirect call counts once
+	uint32_t drawCount;
+	// Commands written to the indirect buffer
+	uint32_t indirectCommandCount;
+	uint32_t instanceCount;
+	uint32_t pipelineBindCount;
+	uint32_t descriptorSetBindCount;
+	uint32_t vertexBufferBindCount;
+	// Objects rejected by the CPU culler, the GPU culling results are not read back
+	uint32_t culledCount;
+	// Threads that recorded the scene, 1 when it was recorded in the primary command buffer
+	uint32_t recorderCount;
+} FrDrawStatistics;
+
+/*
+ * Build a draw key.
+ *
+ * Parameters:
+ * - pass: The pass.
+ * - pipelineIndex: The pipeline, only its low FR_DRAW_KEY_PIPELINE_BITS bits are used.
+ * - material: The material, only its low FR_DRAW_KEY_MATERIAL_BITS bits are used.
+ * - mesh: The mesh, only its low FR_DRAW_KEY_MESH_BITS bits are used. Ignored by the transparent pass.
+ * - depth: The distance to the camera, any float.
+ *
+ * Returns:
+ * - The key.
+ */
+uint64_t frMakeDrawKey(FrDrawPass pass, uint32_t pipelineIndex, uint32_t material, uint32_t mesh, float depth);
+
+/*
+ * Sort draw packets by increasing key with a stable radix sort.
+ *
+ * Parameters:
+ * - count: The number of packets.
+ * - pPackets: The packets, sorted in place.
+ * - pScratch: A buffer of at least count packets.
+ */
+void frSortDrawPackets(size_t count, FrDrawPacket* pPackets, FrDrawPacket* pScratch);
+
+/*
+ * Remove the packets whose bounding sphere is outside a frustum, keeping the order of the others.
+ * Spheres are tested in blocks laid out as structures of arrays, which compilers vectorize.
+ *
+ * Parameters:
+ * - pFrustum: The frustum.
+ * - count: The number of packets.
+ * - pSpheres: The world space bounding sphere of each packet.
+ * - pPackets: The packets, compacted in place.
+ *
+ * Returns:
+ * - The number of packets left.
+ */
+size_t frCullDrawPackets(const FrFrustum* pFrustum, size_t count, const FrSphere* pSpheres, FrDrawPacket* pPackets);
+
+#endif
@@ -6,52 +6,293 @@
 // Include Vulkan
 #include <vulkan/vulkan.h>
 
+#include "../camera.h"
+#include "../jobs.h"
 #include "../math.h"
 #include "../vector.h"
 #include "../window.h"
+#include "./draw_list.h"
 
 typedef struct FrVulkanData FrVulkanData;
 
-#define FR_FRAMES_IN_FLIGHT 2
+/*
+ * Present mode preference. Unsupported modes fall back to FIFO, which is always available.
+ */
+typedef enum FrPresentMode
+{
+	// Mailbox if available, FIFO otherwise
+	FR_PRESENT_MODE_DEFAULT,
+	FR_PRESENT_MODE_FIFO,
+	FR_PRESENT_MODE_FIFO_RELAXED,
+	FR_PRESENT_MODE_MAILBOX,
+	FR_PRESENT_MODE_IMMEDIATE
+} FrPresentMode;
 
-typedef struct FrVulkanObject
+#define FR_DEFAULT_MSAA_SAMPLES VK_SAMPLE_COUNT_4_BIT
+
+// Number of frames the CPU may record ahead of the GPU
+#define FR_MAX_FRAMES_IN_FLIGHT 4
+#define FR_DEFAULT_FRAMES_IN_FLIGHT 2
+
+// Capacity of the shared mesh buffers, in vertices and indices
+#define FR_MESH_ARENA_VERTEX_CAPACITY (1 << 19)
+#define FR_MESH_ARENA_INDEX_CAPACITY (1 << 21)
+
+/*
+ * A model loaded in the mesh arena, shared by every object created from the same file.
+ */
+typedef struct FrMesh
 {
-	VkDeviceMemory memory;
-	VkBuffer buffer;
+	char* path;
+	int32_t vertexOffset;
 	uint32_t vertexCount;
 	FrVertex* vertices;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	// In model space
+	FrSphere bounds;
+} FrMesh;
+
+FR_DECLARE_VECTOR(FrMesh, Mesh)
+
+/*
+ * Vertex and index buffers shared by every mesh.
+ * Meshes are suballocated linearly and drawn with a vertex offset and a first index,
+ * so the buffers are bound once per frame.
+ */
+typedef struct FrMeshArena
+{
+	VkBuffer vertexBuffer;
+	VkDeviceMemory vertexMemory;
+	uint32_t vertexCount;
+
+	VkBuffer indexBuffer;
+	VkDeviceMemory indexMemory;
+	uint32_t indexCount;
+
+	FrMeshVector meshes;
+} FrMeshArena;
+
+/*
+ * A pipeline and the resources bound to its descriptors.
+ * Objects sharing a material have equivalent descriptor sets, so any of them can be bound to draw the others.
+ */
+typedef struct FrMaterial
+{
+	uint32_t pipelineIndex;
+	// One per descriptor of the pipeline
+	uint32_t* bindingIndexes;
+} FrMaterial;
+
+FR_DECLARE_VECTOR(FrMaterial, Material)
+
+// Size of a model matrix in the transform buffers
+#define FR_INSTANCE_TRANSFORM_SIZE (16 * sizeof(float))
+
+/*
+ * Buffers, one per frame slot, rewritten by each frame and grown on demand.
+ * They are host visible and mapped unless deviceLocal is set.
+ */
+typedef struct FrFrameBuffer
+{
+	VkBufferUsageFlags usage;
+	// Written by the device only, in device local memory and not mapped
+	bool deviceLocal;
+	VkBuffer buffers[FR_MAX_FRAMES_IN_FLIGHT];
+	VkDeviceMemory bufferMemories[FR_MAX_FRAMES_IN_FLIGHT];
+	void* bufferDatas[FR_MAX_FRAMES_IN_FLIGHT];
+	VkDeviceSize sizes[FR_MAX_FRAMES_IN_FLIGHT];
+} FrFrameBuffer;
+
+#define FR_MAX_GEOMETRY_VERTEX_BINDINGS 2
+
+/*
+ * Geometry stored outside the mesh arena (e.g. instanced quads).
+ * Every vertex binding and the indexes are read from buffer at their offset.
+ */
+typedef struct FrObjectGeometry
+{
+	VkBuffer buffer;
+	uint32_t vertexBindingCount;
+	VkDeviceSize vertexOffsets[FR_MAX_GEOMETRY_VERTEX_BINDINGS];
+	VkDeviceSize indexOffset;
+	VkIndexType indexType;
+	uint32_t indexCount;
+	uint32_t instanceCount;
+} FrObjectGeometry;
+
+typedef struct FrVulkanObject
+{
+	// Copied from the mesh, which owns the vertices
+	uint32_t meshIndex;
+	int32_t vertexOffset;
+	uint32_t vertexCount;
+	const FrVertex* vertices;
+	uint32_t firstIndex;
 	uint32_t indexCount;
 
 	float transformation[16];
 
 	uint32_t pipelineIndex;
+	uint32_t materialIndex;
+	// Cleared when the object is retired
+	bool alive;
 
-	VkDescriptorPool descriptorPool;
-	VkDescriptorSet descriptorSets[FR_FRAMES_IN_FLIGHT];
+	// From descriptorAllocator, unused by the objects of bindless pipelines
+	VkDescriptorSet descriptorSets[FR_MAX_FRAMES_IN_FLIGHT];
+
+	// Drawn instead of the mesh arena range when its buffer is not VK_NULL_HANDLE
+	FrObjectGeometry geometry;
 } FrVulkanObject;
 
 FR_DECLARE_VECTOR(FrVulkanObject, VulkanObject)
 
 typedef struct FrApplication FrApplication;
 
+/*
+ * The value of a specialization constant, the constant_id of a shader.
+ * The shaders read as many bytes as their constant holds, so the member matching its type must be set.
+ */
+typedef struct FrSpecializationConstant
+{
+	uint32_t id;
+	union
+	{
+		VkBool32 boolValue;
+		int32_t intValue;
+		uint32_t uintValue;
+		float floatValue;
+		int64_t int64Value;
+		uint64_t uint64Value;
+		double doubleValue;
+	};
+} FrSpecializationConstant;
+
+/*
+ * A graphics pipeline.
+ * The shader modules and vertex input are kept so the pipeline can be rebuilt
+ * when the render pass changes (e.g. when the sample count changes).
+ */
 typedef struct FrPipeline
 {
 	bool hasPushConstants;
+	// Binds the bindless set, the descriptor types are the ones of the resource indexes pushed by the objects
+	bool bindless;
 	VkDescriptorType* descriptorTypes;
 	uint32_t descriptorTypeCount;
+	// VK_NULL_HANDLE for bindless pipelines, which share the layout of the bindless set
 	VkDescriptorSetLayout descriptorSetLayout;
 	VkPipelineLayout pipelineLayout;
 	VkPipeline pipeline;
+
+	VkShaderModule vertexModule;
+	VkShaderModule fragmentModule;
+	uint32_t vertexBindingCount;
+	VkVertexInputBindingDescription* vertexBindings;
+	uint32_t vertexAttributeCount;
+	VkVertexInputAttributeDescription* vertexAttributes;
+	bool depthTestDisable;
+	bool alphaBlendEnable;
+	// The model matrix is read from the transform buffer instead of push constants
+	bool instanceTransforms;
+	// Both stages read the same data, the fragment map entries follow the vertex ones
+	VkSpecializationInfo vertexSpecialization;
+	VkSpecializationInfo fragmentSpecialization;
+	VkSpecializationMapEntry* specializationEntries;
+	void* specializationData;
+	// Background build, NULL once the pipeline is published
+	struct FrPipelineBuild* pBuild;
 } FrPipeline;
 
 FR_DECLARE_VECTOR(FrPipeline, Pipeline)
 
+/*
+ * A graphics pipeline created by frCreateGraphicsPipelineAsync.
+ * Its load job reflects the shaders and creates the layouts, then queues its compile job.
+ * The jobs only touch the build, which the main thread publishes into graphicsPipelines once they completed.
+ */
+typedef struct FrPipelineBuild
+{
+	// Copy of the create info, its arrays and paths follow the build in the same allocation
+	char* vertexShaderPath;
+	char* fragmentShaderPath;
+	uint32_t vertexInputRateCount;
+	VkVertexInputRate* vertexInputRates;
+	uint32_t* vertexInputStrides;
+	bool depthTestDisable;
+	bool alphaBlendEnable;
+	bool instanceTransforms;
+	bool bindless;
+	uint32_t specializationConstantCount;
+	FrSpecializationConstant* specializationConstants;
+	uint32_t bindlessIndexCount;
+	VkDescriptorType* bindlessIndexTypes;
+
+	uint32_t pipelineIndex;
+	FrPipeline pipeline;
+	VkPipeline compiledPipeline;
+	FrResult loadResult;
+	FrJobCounter loadCounter;
+	FrJobCounter compileCounter;
+} FrPipelineBuild;
+
+/*
+ * A compute pipeline, whose descriptor set layout and push constants are reflected from its shader.
+ * Like for graphics pipelines, descriptor i is at binding i.
+ */
+typedef struct FrComputePipeline
+{
+	VkDescriptorType* descriptorTypes;
+	uint32_t descriptorTypeCount;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkPipelineLayout pipelineLayout;
+	VkPipeline pipeline;
+	// 0 without push constants
+	uint32_t pushConstantSize;
+	// Workgroup size, dispatches are given in invocations
+	uint32_t localSize[3];
+} FrComputePipeline;
+
+FR_DECLARE_VECTOR(FrComputePipeline, ComputePipeline)
+
+// Resources of each type the bindless set holds, lowered to the limits of the device
+#define FR_BINDLESS_MAX_UNIFORM_BUFFERS 256
+#define FR_BINDLESS_MAX_STORAGE_BUFFERS 4096
+#define FR_BINDLESS_MAX_TEXTURES 4096
+// Offset of the resource indexes in the push constants of bindless pipelines, after the model matrix
+#define FR_BINDLESS_INDEXES_OFFSET 64
+// Resource indexes a bindless pipeline can push, filling the 128 bytes every device supports
+#define FR_BINDLESS_MAX_INDEXES 16
+
+/*
+ * Bindless descriptors: the uniform buffers (binding 0), storage buffers (binding 1) and textures (binding 2)
+ * are written once into arrays indexed like uniformBuffers, storageBuffers and textures.
+ * The set is update-after-bind and partially bound, so resources are added while frames are in flight.
+ * There is one set per frame slot, as the uniform buffers have one copy per frame slot.
+ * Once the frames using a retired resource are done, its descriptors point to a default resource of the binding:
+ * the camera uniform buffer, which is never retired, a zeroed storage buffer or a transparent texture.
+ */
+typedef struct FrBindless
+{
+	bool available;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSets[FR_MAX_FRAMES_IN_FLIGHT];
+	// Descriptor count of each binding
+	uint32_t capacities[3];
+	VkBuffer defaultStorageBuffer;
+	VkDeviceMemory defaultStorageBufferMemory;
+	VkImage defaultImage;
+	VkDeviceMemory defaultImageMemory;
+	VkImageView defaultImageView;
+} FrBindless;
+
 typedef struct FrUniformBuffer
 {
-	VkBuffer buffers[FR_FRAMES_IN_FLIGHT];
+	VkBuffer buffers[FR_MAX_FRAMES_IN_FLIGHT];
 	VkDeviceSize buffersSize;
-	VkDeviceMemory bufferMemories[FR_FRAMES_IN_FLIGHT];
-	void* bufferDatas[FR_FRAMES_IN_FLIGHT];
+	VkDeviceMemory bufferMemories[FR_MAX_FRAMES_IN_FLIGHT];
+	void* bufferDatas[FR_MAX_FRAMES_IN_FLIGHT];
 } FrUniformBuffer;
 
 FR_DECLARE_VECTOR(FrUniformBuffer, UniformBuffer)
@@ -70,10 +311,341 @@ typedef struct FrTexture
 	VkImage image;
 	VkDeviceMemory imageMemory;
 	VkImageView imageView;
+	// Created by frCreateStorageTexture, so compute dispatches can write it as a storage image
+	bool storage;
 } FrTexture;
 
 FR_DECLARE_VECTOR(FrTexture, Texture)
 
+// Sets of the first pool of a descriptor allocator, each following pool holds twice as many up to the maximum
+#define FR_DESCRIPTOR_POOL_MIN_SETS 64
+#define FR_DESCRIPTOR_POOL_MAX_SETS 4096
+// Descriptors of each type a pool holds per set
+#define FR_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET 4
+
+FR_DECLARE_VECTOR(VkDescriptorPool, DescriptorPool)
+
+typedef struct FrFreeDescriptorSet
+{
+	VkDescriptorSetLayout layout;
+	VkDescriptorSet set;
+} FrFreeDescriptorSet;
+
+FR_DECLARE_VECTOR(FrFreeDescriptorSet, FreeDescriptorSet)
+
+/*
+ * Descriptor sets of uniform buffers, storage buffers and combined image samplers, from pools created on demand.
+ * Sets given back are kept with their layout, and handed out again by the next allocations with the same layout.
+ * A linear allocator gives nothing back, it is reset wholesale once the frames using its sets are done.
+ * A zeroed allocator is empty and ready to use.
+ */
+typedef struct FrDescriptorAllocator
+{
+	FrDescriptorPoolVector pools;
+	// Pool the sets are allocated from, the following ones are empty
+	uint32_t currentPoolIndex;
+	FrFreeDescriptorSetVector freeSets;
+} FrDescriptorAllocator;
+
+typedef enum FrRetiredResourceType
+{
+	FR_RETIRED_RESOURCE_IMAGE,
+	FR_RETIRED_RESOURCE_IMAGE_VIEW,
+	FR_RETIRED_RESOURCE_MEMORY,
+	FR_RETIRED_RESOURCE_FRAMEBUFFER,
+	FR_RETIRED_RESOURCE_RENDER_PASS,
+	FR_RETIRED_RESOURCE_PIPELINE,
+	FR_RETIRED_RESOURCE_SWAPCHAIN,
+	FR_RETIRED_RESOURCE_BUFFER,
+	FR_RETIRED_RESOURCE_DESCRIPTOR_POOL,
+	FR_RETIRED_RESOURCE_DESCRIPTOR_SET,
+	FR_RETIRED_RESOURCE_BINDLESS_DESCRIPTOR
+} FrRetiredResourceType;
+
+/*
+ * A Vulkan object that may still be used by frames in flight.
+ * It is destroyed once the GPU has completed frame.
+ */
+typedef struct FrRetiredResource
+{
+	uint64_t frame;
+	FrRetiredResourceType type;
+	union
+	{
+		VkImage image;
+		VkImageView imageView;
+		VkDeviceMemory memory;
+		VkFramebuffer framebuffer;
+		VkRenderPass renderPass;
+		VkPipeline pipeline;
+		VkSwapchainKHR swapchain;
+		VkBuffer buffer;
+		VkDescriptorPool descriptorPool;
+		// Given back to its allocator instead of destroyed
+		struct
+		{
+			FrDescriptorAllocator* pDescriptorAllocator;
+			VkDescriptorSetLayout descriptorSetLayout;
+			VkDescriptorSet descriptorSet;
+		};
+		// Replaced by the default resource of its binding instead of destroyed
+		struct
+		{
+			VkDescriptorType bindlessType;
+			uint32_t bindlessIndex;
+		};
+	};
+} FrRetiredResource;
+
+FR_DECLARE_VECTOR(FrRetiredResource, RetiredResource)
+
+/*
+ * Optional fullscreen anti-aliasing pass (e.g. FXAA).
+ * When enabled, the scene is rendered into image, which the pass samples to write the swapchain image.
+ */
+typedef struct FrPostProcess
+{
+	bool enabled;
+	VkImage image;
+	VkDeviceMemory imageMemory;
+	VkImageView imageView;
+	VkSampler sampler;
+	VkRenderPass renderPass;
+	VkFramebuffer* framebuffers;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSets[FR_MAX_FRAMES_IN_FLIGHT];
+	// Whether each descriptor set still references a previous scene image
+	bool descriptorSetsOutdated[FR_MAX_FRAMES_IN_FLIGHT];
+	VkPipelineLayout pipelineLayout;
+	VkPipeline pipeline;
+} FrPostProcess;
+
+// Enough for a 65536 pixels wide depth buffer
+#define FR_DEPTH_PYRAMID_MAX_LEVELS 16
+
+// The instance is tested against the depth pyramid, only opaque instances are as blending needs their draw order
+#define FR_CULL_INSTANCE_OCCLUSION_BIT 0x1
+
+/*
+ * An instance tested by the culling compute shader, laid out as its std430 buffer.
+ * The survivors are appended to the instances of their indirect command.
+ */
+typedef struct FrCullInstance
+{
+	// Model space bounding sphere
+	FrSphere bounds;
+	// Index of the early indirect command drawing the instance, the late one follows lateCommandOffset commands later
+	uint32_t command;
+	// Index of the model matrix in the transform buffer
+	uint32_t transform;
+	// Index of the object, for its visibility in the previous frame
+	uint32_t object;
+	uint32_t flags;
+} FrCullInstance;
+
+typedef enum FrCullPhase
+{
+	// Frustum culling only, to the late commands
+	FR_CULL_PHASE_FRUSTUM,
+	// Instances visible in the previous frame, to the early commands
+	FR_CULL_PHASE_EARLY,
+	// Instances not occluded by the early draws and not drawn by them, to the late commands
+	FR_CULL_PHASE_LATE
+} FrCullPhase;
+
+/*
+ * Push constants of the culling compute shader.
+ */
+typedef struct FrCullConstants
+{
+	FrFrustum frustum;
+	uint32_t instanceCount;
+	uint32_t phase;
+	uint32_t lateCommandOffset;
+	uint32_t pyramidWidth;
+	uint32_t pyramidHeight;
+	uint32_t pyramidLevelCount;
+} FrCullConstants;
+
+/*
+ * Conservative depth of the scene drawn by the early pass, each texel holding the farthest depth it covers.
+ * Level 0 is half the size of the depth buffer, and every level halves the previous one down to 1x1.
+ * The image stays in the general layout, and every level is reduced from the previous one with its own descriptor set.
+ */
+typedef struct FrDepthPyramid
+{
+	VkImage image;
+	VkDeviceMemory imageMemory;
+	VkImageView imageView;
+	VkImageView levelViews[FR_DEPTH_PYRAMID_MAX_LEVELS];
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSets[FR_DEPTH_PYRAMID_MAX_LEVELS];
+	uint32_t width;
+	uint32_t height;
+	uint32_t levelCount;
+	// The image must be transitioned to the general layout before its first use
+	bool initialized;
+} FrDepthPyramid;
+
+/*
+ * Culling of the indirect draws in compute passes, outside of the render passes.
+ * They read the transforms of every instance and write the visible ones, compacted per command,
+ * in visibleTransformBuffer, which replaces the transform buffer as vertex binding 1.
+ * With occlusion culling, the instances visible in the previous frame are drawn first by the early render pass,
+ * the depth pyramid is built from its depth, and the others are tested against it and drawn by the main render pass.
+ */
+typedef struct FrCulling
+{
+	bool enabled;
+	FrComputePipeline pipeline;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSets[FR_MAX_FRAMES_IN_FLIGHT];
+	FrFrameBuffer instanceBuffer;
+	FrFrameBuffer visibleTransformBuffer;
+	// Occlusion culling, only with a single sample as the depth pyramid samples the depth buffer
+	bool occlusionAvailable;
+	VkSampler pyramidSampler;
+	FrComputePipeline pyramidPipeline;
+	// 1x1 and never built without occlusion culling, the culling shader still binds it
+	FrDepthPyramid pyramid;
+	// Whether each object passed the late test of the previous frame, cleared when it grows
+	VkBuffer visibilityBuffer;
+	VkDeviceMemory visibilityBufferMemory;
+	uint32_t visibilityCapacity;
+} FrCulling;
+
+// Threads recording the scene, the main thread included
+#define FR_MAX_RECORDERS 16
+// Draw packets below which a recorder costs more than it saves
+#define FR_MIN_PACKETS_PER_RECORDER 256
+
+/*
+ * A range of the draw list starting on a batch boundary,
+ * with the transforms, indirect commands and culled instances written by the draws before it.
+ */
+typedef struct FrDrawRange
+{
+	size_t packetBegin;
+	size_t packetEnd;
+	uint32_t transformOffset;
+	uint32_t commandOffset;
+	uint32_t cullInstanceOffset;
+} FrDrawRange;
+
+/*
+ * Records a range of the draw list into secondary command buffers, one per render pass.
+ * Command pools must not be used by several threads at once, so each recorder has its own per frame slot,
+ * and a single job records it per frame.
+ */
+typedef struct FrRecorder
+{
+	VkCommandPool commandPools[FR_MAX_FRAMES_IN_FLIGHT];
+	VkCommandBuffer earlyCommandBuffers[FR_MAX_FRAMES_IN_FLIGHT];
+	VkCommandBuffer commandBuffers[FR_MAX_FRAMES_IN_FLIGHT];
+	FrDrawRange range;
+	FrDrawStatistics statistics;
+	uint32_t cullInstanceCount;
+	FrResult result;
+} FrRecorder;
+
+/*
+ * The recorders, run as jobs when the draw list is large enough, the main thread recording the first one.
+ * The frame parameters are written before the jobs are queued.
+ */
+typedef struct FrRecording
+{
+	FrRecorder recorders[FR_MAX_RECORDERS];
+	uint32_t recorderCount;
+	bool occlusion;
+	uint32_t lateCommandOffset;
+	FrCullInstance* pCullInstances;
+} FrRecording;
+
+/*
+ * The state written by the update handler that the renderer reads, captured once per frame.
+ * The handler can then write the next frame's state while the captured one is rendered.
+ * With a fixed timestep, it is also captured after each step.
+ */
+typedef struct FrFrameState
+{
+	FrCamera camera;
+	// Objects created after the capture are drawn from the next frame on
+	uint32_t objectCount;
+	// One per object, indexed like frObjects
+	float (*transforms)[16];
+	size_t transformCapacity;
+} FrFrameState;
+
+// Push constants a dispatch can copy, the maxPushConstantsSize of every device
+#define FR_MAX_PUSH_CONSTANTS_SIZE 128
+// Descriptors a dispatch can bind
+#define FR_MAX_DISPATCH_BINDINGS 16
+// Dispatches queued between two captures and recorded by a frame, the others are left to the next ones
+#define FR_MAX_DISPATCHES_PER_FRAME 64
+
+/*
+ * A compute dispatch queued by the update handler.
+ */
+typedef struct FrComputeDispatch
+{
+	uint32_t pipelineIndex;
+	// Resource of each descriptor of the pipeline, indexed like for objects
+	uint32_t bindingIndexes[FR_MAX_DISPATCH_BINDINGS];
+	uint32_t groupCounts[3];
+	uint8_t pushConstants[FR_MAX_PUSH_CONSTANTS_SIZE];
+	// Whether the following dispatches wait for this one and the ones before it
+	bool barrier;
+} FrComputeDispatch;
+
+FR_DECLARE_VECTOR(FrComputeDispatch, ComputeDispatch)
+
+/*
+ * The dispatches queued since the last capture, and the captured ones, recorded before the scene of the next frame.
+ * The descriptor sets of the dispatches are transient, from the linear allocator of the frame slot.
+ */
+typedef struct FrComputeDispatches
+{
+	FrComputeDispatchVector queued;
+	FrComputeDispatchVector captured;
+} FrComputeDispatches;
+
+/*
+ * The states after the last two fixed steps, blended into the drawn state.
+ */
+typedef struct FrFrameSteps
+{
+	FrFrameState states[2];
+	uint32_t latestIndex;
+	// Steps captured so far, saturating at 2
+	uint32_t count;
+} FrFrameSteps;
+
+/*
+ * Header of the pipeline cache file, followed by dataSize bytes of cache data.
+ * The data is only reused by the device and driver that wrote it.
+ */
+typedef struct FrPipelineCacheHeader
+{
+	uint32_t magic;
+	uint32_t dataSize;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+} FrPipelineCacheHeader;
+
+#define FR_PIPELINE_CACHE_MAGIC 0x43505246 // "FRPC"
+
+typedef struct FrPipelineCache
+{
+	VkPipelineCache cache;
+	// Owned copy of the path, NULL when the cache is not saved
+	char* path;
+	// Microseconds spent in pipeline creation, added to by the threads compiling pipelines
+	FrAtomic creationTime;
+} FrPipelineCache;
+
 extern VkInstance instance;
 #ifndef NDEBUG
 extern bool debugExtensionAvailable;
@@ -84,31 +656,72 @@ extern VkPhysicalDevice physicalDevice;
 extern VkDevice device;
 extern uint32_t queueFamily;
 extern VkQueue queue;
+extern uint32_t transferQueueFamily;
+extern VkQueue transferQueue;
+extern bool multiDrawIndirectAvailable;
+extern bool drawIndirectFirstInstanceAvailable;
 
 extern VkSwapchainKHR swapchain;
 extern VkExtent2D swapchainExtent;
 extern VkFormat swapchainFormat;
+extern FrPresentMode presentModePreference;
+extern VkPresentModeKHR swapchainPresentMode;
 extern uint32_t swapchainImageCount;
 extern VkImage* swapchainImages;
 extern VkImageView* swapchainImageViews;
 
 extern VkRenderPass renderPass;
+// Draws the early occlusion culling phase, keeping the color and depth for the main render pass
+extern VkRenderPass earlyRenderPass;
 extern VkFramebuffer* framebuffers;
 
 extern FrPipelineVector graphicsPipelines;
+extern FrComputePipelineVector computePipelines;
+extern FrComputeDispatches computeDispatches;
+extern FrBindless bindless;
+extern FrDescriptorAllocator descriptorAllocator;
+extern FrDescriptorAllocator frameDescriptorAllocators[FR_MAX_FRAMES_IN_FLIGHT];
 extern FrUniformBufferVector uniformBuffers;
 extern FrStorageBufferVector storageBuffers;
 extern uint32_t textureMipLevels;
 extern FrTextureVector textures;
 extern VkSampleCountFlagBits msaaSamples;
+extern VkSampleCountFlagBits maxMsaaSamples;
+extern VkSampleCountFlagBits msaaSamplesPreference;
+extern FrPostProcess postProcess;
+extern bool postProcessPreference;
 extern FrVulkanObjectVector frObjects;
+extern FrMeshArena meshArena;
+extern FrMaterialVector materials;
+// Model matrix of every instance drawn by the frame, bound at vertex binding 1 for the pipelines created with instanceTransforms
+extern FrFrameBuffer transformBuffer;
+// Indirect draw commands of the frame
+extern FrFrameBuffer indirectBuffer;
+extern FrCulling culling;
+// World space bounding spheres of the objects culled on the CPU
+extern FrSphereVector cullSpheres;
+extern FrRetiredResourceVector retiredResources;
+extern FrDrawPacketVector drawList;
+// Radix sort buffer, as large as drawList
+extern FrDrawPacketVector drawListScratch;
+extern FrDrawStatistics drawStatistics;
 
-extern VkSemaphore imageAvailableSemaphores[FR_FRAMES_IN_FLIGHT];
-extern VkSemaphore renderFinishedSemaphores[FR_FRAMES_IN_FLIGHT];
-extern VkFence frameInFlightFences[FR_FRAMES_IN_FLIGHT];
+extern VkSemaphore imageAvailableSemaphores[FR_MAX_FRAMES_IN_FLIGHT];
+extern VkSemaphore renderFinishedSemaphores[FR_MAX_FRAMES_IN_FLIGHT];
+extern uint32_t framesInFlight;
+/*
+ * Timeline semaphore signalled with the number of each frame once the GPU finished it.
+ * Frame numbers start at 1, so its value is the number of the last completed frame.
+ */
+extern VkSemaphore frameTimelineSemaphore;
+// Number of frames submitted so far
+extern uint64_t frameCounter;
 
-extern VkCommandPool commandPools[FR_FRAMES_IN_FLIGHT];
-extern VkCommandBuffer commandBuffers[FR_FRAMES_IN_FLIGHT];
+extern VkCommandPool commandPools[FR_MAX_FRAMES_IN_FLIGHT];
+extern VkCommandBuffer commandBuffers[FR_MAX_FRAMES_IN_FLIGHT];
+extern FrRecording recording;
+extern FrFrameState frameState;
+extern FrFrameSteps frameSteps;
 
 extern VkImage colorImage;
 extern VkDeviceMemory colorImageMemory;
@@ -117,6 +730,7 @@ extern VkImage depthImage;
 extern VkDeviceMemory depthImageMemory;
 extern VkImageView depthImageView;
 extern VkSampler textureSampler;
+extern FrPipelineCache pipelineCache;
 
 extern uint32_t frameInFlightIndex;
 extern uint32_t swapchainImageIndex;
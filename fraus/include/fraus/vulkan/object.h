@@ -2,8 +2,40 @@
 #define FRAUS_VULKAN_OBJECT_H
 
 #include "./include.h"
+#include "./vulkan_utils.h"
 
-FrResult frCreateObject(const char* modelPath, uint32_t pipelineIndex, const uint32_t* bindingIndexes);
-void frDestroyObject(FrVulkanObject* pObject);
+FrResult frCreateMeshArena(void);
+void frDestroyMeshArena(void);
+
+FrResult frCreateObject(FrUploadBatch* pBatch, const char* modelPath, uint32_t pipelineIndex, const uint32_t* bindingIndexes);
+
+/*
+ * Destroy an object once the frames in flight are done with it, without waiting for the device.
+ * Its index stays reserved and it is no longer drawn.
+ *
+ * Parameters:
+ * - objectIndex: The index of the object.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if objectIndex is out of range or already retired.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the object could not be queued, in which case it is left untouched.
+ */
+FrResult frRetireObject(uint32_t objectIndex);
+
+/*
+ * Draw an object with its own geometry instead of its model.
+ * The buffer is not owned by the object and must outlive it.
+ *
+ * Parameters:
+ * - objectIndex: The index of the object.
+ * - pGeometry: The geometry.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if objectIndex is out of range, the geometry has too many vertex bindings,
+ *   or the pipeline of the object was created with instanceTransforms.
+ */
+FrResult frSetObjectGeometry(uint32_t objectIndex, const FrObjectGeometry* pGeometry);
 
 #endif
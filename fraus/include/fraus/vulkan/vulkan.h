@@ -7,9 +7,112 @@
 #include "./vulkan_utils.h"
 #include "../window.h"
 
-FrResult frCreateVulkanData(const char* name, uint32_t version);
+/*
+ * Renderer creation options. Zero-initialized fields take their default value.
+ */
+typedef struct FrVulkanCreateInfo
+{
+	// Number of frames recorded ahead of the GPU, from 1 to FR_MAX_FRAMES_IN_FLIGHT (default FR_DEFAULT_FRAMES_IN_FLIGHT)
+	uint32_t framesInFlight;
+	// Present mode preference (default FR_PRESENT_MODE_DEFAULT)
+	FrPresentMode presentMode;
+	// MSAA sample count, clamped to what the device supports (default FR_DEFAULT_MSAA_SAMPLES)
+	VkSampleCountFlagBits msaaSamples;
+	// Fullscreen anti-aliasing pass (e.g. FXAA) sampling the scene at binding 0, enabled when given
+	// Both NULL to disable, in which case frSetPostProcessAntiAliasing cannot enable it
+	const char* postProcessVertexShaderPath;
+	const char* postProcessFragmentShaderPath;
+	// Compute shader culling the instanced draws against the camera frustum, NULL to cull on the CPU
+	const char* cullComputeShaderPath;
+	// Compute shader building the depth pyramid for occlusion culling, NULL to cull against the frustum only
+	// Ignored without cullComputeShaderPath, and occlusion culling is skipped while multisampling
+	const char* depthPyramidComputeShaderPath;
+	// File the pipeline cache is loaded from at startup and saved to at shutdown, NULL to keep it in memory only
+	// A file written by another device or driver is ignored
+	const char* pipelineCachePath;
+	// File the shader reflections are loaded from at startup and saved to at shutdown, NULL to keep them in memory only
+	// Reflections are looked up by their SPIR-V code, so edited shaders are reflected again, and only the shaders used by the last launch are kept
+	const char* shaderCachePath;
+} FrVulkanCreateInfo;
+
+FrResult frCreateVulkanData(const char* name, uint32_t version, const FrVulkanCreateInfo* pCreateInfo);
 FrResult frDestroyVulkanData(void);
 
+/*
+ * Change the present mode. The swapchain is recreated before the next frame.
+ *
+ * Parameters:
+ * - presentMode: The present mode preference.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if presentMode is not a valid FrPresentMode.
+ */
+FrResult frSetPresentMode(FrPresentMode presentMode);
+
+/*
+ * Get the present mode of the current swapchain, which differs from the preference
+ * when the surface does not support it.
+ *
+ * Returns:
+ * - The present mode.
+ */
+VkPresentModeKHR frGetPresentMode(void);
+
+/*
+ * Change the MSAA sample count. The render targets and pipelines are recreated before the next frame.
+ *
+ * Parameters:
+ * - samples: The sample count, VK_SAMPLE_COUNT_1_BIT to disable MSAA.
+ *   It is clamped to the highest count supported by the device.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if samples is not a single VkSampleCountFlagBits value.
+ */
+FrResult frSetMsaaSamples(VkSampleCountFlagBits samples);
+
+/*
+ * Get the MSAA sample count in use.
+ *
+ * Returns:
+ * - The sample count.
+ */
+VkSampleCountFlagBits frGetMsaaSamples(void);
+
+/*
+ * Enable or disable the post-process anti-aliasing pass before the next frame.
+ *
+ * Parameters:
+ * - enable: Whether to enable the pass.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if enabling it while no post-process shaders were given at creation.
+ */
+FrResult frSetPostProcessAntiAliasing(bool enable);
+
+/*
+ * Get the number of the last frame the GPU finished rendering.
+ * Resources used by frame N can be reused once this returns at least N.
+ *
+ * Parameters:
+ * - pFrame: A pointer to the frame number.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frGetCompletedFrame(uint64_t* pFrame);
+
+/*
+ * Get the number of draws and state changes recorded by the last frame.
+ *
+ * Parameters:
+ * - pStatistics: A pointer to the statistics.
+ */
+void frGetDrawStatistics(FrDrawStatistics* pStatistics);
+
 typedef struct FrPipelineCreateInfo
 {
 	const char* vertexShaderPath;
@@ -21,13 +124,218 @@ typedef struct FrPipelineCreateInfo
 
 	bool depthTestDisable: 1;
 	bool alphaBlendEnable: 1;
+	/*
+	 * The vertex shader reads the model matrix as four vec4 columns at the locations following
+	 * the FrVertex attributes, from a per instance binding filled by the renderer.
+	 * Objects sharing a mesh and a material are then drawn as instances of a single draw.
+	 * The vertex input rates and strides must not be given, and the objects cannot have their own geometry.
+	 */
+	bool instanceTransforms: 1;
+	/*
+	 * The shaders use the bindless set instead of a set of their own: the uniform buffers, storage buffers
+	 * and textures are arrays at the bindings 0, 1 and 2 of the set 0, indexed like frCreateUniformBuffer,
+	 * frCreateStorageBuffer and frCreateTexture number them.
+	 * The binding indexes of the objects are pushed as uint32_t at the offset FR_BINDLESS_INDEXES_OFFSET of the
+	 * push constants, visible to the vertex and fragment stages, following the model matrix.
+	 * Requires frIsBindlessAvailable.
+	 */
+	bool bindless: 1;
+	// Types of the resources the indexes of the objects refer to, at most FR_BINDLESS_MAX_INDEXES
+	uint32_t bindlessIndexCount;
+	const VkDescriptorType* bindlessIndexTypes;
+
+	/*
+	 * Values of the specialization constants, so that one shader binary gives several compiled variants.
+	 * Each value goes to the stages declaring its constant, the others keep their default value.
+	 * Each constant is given once, and must be declared by at least one of the shaders.
+	 */
+	uint32_t specializationConstantCount;
+	const FrSpecializationConstant* specializationConstants;
 } FrPipelineCreateInfo;
 FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo);
+
+/*
+ * Check whether the device supports the bindless set, needed by bindless pipelines.
+ *
+ * Returns:
+ * - true if bindless pipelines can be created.
+ * - false otherwise.
+ */
+bool frIsBindlessAvailable(void);
+
+/*
+ * Create a graphics pipeline on the job threads.
+ * Its index can be used right away: objects can be created with it, which waits for the shader reflection only,
+ * and are drawn once the pipeline compiled.
+ *
+ * Parameters:
+ * - pCreateInfo: The create info, copied.
+ * - pPipelineIndex: A pointer to the index of the pipeline.
+ *
+ * Returns:
+ * - FR_SUCCESS if the build started, its own errors are reported by frWaitGraphicsPipeline.
+ * - FR_ERROR_INVALID_ARGUMENT if the create info is invalid.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+FrResult frCreateGraphicsPipelineAsync(const FrPipelineCreateInfo* pCreateInfo, uint32_t* pPipelineIndex);
+
+/*
+ * Check whether a graphics pipeline is compiled, so that its objects are drawn.
+ * Background builds are checked once per frame.
+ *
+ * Parameters:
+ * - pipelineIndex: The index of the pipeline.
+ *
+ * Returns:
+ * - true if the pipeline is ready.
+ * - false if it is still building, failed, or pipelineIndex is out of range.
+ */
+bool frIsGraphicsPipelineReady(uint32_t pipelineIndex);
+
+/*
+ * Wait for the background build of a graphics pipeline, helping it on the calling thread.
+ *
+ * Parameters:
+ * - pipelineIndex: The index of the pipeline.
+ *
+ * Returns:
+ * - FR_SUCCESS if the pipeline is ready.
+ * - FR_ERROR_INVALID_ARGUMENT if pipelineIndex is out of range.
+ * - FR_ERROR_UNKNOWN if the build failed.
+ */
+FrResult frWaitGraphicsPipeline(uint32_t pipelineIndex);
+
+typedef struct FrComputePipelineCreateInfo
+{
+	const char* computeShaderPath;
+} FrComputePipelineCreateInfo;
+
+/*
+ * Create a compute pipeline, its layouts come from the reflection of its shader.
+ * The shader declares its descriptors at the bindings 0 to n-1, which can be uniform buffers, storage buffers,
+ * combined image samplers and storage images, bound by index like the ones of objects.
+ * Storage images are textures created by frCreateStorageTexture, in the general layout during the dispatch only.
+ *
+ * Parameters:
+ * - pCreateInfo: The create info.
+ * - pPipelineIndex: A pointer to the index of the pipeline.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if the create info is invalid or the shader declares unsupported descriptors.
+ * - FR_ERROR_FILE_NOT_FOUND if the shader could not be found.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frCreateComputePipeline(const FrComputePipelineCreateInfo* pCreateInfo, uint32_t* pPipelineIndex);
+
+/*
+ * Queue a compute dispatch, recorded before the scene of the frame drawn after the next capture.
+ * The invocations are rounded up to whole workgroups of the local size of the shader.
+ * Dispatches run in the order they were queued, after the previous frame, and their writes are visible to the scene.
+ * A dispatch binding a resource retired before it is recorded is skipped.
+ * A storage image cannot be bound twice by the same dispatch, not even as a combined image sampler.
+ *
+ * Parameters:
+ * - pipelineIndex: The index of the compute pipeline.
+ * - bindingIndexes: The index of the uniform buffer, storage buffer or texture at each binding, copied.
+ * - invocationCounts: The number of invocations in each dimension.
+ * - pushConstants: The push constants of the shader, copied, or NULL if it has none.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if an index is out of range, a resource is retired, a storage image is not a storage texture
+ *   or is bound twice.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if FR_MAX_DISPATCHES_PER_FRAME dispatches are already queued or a memory allocation failed.
+ */
+FrResult frDispatchCompute(uint32_t pipelineIndex, const uint32_t* bindingIndexes, const uint32_t invocationCounts[3], const void* pushConstants);
+
+/*
+ * Make the writes of the dispatches queued so far visible to the ones queued next.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if no dispatch is queued.
+ */
+FrResult frComputeBarrier(void);
+
 FrResult frCreateUniformBuffer(VkDeviceSize size);
 FrResult frCreateStorageBuffer(VkDeviceSize size);
-FrResult frSetStorageBufferData(uint32_t storageBufferIndex, const void* data, VkDeviceSize size);
+FrResult frSetStorageBufferData(FrUploadBatch* pBatch, uint32_t storageBufferIndex, const void* data, VkDeviceSize size);
+
+/*
+ * Destroy a uniform buffer once the frames in flight are done with it.
+ * Its index stays reserved, and the objects using it must be retired first.
+ * Its bindless descriptors then read the camera uniform buffer.
+ *
+ * Parameters:
+ * - uniformBufferIndex: The index of the uniform buffer.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if uniformBufferIndex is out of range, is the camera uniform buffer 0, or is already retired.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the buffer could not be queued, in which case it is left untouched.
+ */
+FrResult frRetireUniformBuffer(uint32_t uniformBufferIndex);
+
+/*
+ * Destroy a storage buffer once the frames in flight are done with it.
+ * Its index stays reserved, and the objects using it must be retired first.
+ * Its bindless descriptors then read a zeroed storage buffer.
+ *
+ * Parameters:
+ * - storageBufferIndex: The index of the storage buffer.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if storageBufferIndex is out of range or already retired.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the buffer could not be queued, in which case it is left untouched.
+ */
+FrResult frRetireStorageBuffer(uint32_t storageBufferIndex);
+/*
+ * Capture the camera and the object transforms rendered by the next frame.
+ * frDrawFrame only reads the captured state, so it can run while they are updated.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+FrResult frCaptureFrameState(void);
+
+/*
+ * Capture the camera and the object transforms after a fixed step.
+ * Unlike frCaptureFrameState, it can run while a frame is drawn.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+FrResult frCaptureFrameStep(void);
+
+/*
+ * Blend the states of the last two fixed steps into the state rendered by the next frame.
+ * Transforms are blended component-wise, exact for translations and close for the small rotations of a step.
+ * Before any step was captured, the current state is captured instead.
+ *
+ * Parameters:
+ * - alpha: The time elapsed since the last step, as a fraction of a step.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+FrResult frInterpolateFrameState(float alpha);
+
 FrResult frDrawFrame(void);
 
+/*
+ * Get the time spent creating pipelines since startup, which the pipeline cache shortens.
+ *
+ * Returns:
+ * - The time in seconds.
+ */
+float frGetPipelineCreationTime(void);
+
 FrResult frRecreateSwapchain(void);
 
 #endif
@@ -3,17 +3,328 @@
 
 #include "./include.h"
 
+typedef struct FrStagingBuffer
+{
+	VkBuffer buffer;
+	VkDeviceMemory memory;
+} FrStagingBuffer;
+
+FR_DECLARE_VECTOR(FrStagingBuffer, StagingBuffer)
+
+/*
+ * A batch of transfer commands (copies, layout transitions, mipmap blits)
+ * recorded once and submitted once.
+ * When the device has a dedicated transfer queue, copies are recorded in
+ * transferCommandBuffer and released to the graphics queue family, which acquires
+ * them and runs the graphics-only work (mipmap blits) in commandBuffer.
+ * Otherwise both point to the same command buffer.
+ * Staging buffers created through the batch are kept alive until it is destroyed,
+ * and so are the resources of failed uploads, whose commands were already recorded.
+ */
+typedef struct FrUploadBatch
+{
+	VkCommandPool transferCommandPool;
+	VkCommandBuffer transferCommandBuffer;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	VkSemaphore transferSemaphore;
+	VkFence fence;
+	FrStagingBufferVector stagingBuffers;
+	FrRetiredResourceVector retiredResources;
+	bool submitted;
+} FrUploadBatch;
+
 FrResult frFindMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t* pIndex);
 
-FrResult frBeginCommandBuffer(VkCommandBuffer* pCommandBuffer);
-FrResult frEndCommandBuffer(VkCommandBuffer commandBuffer);
+/*
+ * Begin recording an upload batch.
+ *
+ * Parameters:
+ * - pBatch: The batch to begin.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frBeginUploadBatch(FrUploadBatch* pBatch);
+
+/*
+ * Create a host visible staging buffer owned by an upload batch.
+ * The buffer stays mapped and alive until the batch is destroyed.
+ *
+ * Parameters:
+ * - pBatch: The batch owning the buffer.
+ * - size: The size of the buffer.
+ * - pBuffer: A pointer to the created buffer.
+ * - ppData: A pointer to the mapped memory of the buffer.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frCreateStagingBuffer(FrUploadBatch* pBatch, VkDeviceSize size, VkBuffer* pBuffer, void** ppData);
+
+/*
+ * Submit an upload batch. No more commands can be recorded afterwards.
+ *
+ * Parameters:
+ * - pBatch: The batch to submit.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if the batch was already submitted.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frSubmitUploadBatch(FrUploadBatch* pBatch);
+
+/*
+ * Check whether the device finished executing an upload batch.
+ *
+ * Parameters:
+ * - pBatch: The batch.
+ *
+ * Returns:
+ * - true if the batch was submitted and is complete.
+ * - false otherwise.
+ */
+bool frIsUploadBatchComplete(const FrUploadBatch* pBatch);
+
+/*
+ * Wait for the device to finish executing an upload batch.
+ *
+ * Parameters:
+ * - pBatch: The batch.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if the batch was not submitted.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frWaitUploadBatch(const FrUploadBatch* pBatch);
+
+/*
+ * Destroy an upload batch, its staging buffers and its retired resources, waiting for it first if it was submitted.
+ *
+ * Parameters:
+ * - pBatch: The batch.
+ */
+void frDestroyUploadBatch(FrUploadBatch* pBatch);
+
+/*
+ * Destroy a resource once every frame submitted so far has completed.
+ *
+ * Parameters:
+ * - resource: The resource, its frame is overwritten.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the resource could not be queued, in which case it was not destroyed.
+ */
+FrResult frRetireResource(FrRetiredResource resource);
+
+/*
+ * Retire several resources at once. Either all of them or none are queued.
+ *
+ * Parameters:
+ * - resourceCount: The number of resources.
+ * - pResources: The resources.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the resources could not be queued, in which case none was destroyed.
+ */
+FrResult frRetireResources(uint32_t resourceCount, const FrRetiredResource* pResources);
+
+/*
+ * Destroy the retired resources whose frame has completed.
+ * Descriptor sets that cannot be given back to their allocator for lack of memory stay retired until a later call.
+ *
+ * Parameters:
+ * - completedFrame: The last frame completed by the GPU, UINT64_MAX to destroy everything.
+ */
+void frDestroyRetiredResources(uint64_t completedFrame);
+
+/*
+ * Make sure the buffer of the current frame slot holds at least a number of bytes.
+ * The frame that last used the slot must have completed, as the buffer may be recreated.
+ *
+ * Parameters:
+ * - pBuffer: The per-frame buffer.
+ * - size: The size needed.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_DEVICE_MEMORY if the buffer could not be created.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frReserveFrameBuffer(FrFrameBuffer* pBuffer, VkDeviceSize size);
+
+/*
+ * Destroy the buffers of every frame slot. The device must not use them anymore.
+ *
+ * Parameters:
+ * - pBuffer: The per-frame buffer.
+ */
+void frDestroyFrameBuffer(FrFrameBuffer* pBuffer);
+
+/*
+ * Allocate descriptor sets, reusing the sets given back with the same layouts first.
+ * When the current pool is full, the next one is used, created if needed.
+ *
+ * Parameters:
+ * - pAllocator: The allocator.
+ * - setCount: The number of sets.
+ * - layouts: The layout of each set.
+ * - pSets: The allocated sets.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured, like a layout with more descriptors than a pool holds.
+ */
+FrResult frAllocateDescriptorSets(FrDescriptorAllocator* pAllocator, uint32_t setCount, const VkDescriptorSetLayout* layouts, VkDescriptorSet* pSets);
+
+/*
+ * Give descriptor sets back to their allocator once the frames in flight are done with them.
+ *
+ * Parameters:
+ * - pAllocator: The allocator of the sets, which must not be linear.
+ * - setCount: The number of sets.
+ * - layouts: The layout of each set.
+ * - pSets: The sets.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the sets could not be queued, in which case they stay allocated.
+ */
+FrResult frRetireDescriptorSets(FrDescriptorAllocator* pAllocator, uint32_t setCount, const VkDescriptorSetLayout* layouts, const VkDescriptorSet* pSets);
+
+/*
+ * Free every set of a linear allocator at once, keeping its pools for the next allocations.
+ * The device must not use the sets anymore.
+ *
+ * Parameters:
+ * - pAllocator: The allocator.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+FrResult frResetDescriptorAllocator(FrDescriptorAllocator* pAllocator);
+
+/*
+ * Destroy the pools of an allocator, with their sets. The device must not use them anymore.
+ *
+ * Parameters:
+ * - pAllocator: The allocator, left empty.
+ */
+void frDestroyDescriptorAllocator(FrDescriptorAllocator* pAllocator);
 
 FrResult frCreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer* pBuffer, VkDeviceMemory* pBufferMemory);
-FrResult frCopyBuffer(VkBuffer sourceBuffer, VkBuffer destinationBuffer, VkDeviceSize size);
+FrResult frCopyBuffer(FrUploadBatch* pBatch, VkBuffer sourceBuffer, VkBuffer destinationBuffer, VkDeviceSize destinationOffset, VkDeviceSize size);
 
 FrResult frCreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage* pImage, VkDeviceMemory* pImageMemory);
 FrResult frCreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageView* pImageView);
 
-FrResult frCreateTexture(const char* path);
+/*
+ * Record a global memory barrier, e.g. between compute dispatches writing and reading the same buffers.
+ *
+ * Parameters:
+ * - commandBuffer: The command buffer.
+ * - sourceStage: The stages whose writes are waited for.
+ * - sourceAccess: The writes to make available.
+ * - destinationStage: The stages that wait.
+ * - destinationAccess: The accesses the writes are made visible to.
+ */
+void frRecordMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags sourceStage, VkAccessFlags sourceAccess, VkPipelineStageFlags destinationStage, VkAccessFlags destinationAccess);
+
+/*
+ * Record a barrier on the mip levels of a color image, transitioning its layout.
+ *
+ * Parameters:
+ * - commandBuffer: The command buffer.
+ * - image: The image.
+ * - mipLevels: The number of mip levels, from level 0.
+ * - oldLayout: The current layout, VK_IMAGE_LAYOUT_UNDEFINED to discard the content.
+ * - newLayout: The layout after the barrier, the same as oldLayout to keep it.
+ * - sourceStage: The stages whose accesses are waited for.
+ * - sourceAccess: The writes to make available.
+ * - destinationStage: The stages that wait.
+ * - destinationAccess: The accesses the writes are made visible to.
+ */
+void frRecordImageBarrier(VkCommandBuffer commandBuffer, VkImage image, uint32_t mipLevels, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags sourceStage, VkAccessFlags sourceAccess, VkPipelineStageFlags destinationStage, VkAccessFlags destinationAccess);
+
+FrResult frCreateTexture(FrUploadBatch* pBatch, const char* path);
+
+/*
+ * Create a cleared RGBA texture that compute dispatches can write as a storage image, numbered like frCreateTexture.
+ * It stays in the layout for sampling between dispatches, so objects and the bindless set sample it like any texture.
+ *
+ * Parameters:
+ * - pBatch: The upload batch clearing it.
+ * - width: The width of the texture.
+ * - height: The height of the texture.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if width or height is 0.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frCreateStorageTexture(FrUploadBatch* pBatch, uint32_t width, uint32_t height);
+
+/*
+ * Wait for the layouts of a graphics pipeline, which a background build creates before compiling it.
+ *
+ * Parameters:
+ * - pipelineIndex: The index of the pipeline.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if pipelineIndex is out of range.
+ * - The error of the build otherwise.
+ */
+FrResult frWaitGraphicsPipelineLayout(uint32_t pipelineIndex);
+
+/*
+ * Check whether a resource exists and is not retired.
+ *
+ * Parameters:
+ * - type: The descriptor type of the resource: uniform buffer, storage buffer, combined image sampler or storage image.
+ * - resourceIndex: The index of the resource in uniformBuffers, storageBuffers or textures.
+ *   A storage image must be a texture created by frCreateStorageTexture.
+ *
+ * Returns:
+ * - true if the resource can be bound.
+ * - false otherwise.
+ */
+bool frIsResourceAlive(VkDescriptorType type, uint32_t resourceIndex);
+
+/*
+ * Write a resource into the bindless set of every frame slot, at its index.
+ * A retired resource is replaced by the default resource of its binding, so no frame in flight may use the index.
+ * Does nothing without the bindless set, or when the index is past the capacity of its binding.
+ *
+ * Parameters:
+ * - type: The descriptor type of the resource: uniform buffer, storage buffer or combined image sampler.
+ * - resourceIndex: The index of the resource in uniformBuffers, storageBuffers or textures.
+ */
+void frWriteBindlessDescriptor(VkDescriptorType type, uint32_t resourceIndex);
+
+/*
+ * Destroy a texture once the frames in flight are done with it.
+ * Its index stays reserved, and the objects sampling it must be retired first.
+ * Its bindless descriptors then sample a transparent texture.
+ *
+ * Parameters:
+ * - textureIndex: The index of the texture.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if textureIndex is out of range or already retired.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the texture could not be queued, in which case it is left untouched.
+ */
+FrResult frRetireTexture(uint32_t textureIndex);
 
 #endif
@@ -23,26 +23,31 @@ void frCreateCamera(void)
 }
 
 void frGetCameraMatrix(float matrix[16])
+{
+	frComputeCameraMatrix(&camera, matrix);
+}
+
+void frComputeCameraMatrix(const FrCamera* pCamera, float matrix[16])
 {
 	// Compute objective
 	const FrVec3 objective = {
-		.x = camera.position.x + cosf(camera.yaw) * sinf(camera.pitch),
-		.y = camera.position.y + sinf(camera.yaw) * sinf(camera.pitch),
-		.z = camera.position.z + cosf(camera.pitch)
+		.x = pCamera->position.x + cosf(pCamera->yaw) * sinf(pCamera->pitch),
+		.y = pCamera->position.y + sinf(pCamera->yaw) * sinf(pCamera->pitch),
+		.z = pCamera->position.z + cosf(pCamera->pitch)
 	};
 
 	// Compute view matrix
 	float viewMatrix[16];
-	frLookAt(viewMatrix, &camera.position, &objective);
+	frLookAt(viewMatrix, &pCamera->position, &objective);
 
 	float perspectiveMatrix[16];
-	if(camera.farPlane < 0.f)
+	if(pCamera->farPlane < 0.f)
 	{
 		frPerspectiveInfiniteFar(
 			perspectiveMatrix,
 			PI / 4.f,
 			(float)swapchainExtent.width / (float)swapchainExtent.height,
-			camera.nearPlane
+			pCamera->nearPlane
 		);
 	}
 	else
@@ -51,8 +56,8 @@ void frGetCameraMatrix(float matrix[16])
 			perspectiveMatrix,
 			PI / 4.f,
 			(float)swapchainExtent.width / (float)swapchainExtent.height,
-			camera.nearPlane,
-			camera.farPlane
+			pCamera->nearPlane,
+			pCamera->farPlane
 		);
 	}
 
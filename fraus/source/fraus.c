@@ -1,5 +1,6 @@
 #include "../include/fraus/fraus.h"
 
+#include <math.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -13,9 +14,34 @@
 	static void* frVulkanLibrary = NULL;
 #endif
 
-FrResult frCreateApplication(const char* name, uint32_t version)
+/*
+ * Check the renderer options before anything is created.
+ *
+ * Parameters:
+ * - pCreateInfo: The options, or NULL.
+ *
+ * Returns:
+ * - true if the options are valid.
+ * - false otherwise.
+ */
+static bool frIsVulkanCreateInfoValid(const FrVulkanCreateInfo* pCreateInfo)
+{
+	if(!pCreateInfo)
+	{
+		return true;
+	}
+
+	return
+		pCreateInfo->framesInFlight <= FR_MAX_FRAMES_IN_FLIGHT &&
+		pCreateInfo->presentMode <= FR_PRESENT_MODE_IMMEDIATE &&
+		pCreateInfo->msaaSamples <= VK_SAMPLE_COUNT_64_BIT &&
+		!(pCreateInfo->msaaSamples & (pCreateInfo->msaaSamples - 1)) &&
+		!pCreateInfo->postProcessVertexShaderPath == !pCreateInfo->postProcessFragmentShaderPath;
+}
+
+FrResult frCreateApplication(const char* name, uint32_t version, const FrVulkanCreateInfo* pCreateInfo)
 {
-	if(!name || frVulkanLibrary)
+	if(!name || frVulkanLibrary || !frIsVulkanCreateInfoValid(pCreateInfo))
 	{
 		return FR_ERROR_INVALID_ARGUMENT;
 	}
@@ -59,7 +85,12 @@ FrResult frCreateApplication(const char* name, uint32_t version)
 		return FR_ERROR_UNKNOWN;
 	}
 
-	if(frCreateVulkanData(name, version) != FR_SUCCESS)
+	if(frCreateJobSystem() != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	if(frCreateVulkanData(name, version, pCreateInfo) != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
@@ -83,6 +114,7 @@ FrResult frDestroyApplication(void)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
+	frDestroyJobSystem();
 
 #ifdef _WIN32
 	if(!FreeLibrary(frVulkanLibrary))
@@ -114,6 +146,170 @@ void frSetUpdateHandler(FrUpdateHandler handler, void* pUserData)
 	pUpdateHandlerUserData = pUserData;
 }
 
+/*
+ * The update handler calls of a frame.
+ */
+typedef struct FrUpdate
+{
+	float elapsed;
+	uint32_t stepCount;
+	// Only with a fixed timestep
+	float alpha;
+	bool fixed;
+} FrUpdate;
+
+static bool updatePipelining;
+// The pipelined update running while the current frame is rendered
+static FrJobCounter updateCounter;
+static FrUpdate pipelinedUpdate;
+// Written by the pipelined update before its counter is decremented
+static FrResult pipelinedUpdateResult;
+
+static float fixedStep;
+static uint32_t maxFixedStepCount;
+// Time not simulated yet by the fixed steps
+static float accumulatedTime;
+// Alpha of the steps last run, written by the update before its counter is decremented
+static float interpolationAlpha = 1.f;
+
+void frSetUpdatePipelining(bool enabled)
+{
+	updatePipelining = enabled;
+}
+
+void frSetFixedTimestep(float step, uint32_t maxStepCount)
+{
+	// The running update may be capturing steps
+	frWaitJobCounter(&updateCounter);
+
+	fixedStep = step > 0.f ? step : 0.f;
+	maxFixedStepCount = maxStepCount ? maxStepCount : 1;
+	accumulatedTime = 0.f;
+	interpolationAlpha = 1.f;
+	frameSteps.count = 0;
+}
+
+float frGetInterpolationAlpha(void)
+{
+	return interpolationAlpha;
+}
+
+/*
+ * Call the update handler for a frame, capturing the state after each fixed step.
+ *
+ * Parameters:
+ * - pUpdate: The update.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+static FrResult frRunUpdate(const FrUpdate* pUpdate)
+{
+	for(uint32_t stepIndex = 0; stepIndex < pUpdate->stepCount; ++stepIndex)
+	{
+		updateHandler(pUpdate->elapsed, pUpdateHandlerUserData);
+
+		if(pUpdate->fixed && frCaptureFrameStep() != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+
+	if(pUpdate->fixed)
+	{
+		interpolationAlpha = pUpdate->alpha;
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Job running the pipelined update.
+ *
+ * Parameters:
+ * - pUpdateVoid: The update.
+ */
+static void frUpdateJob(void* pUpdateVoid)
+{
+	pipelinedUpdateResult = frRunUpdate(pUpdateVoid);
+}
+
+/*
+ * Update the application and capture the state drawn by the next frame.
+ * With a pipelined update, the state of the previous update is captured instead,
+ * and the handler starts for the following frame.
+ *
+ * Parameters:
+ * - pLastTime: The time of the last update, overwritten.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frUpdateApplication(struct timespec* pLastTime)
+{
+	struct timespec currentTime;
+	if(timespec_get(&currentTime, TIME_UTC) != TIME_UTC)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	const float elapsed = ((currentTime.tv_sec - pLastTime->tv_sec) * UINTMAX_C(1000000000) + currentTime.tv_nsec - pLastTime->tv_nsec) / 1000000000.f;
+	*pLastTime = currentTime;
+
+	FrUpdate update = {
+		.elapsed = elapsed,
+		.stepCount = 1
+	};
+	if(fixedStep > 0.f)
+	{
+		accumulatedTime += elapsed;
+		const float stepCount = floorf(accumulatedTime / fixedStep);
+		update = (FrUpdate){
+			.elapsed = fixedStep,
+			.stepCount = stepCount < (float)maxFixedStepCount ? (uint32_t)stepCount : maxFixedStepCount,
+			.fixed = true
+		};
+		accumulatedTime -= (float)update.stepCount * fixedStep;
+
+		// Too far behind, the time left is dropped
+		if(accumulatedTime >= fixedStep)
+		{
+			accumulatedTime = fmodf(accumulatedTime, fixedStep);
+		}
+		update.alpha = accumulatedTime / fixedStep;
+	}
+
+	// The event loop waited for the pipelined update of the previous frame
+	const FrResult updateResult = updatePipelining ? pipelinedUpdateResult : frRunUpdate(&update);
+	if(updateResult != FR_SUCCESS)
+	{
+		return updateResult;
+	}
+
+	// Window and queue calls queued by jobs
+	frRunPendingMainThreadJobs();
+
+	// The steps of the pipelined update are those of the previous frame, along with their alpha
+	if(fixedStep > 0.f ? frInterpolateFrameState(interpolationAlpha) != FR_SUCCESS : frCaptureFrameState() != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	if(updatePipelining)
+	{
+		pipelinedUpdate = update;
+		const FrJob job = {
+			.function = frUpdateJob,
+			.pData = &pipelinedUpdate
+		};
+		frRunJobs(1, &job, &updateCounter);
+	}
+
+	return FR_SUCCESS;
+}
+
 /*
  * Main loop of the application.
  *
@@ -122,18 +318,21 @@ void frSetUpdateHandler(FrUpdateHandler handler, void* pUserData)
  */
 int frRunApplication(void)
 {
-	struct timespec lastTime, currentTime;
+	struct timespec lastTime;
 	if(timespec_get(&lastTime, TIME_UTC) != TIME_UTC)
 	{
 		return EXIT_FAILURE;
 	}
 
-#ifdef _WIN32
 	int returnValue;
+#ifdef _WIN32
 	RECT clientRect;
 	MSG message;
 	while(true)
 	{
+		// The event handlers do not run concurrently with the pipelined update
+		frWaitJobCounter(&updateCounter);
+
 		// Handle events
 		while(PeekMessage(&message, NULL, 0, 0, PM_REMOVE))
 		{
@@ -153,15 +352,11 @@ int frRunApplication(void)
 		frUpdateGamepad();
 
 		// Update
-		if(timespec_get(&currentTime, TIME_UTC) != TIME_UTC)
+		if(frUpdateApplication(&lastTime) != FR_SUCCESS)
 		{
-			return FR_ERROR_UNKNOWN;
+			returnValue = EXIT_FAILURE;
+			goto end;
 		}
-		updateHandler(
-			((currentTime.tv_sec - lastTime.tv_sec) * UINTMAX_C(1000000000) + currentTime.tv_nsec - lastTime.tv_nsec) / 1000000000.f,
-			pUpdateHandlerUserData
-		);
-		lastTime = currentTime;
 
 		// Render
 		if(windowResized)
@@ -191,31 +386,27 @@ int frRunApplication(void)
 			}
 		}
 	}
-	end:
 #else
 	XEvent event;
+	// Interactive resizes send a storm of ConfigureNotify events, only the last size of each batch is used
+	int windowWidth = 0;
+	int windowHeight = 0;
+	int pendingWidth = 0;
+	int pendingHeight = 0;
 	while(true)
 	{
-		while(XQLength(display) > 0)
+		// The event handlers do not run concurrently with the pipelined update
+		frWaitJobCounter(&updateCounter);
+
+		while(XPending(display) > 0)
 		{
 			XNextEvent(display, &event);
 			switch(event.type)
 			{
 				case ConfigureNotify:
-				{
-					if(eventHandlers.resizeHandler)
-					{
-						eventHandlers.resizeHandler(
-							event.xconfigure.width,
-							event.xconfigure.height,
-							eventHandlers.pResizeHandlerUserData
-						);
-					}
-
-					windowResized = true;
-
+					pendingWidth = event.xconfigure.width;
+					pendingHeight = event.xconfigure.height;
 					break;
-				}
 
 				case KeyPress:
 					if(eventHandlers.keyHandler)
@@ -265,6 +456,31 @@ int frRunApplication(void)
 			}
 		}
 
+		// Moving the window also sends ConfigureNotify, only a new size needs a new swapchain
+		if(pendingWidth != windowWidth || pendingHeight != windowHeight)
+		{
+			windowWidth = pendingWidth;
+			windowHeight = pendingHeight;
+
+			if(eventHandlers.resizeHandler)
+			{
+				eventHandlers.resizeHandler(
+					windowWidth,
+					windowHeight,
+					eventHandlers.pResizeHandlerUserData
+				);
+			}
+
+			windowResized = true;
+		}
+
+		// Update
+		if(frUpdateApplication(&lastTime) != FR_SUCCESS)
+		{
+			returnValue = EXIT_FAILURE;
+			goto end;
+		}
+
 		if(windowResized)
 		{
 			XWindowAttributes attributes;
@@ -274,11 +490,13 @@ int frRunApplication(void)
 			{
 				if(frRecreateSwapchain() != FR_SUCCESS)
 				{
-					return EXIT_FAILURE;
+					returnValue = EXIT_FAILURE;
+					goto end;
 				}
 				if(frDrawFrame() != FR_SUCCESS)
 				{
-					return EXIT_FAILURE;
+					returnValue = EXIT_FAILURE;
+					goto end;
 				}
 			}
 		}
@@ -286,13 +504,15 @@ int frRunApplication(void)
 		{
 			if(frDrawFrame() != FR_SUCCESS)
 			{
-				return EXIT_FAILURE;
+				returnValue = EXIT_FAILURE;
+				goto end;
 			}
 		}
 	}
-
-	return EXIT_SUCCESS;
 #endif
+	// The pipelined update may still be running
+	end:
+	frWaitJobCounter(&updateCounter);
 	if(vkDeviceWaitIdle(device) != VK_SUCCESS)
 	{
 		return EXIT_FAILURE;
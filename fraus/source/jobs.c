@@ -0,0 +1,421 @@
+#include "../include/fraus/jobs.h"
+
+#include <stdlib.h>
+
+#ifdef _MSC_VER
+	#define FR_THREAD_LOCAL __declspec(thread)
+#else
+	#define FR_THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct FrQueuedJob
+{
+	FrJob job;
+	FrJobCounter* pCounter;
+} FrQueuedJob;
+
+/*
+ * A double ended queue of jobs. Its thread pushes and pops at the bottom, in last in first out order
+ * for cache locality, while the other threads steal the oldest jobs at the top.
+ */
+typedef struct FrJobQueue
+{
+	FrMutex mutex;
+	FrQueuedJob jobs[FR_JOB_QUEUE_CAPACITY];
+	// Indices wrap around, the queue holds bottom - top jobs
+	uint32_t top;
+	uint32_t bottom;
+} FrJobQueue;
+
+typedef struct FrJobSystem
+{
+	// One queue per processor, the main thread's first, some unused if a thread failed to start
+	FrJobQueue* queues;
+	uint32_t queueCount;
+	FrThread* threads;
+	uint32_t threadCount;
+	// Never stolen
+	FrJobQueue mainThreadQueue;
+	// Jobs in the stealable queues, the idle threads sleep while it is zero
+	FrAtomic queuedJobCount;
+	FrMutex sleepMutex;
+	FrCondition sleepCondition;
+	bool quit;
+} FrJobSystem;
+
+static FrJobSystem jobSystem;
+// The threads the job system did not start must not take the main thread jobs
+static FR_THREAD_LOCAL uint32_t jobThreadIndex = FR_JOB_THREAD_INDEX_NONE;
+
+static FrResult frCreateJobQueue(FrJobQueue* pQueue)
+{
+	pQueue->top = 0;
+	pQueue->bottom = 0;
+	return frCreateMutex(&pQueue->mutex);
+}
+
+/*
+ * Push a job at the bottom of a queue.
+ *
+ * Returns:
+ * - true if the job was queued.
+ * - false if the queue is full.
+ */
+static bool frPushJob(FrJobQueue* pQueue, const FrQueuedJob* pJob)
+{
+	frLockMutex(&pQueue->mutex);
+	const bool full = pQueue->bottom - pQueue->top == FR_JOB_QUEUE_CAPACITY;
+	if(!full)
+	{
+		pQueue->jobs[pQueue->bottom++ & (FR_JOB_QUEUE_CAPACITY - 1)] = *pJob;
+	}
+	frUnlockMutex(&pQueue->mutex);
+
+	return !full;
+}
+
+/*
+ * Take a job from a queue, the newest one for its thread or the oldest one for the others.
+ * A job of a given counter may be buried under other jobs, the closest one to the end is then taken.
+ *
+ * Parameters:
+ * - pQueue: The queue.
+ * - steal: Whether the oldest job is taken.
+ * - pCounter: The counter of the job to take, or NULL for any job.
+ * - pJob: The job taken.
+ *
+ * Returns:
+ * - true if a job was taken.
+ * - false if the queue holds no job of the counter.
+ */
+static bool frTakeJobFromQueue(FrJobQueue* pQueue, bool steal, const FrJobCounter* pCounter, FrQueuedJob* pJob)
+{
+	frLockMutex(&pQueue->mutex);
+	const uint32_t jobCount = pQueue->bottom - pQueue->top;
+	uint32_t position = 0;
+	while(position < jobCount && pCounter && pQueue->jobs[(steal ? pQueue->top + position : pQueue->bottom - 1 - position) & (FR_JOB_QUEUE_CAPACITY - 1)].pCounter != pCounter)
+	{
+		++position;
+	}
+	const bool taken = position < jobCount;
+	if(taken)
+	{
+		// Close the gap towards the end the job was taken from
+		if(steal)
+		{
+			*pJob = pQueue->jobs[(pQueue->top + position) & (FR_JOB_QUEUE_CAPACITY - 1)];
+			for(uint32_t jobIndex = pQueue->top + position; jobIndex != pQueue->top; --jobIndex)
+			{
+				pQueue->jobs[jobIndex & (FR_JOB_QUEUE_CAPACITY - 1)] = pQueue->jobs[(jobIndex - 1) & (FR_JOB_QUEUE_CAPACITY - 1)];
+			}
+			++pQueue->top;
+		}
+		else
+		{
+			*pJob = pQueue->jobs[(pQueue->bottom - 1 - position) & (FR_JOB_QUEUE_CAPACITY - 1)];
+			for(uint32_t jobIndex = pQueue->bottom - 1 - position; jobIndex != pQueue->bottom - 1; ++jobIndex)
+			{
+				pQueue->jobs[jobIndex & (FR_JOB_QUEUE_CAPACITY - 1)] = pQueue->jobs[(jobIndex + 1) & (FR_JOB_QUEUE_CAPACITY - 1)];
+			}
+			--pQueue->bottom;
+		}
+	}
+	frUnlockMutex(&pQueue->mutex);
+
+	return taken;
+}
+
+/*
+ * Take a job from the queue of the calling thread, or steal one from the other threads.
+ *
+ * Parameters:
+ * - pCounter: The counter of the job to take, or NULL for any job.
+ * - pJob: The job taken.
+ */
+static bool frTakeJob(const FrJobCounter* pCounter, FrQueuedJob* pJob)
+{
+	// The threads without a queue of their own only steal
+	const bool ownQueue = jobThreadIndex != FR_JOB_THREAD_INDEX_NONE;
+	for(uint32_t offset = 0; offset < jobSystem.queueCount; ++offset)
+	{
+		const uint32_t queueIndex = ((ownQueue ? jobThreadIndex : 0) + offset) % jobSystem.queueCount;
+		if(frTakeJobFromQueue(&jobSystem.queues[queueIndex], !ownQueue || offset != 0, pCounter, pJob))
+		{
+			frAtomicAdd(&jobSystem.queuedJobCount, UINT32_MAX);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void frExecuteJob(const FrQueuedJob* pJob)
+{
+	pJob->job.function(pJob->job.pData);
+	if(pJob->pCounter)
+	{
+		frAtomicAdd(&pJob->pCounter->pendingCount, UINT32_MAX);
+	}
+}
+
+/*
+ * Entry point of the job threads, which run jobs until the job system is destroyed.
+ *
+ * Parameters:
+ * - pIndexVoid: The index of the thread.
+ */
+static void frJobThread(void* pIndexVoid)
+{
+	jobThreadIndex = (uint32_t)(uintptr_t)pIndexVoid;
+
+	while(true)
+	{
+		FrQueuedJob job;
+		if(frTakeJob(NULL, &job))
+		{
+			frExecuteJob(&job);
+			continue;
+		}
+
+		// Jobs are counted before the sleeping threads are woken under the mutex, so no wakeup is lost
+		frLockMutex(&jobSystem.sleepMutex);
+		while(!jobSystem.quit && frAtomicLoad(&jobSystem.queuedJobCount) == 0)
+		{
+			frWaitCondition(&jobSystem.sleepCondition, &jobSystem.sleepMutex);
+		}
+		const bool quit = jobSystem.quit;
+		frUnlockMutex(&jobSystem.sleepMutex);
+
+		if(quit)
+		{
+			return;
+		}
+	}
+}
+
+FrResult frCreateJobSystem(void)
+{
+	const uint32_t threadCount = frGetProcessorCount();
+
+	jobSystem.queues = malloc(threadCount * sizeof(jobSystem.queues[0]));
+	jobSystem.threads = malloc(threadCount * sizeof(jobSystem.threads[0]));
+	if(!jobSystem.queues || !jobSystem.threads)
+	{
+		free(jobSystem.queues);
+		free(jobSystem.threads);
+		jobSystem = (FrJobSystem){0};
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	jobSystem.quit = false;
+	frAtomicStore(&jobSystem.queuedJobCount, 0);
+
+	// Undo what was created when something fails, no thread is started yet
+	if(frCreateJobQueue(&jobSystem.mainThreadQueue) != FR_SUCCESS)
+	{
+		goto freeArrays;
+	}
+	if(frCreateMutex(&jobSystem.sleepMutex) != FR_SUCCESS)
+	{
+		goto destroyMainThreadQueue;
+	}
+	if(frCreateCondition(&jobSystem.sleepCondition) != FR_SUCCESS)
+	{
+		goto destroySleepMutex;
+	}
+	for(jobSystem.queueCount = 0; jobSystem.queueCount < threadCount; ++jobSystem.queueCount)
+	{
+		if(frCreateJobQueue(&jobSystem.queues[jobSystem.queueCount]) != FR_SUCCESS)
+		{
+			goto destroyQueues;
+		}
+	}
+	jobThreadIndex = 0;
+
+	// The main thread runs jobs while it waits, failing to start a thread only leaves fewer of them
+	jobSystem.threadCount = 1;
+	for(uint32_t threadIndex = 1; threadIndex < threadCount; ++threadIndex)
+	{
+		if(frCreateThread(frJobThread, (void*)(uintptr_t)threadIndex, &jobSystem.threads[threadIndex]) != FR_SUCCESS)
+		{
+			break;
+		}
+		++jobSystem.threadCount;
+	}
+
+	return FR_SUCCESS;
+
+destroyQueues:
+	for(uint32_t queueIndex = 0; queueIndex < jobSystem.queueCount; ++queueIndex)
+	{
+		frDestroyMutex(&jobSystem.queues[queueIndex].mutex);
+	}
+	frDestroyCondition(&jobSystem.sleepCondition);
+destroySleepMutex:
+	frDestroyMutex(&jobSystem.sleepMutex);
+destroyMainThreadQueue:
+	frDestroyMutex(&jobSystem.mainThreadQueue.mutex);
+freeArrays:
+	free(jobSystem.queues);
+	free(jobSystem.threads);
+	jobSystem = (FrJobSystem){0};
+	return FR_ERROR_UNKNOWN;
+}
+
+void frDestroyJobSystem(void)
+{
+	frLockMutex(&jobSystem.sleepMutex);
+	jobSystem.quit = true;
+	frBroadcastCondition(&jobSystem.sleepCondition);
+	frUnlockMutex(&jobSystem.sleepMutex);
+
+	for(uint32_t threadIndex = 1; threadIndex < jobSystem.threadCount; ++threadIndex)
+	{
+		frJoinThread(jobSystem.threads[threadIndex]);
+	}
+
+	for(uint32_t queueIndex = 0; queueIndex < jobSystem.queueCount; ++queueIndex)
+	{
+		frDestroyMutex(&jobSystem.queues[queueIndex].mutex);
+	}
+	frDestroyMutex(&jobSystem.mainThreadQueue.mutex);
+	frDestroyCondition(&jobSystem.sleepCondition);
+	frDestroyMutex(&jobSystem.sleepMutex);
+	free(jobSystem.queues);
+	free(jobSystem.threads);
+	jobSystem = (FrJobSystem){0};
+	jobThreadIndex = FR_JOB_THREAD_INDEX_NONE;
+}
+
+uint32_t frGetJobThreadCount(void)
+{
+	return jobSystem.threadCount;
+}
+
+uint32_t frGetJobThreadIndex(void)
+{
+	return jobThreadIndex;
+}
+
+void frRunJobs(uint32_t jobCount, const FrJob* pJobs, FrJobCounter* pCounter)
+{
+	// Counted first, so the counter cannot reach zero while jobs are still being queued
+	if(pCounter)
+	{
+		frAtomicAdd(&pCounter->pendingCount, jobCount);
+	}
+
+	uint32_t queuedCount = 0;
+	for(uint32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+	{
+		const FrQueuedJob job = {
+			.job = pJobs[jobIndex],
+			.pCounter = pCounter
+		};
+		if(frPushJob(&jobSystem.queues[jobThreadIndex != FR_JOB_THREAD_INDEX_NONE ? jobThreadIndex : 0], &job))
+		{
+			frAtomicAdd(&jobSystem.queuedJobCount, 1);
+			++queuedCount;
+		}
+		else
+		{
+			// The queue is full, running the job here also lets the others drain it
+			frExecuteJob(&job);
+		}
+	}
+
+	if(queuedCount)
+	{
+		frLockMutex(&jobSystem.sleepMutex);
+		if(queuedCount == 1)
+		{
+			frSignalCondition(&jobSystem.sleepCondition);
+		}
+		else
+		{
+			frBroadcastCondition(&jobSystem.sleepCondition);
+		}
+		frUnlockMutex(&jobSystem.sleepMutex);
+	}
+}
+
+void frRunMainThreadJobs(uint32_t jobCount, const FrJob* pJobs, FrJobCounter* pCounter)
+{
+	if(pCounter)
+	{
+		frAtomicAdd(&pCounter->pendingCount, jobCount);
+	}
+
+	for(uint32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+	{
+		const FrQueuedJob job = {
+			.job = pJobs[jobIndex],
+			.pCounter = pCounter
+		};
+
+		// A full queue is drained by the main thread itself, other threads wait for room
+		while(!frPushJob(&jobSystem.mainThreadQueue, &job))
+		{
+			if(jobThreadIndex == 0)
+			{
+				frRunPendingMainThreadJobs();
+			}
+			else
+			{
+				frYieldThread();
+			}
+		}
+	}
+}
+
+bool frIsJobCounterDone(FrJobCounter* pCounter)
+{
+	return frAtomicLoad(&pCounter->pendingCount) == 0;
+}
+
+void frWaitJobCounter(FrJobCounter* pCounter)
+{
+	while(frAtomicLoad(&pCounter->pendingCount))
+	{
+		FrQueuedJob job;
+		if((jobThreadIndex == 0 && frTakeJobFromQueue(&jobSystem.mainThreadQueue, false, NULL, &job)) || frTakeJob(NULL, &job))
+		{
+			frExecuteJob(&job);
+		}
+		else
+		{
+			// The remaining jobs are running on other threads
+			frYieldThread();
+		}
+	}
+}
+
+void frFinishJobs(FrJobCounter* pCounter)
+{
+	while(frAtomicLoad(&pCounter->pendingCount))
+	{
+		FrQueuedJob job;
+		if(frTakeJob(pCounter, &job))
+		{
+			frExecuteJob(&job);
+		}
+		else
+		{
+			// The remaining jobs are running on other threads
+			frYieldThread();
+		}
+	}
+}
+
+void frRunPendingMainThreadJobs(void)
+{
+	// Oldest first, and the jobs queued by these ones wait for the next call
+	FrQueuedJob job;
+	uint32_t jobCount;
+	frLockMutex(&jobSystem.mainThreadQueue.mutex);
+	jobCount = jobSystem.mainThreadQueue.bottom - jobSystem.mainThreadQueue.top;
+	frUnlockMutex(&jobSystem.mainThreadQueue.mutex);
+	for(uint32_t jobIndex = 0; jobIndex < jobCount && frTakeJobFromQueue(&jobSystem.mainThreadQueue, true, NULL, &job); ++jobIndex)
+	{
+		frExecuteJob(&job);
+	}
+}
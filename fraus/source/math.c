@@ -240,3 +240,86 @@ void frMultiply(const float* restrict pFirst, const float* restrict pSecond, flo
 	pResult[14] = pFirst[12] * pSecond[ 2] + pFirst[13] * pSecond[ 6] + pFirst[14] * pSecond[10] + pFirst[15] * pSecond[14];
 	pResult[15] = pFirst[12] * pSecond[ 3] + pFirst[13] * pSecond[ 7] + pFirst[14] * pSecond[11] + pFirst[15] * pSecond[15];
 }
+
+FrSphere frBoundingSphere(uint32_t vertexCount, const FrVertex* pVertices)
+{
+	if(vertexCount == 0)
+	{
+		return (FrSphere){0};
+	}
+
+	// Centered on the bounding box, which is tighter than the vertex average for uneven meshes
+	FrVec3 minimum = pVertices[0].position;
+	FrVec3 maximum = pVertices[0].position;
+	for(uint32_t vertexIndex = 1; vertexIndex < vertexCount; ++vertexIndex)
+	{
+		const FrVec3* const pPosition = &pVertices[vertexIndex].position;
+		minimum.x = fminf(minimum.x, pPosition->x);
+		minimum.y = fminf(minimum.y, pPosition->y);
+		minimum.z = fminf(minimum.z, pPosition->z);
+		maximum.x = fmaxf(maximum.x, pPosition->x);
+		maximum.y = fmaxf(maximum.y, pPosition->y);
+		maximum.z = fmaxf(maximum.z, pPosition->z);
+	}
+	const FrVec3 extent = frAdd(&minimum, &maximum);
+	FrSphere sphere = {
+		.center = frScale(&extent, 0.5f)
+	};
+
+	float radiusSquared = 0.f;
+	for(uint32_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+	{
+		const FrVec3 offset = frSubstract(&pVertices[vertexIndex].position, &sphere.center);
+		radiusSquared = fmaxf(radiusSquared, frDot(&offset, &offset));
+	}
+	sphere.radius = sqrtf(radiusSquared);
+
+	return sphere;
+}
+
+FrSphere frTransformSphere(const FrSphere* pSphere, const float matrix[16])
+{
+	const FrVec3 xAxis = {.x = matrix[0], .y = matrix[1], .z = matrix[2]};
+	const FrVec3 yAxis = {.x = matrix[4], .y = matrix[5], .z = matrix[6]};
+	const FrVec3 zAxis = {.x = matrix[8], .y = matrix[9], .z = matrix[10]};
+	// The largest axis scale keeps the sphere conservative under non uniform scaling
+	const float scaleSquared = fmaxf(fmaxf(frDot(&xAxis, &xAxis), frDot(&yAxis, &yAxis)), frDot(&zAxis, &zAxis));
+
+	return (FrSphere){
+		.center = {
+			.x = matrix[0] * pSphere->center.x + matrix[4] * pSphere->center.y + matrix[ 8] * pSphere->center.z + matrix[12],
+			.y = matrix[1] * pSphere->center.x + matrix[5] * pSphere->center.y + matrix[ 9] * pSphere->center.z + matrix[13],
+			.z = matrix[2] * pSphere->center.x + matrix[6] * pSphere->center.y + matrix[10] * pSphere->center.z + matrix[14]
+		},
+		.radius = pSphere->radius * sqrtf(scaleSquared)
+	};
+}
+
+void frExtractFrustum(const float matrix[16], FrFrustum* pFrustum)
+{
+	// Clip space is -w <= x, y <= w and 0 <= z <= w, combine the rows of the column major matrix accordingly
+	for(uint32_t column = 0; column < 4; ++column)
+	{
+		const float* const pColumn = &matrix[column * 4];
+		pFrustum->planes[0][column] = pColumn[3] + pColumn[0];
+		pFrustum->planes[1][column] = pColumn[3] - pColumn[0];
+		pFrustum->planes[2][column] = pColumn[3] + pColumn[1];
+		pFrustum->planes[3][column] = pColumn[3] - pColumn[1];
+		pFrustum->planes[4][column] = pColumn[2];
+		pFrustum->planes[5][column] = pColumn[3] - pColumn[2];
+	}
+
+	// Normalize so that plane distances compare with radii, an infinite far plane stays (0, 0, 0, near)
+	for(uint32_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+	{
+		float* const pPlane = pFrustum->planes[planeIndex];
+		const float length = sqrtf(pPlane[0] * pPlane[0] + pPlane[1] * pPlane[1] + pPlane[2] * pPlane[2]);
+		if(length > 0.f)
+		{
+			pPlane[0] /= length;
+			pPlane[1] /= length;
+			pPlane[2] /= length;
+			pPlane[3] /= length;
+		}
+	}
+}
@@ -0,0 +1,208 @@
+#ifndef _WIN32
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../include/fraus/thread.h"
+
+#include <stdlib.h>
+
+#ifndef _WIN32
+	#include <sched.h>
+	#include <stdatomic.h>
+	#include <unistd.h>
+#endif
+
+/*
+ * The entry point and data of a thread, freed by the thread once started.
+ */
+typedef struct FrThreadStart
+{
+	FrThreadFunction function;
+	void* pData;
+} FrThreadStart;
+
+#ifdef _WIN32
+static DWORD WINAPI frThreadProc(LPVOID pStartVoid)
+#else
+static void* frThreadProc(void* pStartVoid)
+#endif
+{
+	const FrThreadStart start = *(FrThreadStart*)pStartVoid;
+	free(pStartVoid);
+
+	start.function(start.pData);
+
+	#ifdef _WIN32
+	return 0;
+	#else
+	return NULL;
+	#endif
+}
+
+FrResult frCreateThread(FrThreadFunction function, void* pData, FrThread* pThread)
+{
+	FrThreadStart* const pStart = malloc(sizeof(FrThreadStart));
+	if(!pStart)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	pStart->function = function;
+	pStart->pData = pData;
+
+	#ifdef _WIN32
+	pThread->handle = CreateThread(NULL, 0, frThreadProc, pStart, 0, NULL);
+	if(!pThread->handle)
+	#else
+	if(pthread_create(&pThread->thread, NULL, frThreadProc, pStart) != 0)
+	#endif
+	{
+		free(pStart);
+		return FR_ERROR_UNKNOWN;
+	}
+
+	return FR_SUCCESS;
+}
+
+void frJoinThread(FrThread thread)
+{
+	#ifdef _WIN32
+	WaitForSingleObject(thread.handle, INFINITE);
+	CloseHandle(thread.handle);
+	#else
+	pthread_join(thread.thread, NULL);
+	#endif
+}
+
+void frYieldThread(void)
+{
+	#ifdef _WIN32
+	SwitchToThread();
+	#else
+	sched_yield();
+	#endif
+}
+
+uint32_t frGetProcessorCount(void)
+{
+	#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	const long count = (long)systemInfo.dwNumberOfProcessors;
+	#else
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	#endif
+
+	return count > 1 ? (uint32_t)count : 1;
+}
+
+FrResult frCreateMutex(FrMutex* pMutex)
+{
+	#ifdef _WIN32
+	InitializeSRWLock(&pMutex->lock);
+	return FR_SUCCESS;
+	#else
+	return pthread_mutex_init(&pMutex->mutex, NULL) == 0 ? FR_SUCCESS : FR_ERROR_UNKNOWN;
+	#endif
+}
+
+void frDestroyMutex(FrMutex* pMutex)
+{
+	// Slim reader/writer locks need no cleanup
+	#ifdef _WIN32
+	(void)pMutex;
+	#else
+	pthread_mutex_destroy(&pMutex->mutex);
+	#endif
+}
+
+void frLockMutex(FrMutex* pMutex)
+{
+	#ifdef _WIN32
+	AcquireSRWLockExclusive(&pMutex->lock);
+	#else
+	pthread_mutex_lock(&pMutex->mutex);
+	#endif
+}
+
+void frUnlockMutex(FrMutex* pMutex)
+{
+	#ifdef _WIN32
+	ReleaseSRWLockExclusive(&pMutex->lock);
+	#else
+	pthread_mutex_unlock(&pMutex->mutex);
+	#endif
+}
+
+FrResult frCreateCondition(FrCondition* pCondition)
+{
+	#ifdef _WIN32
+	InitializeConditionVariable(&pCondition->condition);
+	return FR_SUCCESS;
+	#else
+	return pthread_cond_init(&pCondition->condition, NULL) == 0 ? FR_SUCCESS : FR_ERROR_UNKNOWN;
+	#endif
+}
+
+void frDestroyCondition(FrCondition* pCondition)
+{
+	#ifdef _WIN32
+	(void)pCondition;
+	#else
+	pthread_cond_destroy(&pCondition->condition);
+	#endif
+}
+
+void frWaitCondition(FrCondition* pCondition, FrMutex* pMutex)
+{
+	#ifdef _WIN32
+	SleepConditionVariableSRW(&pCondition->condition, &pMutex->lock, INFINITE, 0);
+	#else
+	pthread_cond_wait(&pCondition->condition, &pMutex->mutex);
+	#endif
+}
+
+void frSignalCondition(FrCondition* pCondition)
+{
+	#ifdef _WIN32
+	WakeConditionVariable(&pCondition->condition);
+	#else
+	pthread_cond_signal(&pCondition->condition);
+	#endif
+}
+
+void frBroadcastCondition(FrCondition* pCondition)
+{
+	#ifdef _WIN32
+	WakeAllConditionVariable(&pCondition->condition);
+	#else
+	pthread_cond_broadcast(&pCondition->condition);
+	#endif
+}
+
+uint32_t frAtomicLoad(FrAtomic* pAtomic)
+{
+	#ifdef _WIN32
+	// Interlocked operations are full barriers
+	return (uint32_t)InterlockedCompareExchange(&pAtomic->value, 0, 0);
+	#else
+	return atomic_load(&pAtomic->value);
+	#endif
+}
+
+void frAtomicStore(FrAtomic* pAtomic, uint32_t value)
+{
+	#ifdef _WIN32
+	InterlockedExchange(&pAtomic->value, (LONG)value);
+	#else
+	atomic_store(&pAtomic->value, value);
+	#endif
+}
+
+uint32_t frAtomicAdd(FrAtomic* pAtomic, uint32_t value)
+{
+	#ifdef _WIN32
+	return (uint32_t)InterlockedExchangeAdd(&pAtomic->value, (LONG)value) + value;
+	#else
+	return atomic_fetch_add(&pAtomic->value, value) + value;
+	#endif
+}
@@ -1,7 +1,12 @@
 #include "../../fraus/include/fraus/utils.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
 void frMergeSorted(size_t firstCount, const void* first, size_t secondCount, const void* second, void* restrict final, size_t elementSize, FrCompareFunction compare)
 {
 	const char* firstChar = first;
@@ -40,3 +45,59 @@ void frMergeSorted(size_t firstCount, const void* first, size_t secondCount, con
 		finalChar += elementSize;
 	}
 }
+
+FrResult frOpenFileWriter(const char* path, FrFileWriter* pWriter)
+{
+	static const char suffix[] = ".tmp";
+	const size_t pathLength = strlen(path);
+	*pWriter = (FrFileWriter){
+		.path = path,
+		.temporaryPath = malloc(pathLength + sizeof(suffix))
+	};
+	if(!pWriter->temporaryPath)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	memcpy(pWriter->temporaryPath, path, pathLength);
+	memcpy(pWriter->temporaryPath + pathLength, suffix, sizeof(suffix));
+
+	pWriter->file = fopen(pWriter->temporaryPath, "wb");
+	if(!pWriter->file)
+	{
+		free(pWriter->temporaryPath);
+		*pWriter = (FrFileWriter){0};
+		return FR_ERROR_UNKNOWN;
+	}
+
+	return FR_SUCCESS;
+}
+
+void frWriteFileData(FrFileWriter* pWriter, const void* data, size_t size)
+{
+	if(!pWriter->failed && size && fwrite(data, 1, size, pWriter->file) != size)
+	{
+		pWriter->failed = true;
+	}
+}
+
+FrResult frCloseFileWriter(FrFileWriter* pWriter)
+{
+	// Closing flushes the last writes, which may fail too
+	bool written = fclose(pWriter->file) == 0 && !pWriter->failed;
+	if(written)
+	{
+#ifdef _WIN32
+		written = MoveFileExA(pWriter->temporaryPath, pWriter->path, MOVEFILE_REPLACE_EXISTING);
+#else
+		written = rename(pWriter->temporaryPath, pWriter->path) == 0;
+#endif
+	}
+	if(!written)
+	{
+		remove(pWriter->temporaryPath);
+	}
+	free(pWriter->temporaryPath);
+	*pWriter = (FrFileWriter){0};
+
+	return written ? FR_SUCCESS : FR_ERROR_UNKNOWN;
+}
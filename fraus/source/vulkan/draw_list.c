@@ -0,0 +1,149 @@
+#include "../../include/fraus/vulkan/draw_list.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+FR_DEFINE_VECTOR(FrDrawPacket, DrawPacket)
+FR_DEFINE_VECTOR(FrSphere, Sphere)
+
+// Radix sort digit size, 8 passes over a 64 bits key
+#define FR_RADIX_BITS 8
+#define FR_RADIX_SIZE (1 << FR_RADIX_BITS)
+
+// Spheres culled together, two AVX registers or four SSE/NEON ones
+#define FR_CULL_BLOCK_SIZE 8
+
+uint64_t frMakeDrawKey(FrDrawPass pass, uint32_t pipelineIndex, uint32_t material, uint32_t mesh, float depth)
+{
+	// Map the float to an unsigned integer with the same order
+	uint32_t depthBits;
+	memcpy(&depthBits, &depth, sizeof(depthBits));
+	depthBits = (depthBits & UINT32_C(0x80000000)) ? ~depthBits : depthBits | UINT32_C(0x80000000);
+
+	const uint64_t passKey = (uint64_t)pass & ((UINT64_C(1) << FR_DRAW_KEY_PASS_BITS) - 1);
+	const uint64_t pipelineKey = (uint64_t)pipelineIndex & ((UINT64_C(1) << FR_DRAW_KEY_PIPELINE_BITS) - 1);
+	const uint64_t materialKey = (uint64_t)material & ((UINT64_C(1) << FR_DRAW_KEY_MATERIAL_BITS) - 1);
+	const uint64_t stateKey = pipelineKey << FR_DRAW_KEY_MATERIAL_BITS | materialKey;
+
+	// Blending needs back to front order, which takes precedence over state changes
+	if(pass == FR_DRAW_PASS_TRANSPARENT)
+	{
+		return
+			passKey << (64 - FR_DRAW_KEY_PASS_BITS) |
+			(uint64_t)(uint32_t)~depthBits << (FR_DRAW_KEY_PIPELINE_BITS + FR_DRAW_KEY_MATERIAL_BITS) |
+			stateKey;
+	}
+
+	// Front to back order only reduces overdraw, the most significant depth bits are enough
+	const uint64_t meshKey = (uint64_t)mesh & ((UINT64_C(1) << FR_DRAW_KEY_MESH_BITS) - 1);
+	return
+		passKey << (64 - FR_DRAW_KEY_PASS_BITS) |
+		stateKey << (FR_DRAW_KEY_MESH_BITS + FR_DRAW_KEY_DEPTH_BITS) |
+		meshKey << FR_DRAW_KEY_DEPTH_BITS |
+		depthBits >> (32 - FR_DRAW_KEY_DEPTH_BITS);
+}
+
+void frSortDrawPackets(size_t count, FrDrawPacket* pPackets, FrDrawPacket* pScratch)
+{
+	FrDrawPacket* source = pPackets;
+	FrDrawPacket* destination = pScratch;
+
+	size_t counts[FR_RADIX_SIZE];
+	for(uint32_t shift = 0; shift < 64; shift += FR_RADIX_BITS)
+	{
+		memset(counts, 0, sizeof(counts));
+		for(size_t packetIndex = 0; packetIndex < count; ++packetIndex)
+		{
+			++counts[(source[packetIndex].key >> shift) & (FR_RADIX_SIZE - 1)];
+		}
+
+		// Every key has the same digit, which is common for the pass and pipeline bits
+		bool sorted = false;
+		for(uint32_t digit = 0; digit < FR_RADIX_SIZE; ++digit)
+		{
+			if(counts[digit] == count)
+			{
+				sorted = true;
+				break;
+			}
+			if(counts[digit] != 0)
+			{
+				break;
+			}
+		}
+		if(sorted)
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for(uint32_t digit = 0; digit < FR_RADIX_SIZE; ++digit)
+		{
+			const size_t digitCount = counts[digit];
+			counts[digit] = offset;
+			offset += digitCount;
+		}
+
+		for(size_t packetIndex = 0; packetIndex < count; ++packetIndex)
+		{
+			destination[counts[(source[packetIndex].key >> shift) & (FR_RADIX_SIZE - 1)]++] = source[packetIndex];
+		}
+
+		FrDrawPacket* const swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	if(source != pPackets)
+	{
+		memcpy(pPackets, source, count * sizeof(pPackets[0]));
+	}
+}
+
+size_t frCullDrawPackets(const FrFrustum* pFrustum, size_t count, const FrSphere* pSpheres, FrDrawPacket* pPackets)
+{
+	size_t visibleCount = 0;
+	for(size_t blockStart = 0; blockStart < count; blockStart += FR_CULL_BLOCK_SIZE)
+	{
+		const size_t blockSize = count - blockStart < FR_CULL_BLOCK_SIZE ? count - blockStart : FR_CULL_BLOCK_SIZE;
+
+		// Padding lanes are tested too but never kept
+		float x[FR_CULL_BLOCK_SIZE] = {0};
+		float y[FR_CULL_BLOCK_SIZE] = {0};
+		float z[FR_CULL_BLOCK_SIZE] = {0};
+		float radius[FR_CULL_BLOCK_SIZE] = {0};
+		for(size_t lane = 0; lane < blockSize; ++lane)
+		{
+			x[lane] = pSpheres[blockStart + lane].center.x;
+			y[lane] = pSpheres[blockStart + lane].center.y;
+			z[lane] = pSpheres[blockStart + lane].center.z;
+			radius[lane] = pSpheres[blockStart + lane].radius;
+		}
+
+		int visible[FR_CULL_BLOCK_SIZE];
+		for(size_t lane = 0; lane < FR_CULL_BLOCK_SIZE; ++lane)
+		{
+			visible[lane] = 1;
+		}
+		for(uint32_t planeIndex = 0; planeIndex < FR_LEN(pFrustum->planes); ++planeIndex)
+		{
+			const float* const pPlane = pFrustum->planes[planeIndex];
+			for(size_t lane = 0; lane < FR_CULL_BLOCK_SIZE; ++lane)
+			{
+				visible[lane] &= pPlane[0] * x[lane] + pPlane[1] * y[lane] + pPlane[2] * z[lane] + pPlane[3] >= -radius[lane];
+			}
+		}
+
+		// Writes never pass reads, so the packets are compacted in place
+		for(size_t lane = 0; lane < blockSize; ++lane)
+		{
+			if(visible[lane])
+			{
+				pPackets[visibleCount++] = pPackets[blockStart + lane];
+			}
+		}
+	}
+
+	return visibleCount;
+}
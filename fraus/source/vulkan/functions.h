@@ -42,6 +42,8 @@
 	F(vkEnumeratePhysicalDevices) \
 	F(vkGetPhysicalDeviceProperties) \
 	F(vkGetPhysicalDeviceFeatures) \
+	F(vkGetPhysicalDeviceFeatures2) \
+	F(vkGetPhysicalDeviceProperties2) \
 	F(vkGetPhysicalDeviceQueueFamilyProperties) \
 	F(vkGetPhysicalDeviceMemoryProperties) \
 	F(vkGetPhysicalDeviceFormatProperties) \
@@ -77,6 +79,10 @@
 	F(vkCreatePipelineLayout) \
 	F(vkDestroyPipelineLayout) \
 	F(vkCreateGraphicsPipelines) \
+	F(vkCreateComputePipelines) \
+	F(vkCreatePipelineCache) \
+	F(vkGetPipelineCacheData) \
+	F(vkDestroyPipelineCache) \
 	F(vkDestroyPipeline) \
 	F(vkCreateCommandPool) \
 	F(vkDestroyCommandPool) \
@@ -94,6 +100,9 @@
 	F(vkDestroyFence) \
 	F(vkResetFences) \
 	F(vkWaitForFences) \
+	F(vkGetFenceStatus) \
+	F(vkWaitSemaphores) \
+	F(vkGetSemaphoreCounterValue) \
 	F(vkCreateBuffer) \
 	F(vkDestroyBuffer) \
 	F(vkGetBufferMemoryRequirements) \
@@ -109,6 +118,7 @@
 	F(vkDestroySampler) \
 	F(vkCreateDescriptorPool) \
 	F(vkDestroyDescriptorPool) \
+	F(vkResetDescriptorPool) \
 	F(vkAllocateDescriptorSets) \
 	F(vkUpdateDescriptorSets) \
 	F(vkCmdBeginRenderPass) \
@@ -116,13 +126,18 @@
 	F(vkCmdBindPipeline) \
 	F(vkCmdBindVertexBuffers) \
 	F(vkCmdBindIndexBuffer) \
+	F(vkCmdDraw) \
 	F(vkCmdDrawIndexed) \
+	F(vkCmdDrawIndexedIndirect) \
+	F(vkCmdDispatch) \
 	F(vkCmdPipelineBarrier) \
 	F(vkCmdSetViewport) \
 	F(vkCmdSetScissor) \
 	F(vkCmdPushConstants) \
 	F(vkCmdBindDescriptorSets) \
 	F(vkCmdCopyBuffer) \
+	F(vkCmdFillBuffer) \
+	F(vkCmdClearColorImage) \
 	F(vkCmdCopyBufferToImage) \
 	F(vkCmdBlitImage) \
 	F(vkCmdExecuteCommands) \
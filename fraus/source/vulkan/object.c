@@ -4,17 +4,119 @@
 #include "./functions.h"
 #include "../../include/fraus/vulkan/vulkan_utils.h"
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 FR_DEFINE_VECTOR(FrVulkanObject, VulkanObject)
+FR_DEFINE_VECTOR(FrMesh, Mesh)
+FR_DEFINE_VECTOR(FrMaterial, Material)
 
-FrResult frCreateObject(const char* modelPath, uint32_t pipelineIndex, const uint32_t* bindingIndexes)
+FrResult frCreateMeshArena(void)
 {
-	FrVulkanObject object = {
-		.pipelineIndex = pipelineIndex
-	};
+	meshArena = (FrMeshArena){0};
+
+	if(frCreateMeshVector(&meshArena.meshes) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	if(frCreateBuffer(
+		FR_MESH_ARENA_VERTEX_CAPACITY * sizeof(FrVertex),
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&meshArena.vertexBuffer,
+		&meshArena.vertexMemory
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	if(frCreateBuffer(
+		FR_MESH_ARENA_INDEX_CAPACITY * sizeof(uint32_t),
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&meshArena.indexBuffer,
+		&meshArena.indexMemory
+	) != FR_SUCCESS)
+	{
+		vkDestroyBuffer(device, meshArena.vertexBuffer, NULL);
+		vkFreeMemory(device, meshArena.vertexMemory, NULL);
+		return FR_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	#ifndef NDEBUG
+	if(debugExtensionAvailable)
+	{
+		VkDebugUtilsObjectNameInfoEXT nameInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.objectType = VK_OBJECT_TYPE_BUFFER,
+			.objectHandle = (uint64_t)meshArena.vertexBuffer,
+			.pObjectName = "Fraus mesh vertex buffer"
+		};
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		nameInfo.objectHandle = (uint64_t)meshArena.indexBuffer;
+		nameInfo.pObjectName = "Fraus mesh index buffer";
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	#endif
+
+	return FR_SUCCESS;
+}
+
+void frDestroyMeshArena(void)
+{
+	for(size_t meshIndex = 0; meshIndex < meshArena.meshes.size; ++meshIndex)
+	{
+		free(meshArena.meshes.data[meshIndex].path);
+		free(meshArena.meshes.data[meshIndex].vertices);
+	}
+	frDestroyMeshVector(&meshArena.meshes);
+
+	vkDestroyBuffer(device, meshArena.indexBuffer, NULL);
+	vkFreeMemory(device, meshArena.indexMemory, NULL);
+	vkDestroyBuffer(device, meshArena.vertexBuffer, NULL);
+	vkFreeMemory(device, meshArena.vertexMemory, NULL);
+}
+
+/*
+ * Find the mesh loaded from a model file, or load it in the mesh arena.
+ *
+ * Parameters:
+ * - pBatch: The batch recording the upload.
+ * - modelPath: The path of the model file.
+ * - pMeshIndex: A pointer to the index of the mesh.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_OUT_OF_DEVICE_MEMORY if the mesh arena is full, or holds as many meshes as the draw keys tell apart.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frGetMesh(FrUploadBatch* pBatch, const char* modelPath, uint32_t* pMeshIndex)
+{
+	for(uint32_t meshIndex = 0; meshIndex < meshArena.meshes.size; ++meshIndex)
+	{
+		if(strcmp(meshArena.meshes.data[meshIndex].path, modelPath) == 0)
+		{
+			*pMeshIndex = meshIndex;
+			return FR_SUCCESS;
+		}
+	}
+
+	// The draw keys only keep the low bits of the mesh index, which would mix meshes in the sort
+	if(meshArena.meshes.size >= (size_t)1 << FR_DRAW_KEY_MESH_BITS)
+	{
+		return FR_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
 
 	FrModel model;
 	if(frLoadOBJ(modelPath, &model) != FR_SUCCESS)
@@ -22,261 +124,323 @@ FrResult frCreateObject(const char* modelPath, uint32_t pipelineIndex, const uin
 		return FR_ERROR_UNKNOWN;
 	}
 
-	const VkDeviceSize size = model.vertexCount * sizeof(model.vertices[0]) + model.indexCount * sizeof(model.indexes[0]);
+	// Suballocate the mesh from the shared buffers
+	if(
+		model.vertexCount > FR_MESH_ARENA_VERTEX_CAPACITY - meshArena.vertexCount ||
+		model.indexCount > FR_MESH_ARENA_INDEX_CAPACITY - meshArena.indexCount
+	)
+	{
+		free(model.vertices);
+		free(model.indexes);
+		return FR_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	const VkDeviceSize verticesSize = model.vertexCount * sizeof(model.vertices[0]);
+	const VkDeviceSize indexesSize = model.indexCount * sizeof(model.indexes[0]);
 
-	// Vertex / index buffer
+	// Upload vertices and indices
 	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-
-	if(frCreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory) != FR_SUCCESS)
+	void* data;
+	if(frCreateStagingBuffer(pBatch, verticesSize, &stagingBuffer, &data) != FR_SUCCESS)
 	{
+		free(model.vertices);
+		free(model.indexes);
 		return FR_ERROR_UNKNOWN;
 	}
-
-	void* data;
-	vkMapMemory(device, stagingBufferMemory, 0, size, 0, &data);
-	memcpy(data, model.vertices, model.vertexCount * sizeof(model.vertices[0]));
-	memcpy((uint8_t*)data + model.vertexCount * sizeof(model.vertices[0]), model.indexes, model.indexCount * sizeof(model.indexes[0]));
-	vkUnmapMemory(device, stagingBufferMemory);
-
-	if(frCreateBuffer(
-		size,
-		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		&object.buffer,
-		&object.memory) != FR_SUCCESS
-	)
+	memcpy(data, model.vertices, verticesSize);
+	if(frCopyBuffer(pBatch, stagingBuffer, meshArena.vertexBuffer, meshArena.vertexCount * sizeof(model.vertices[0]), verticesSize) != FR_SUCCESS)
 	{
+		free(model.vertices);
+		free(model.indexes);
 		return FR_ERROR_UNKNOWN;
 	}
 
-	if(frCopyBuffer(stagingBuffer, object.buffer, size) != FR_SUCCESS)
+	if(frCreateStagingBuffer(pBatch, indexesSize, &stagingBuffer, &data) != FR_SUCCESS)
 	{
+		free(model.vertices);
+		free(model.indexes);
+		return FR_ERROR_UNKNOWN;
+	}
+	memcpy(data, model.indexes, indexesSize);
+	if(frCopyBuffer(pBatch, stagingBuffer, meshArena.indexBuffer, meshArena.indexCount * sizeof(model.indexes[0]), indexesSize) != FR_SUCCESS)
+	{
+		free(model.vertices);
+		free(model.indexes);
 		return FR_ERROR_UNKNOWN;
 	}
 
-	vkDestroyBuffer(device, stagingBuffer, NULL);
-	vkFreeMemory(device, stagingBufferMemory, NULL);
-
-	object.vertexCount = model.vertexCount;
-	object.vertices = model.vertices;
-	object.indexCount = model.indexCount;
-
-	// Descriptor pool
-	uint32_t uniformBuffersCount = 0;
-	uint32_t storageBuffersCount = 0;
-	uint32_t texturesCount = 0;
-	for(uint32_t descriptorTypeIndex = 0; descriptorTypeIndex < graphicsPipelines.data[pipelineIndex].descriptorTypeCount; ++descriptorTypeIndex)
+	const size_t pathSize = strlen(modelPath) + 1;
+	FrMesh mesh = {
+		.path = malloc(pathSize),
+		.vertexOffset = (int32_t)meshArena.vertexCount,
+		.vertexCount = model.vertexCount,
+		.vertices = model.vertices,
+		.firstIndex = meshArena.indexCount,
+		.indexCount = model.indexCount,
+		.bounds = frBoundingSphere(model.vertexCount, model.vertices)
+	};
+	free(model.indexes);
+	if(!mesh.path)
 	{
-		switch(graphicsPipelines.data[pipelineIndex].descriptorTypes[descriptorTypeIndex])
-		{
-			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-				++texturesCount;
-				break;
+		free(model.vertices);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	memcpy(mesh.path, modelPath, pathSize);
+	if(frPushBackMeshVector(&meshArena.meshes, mesh) != FR_SUCCESS)
+	{
+		free(mesh.path);
+		free(model.vertices);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
 
-			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-				++uniformBuffersCount;
-				break;
+	meshArena.vertexCount += model.vertexCount;
+	meshArena.indexCount += model.indexCount;
 
-			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-				++storageBuffersCount;
-				break;
+	*pMeshIndex = (uint32_t)meshArena.meshes.size - 1;
 
-			default:
-				return FR_ERROR_UNKNOWN;
+	return FR_SUCCESS;
+}
+
+/*
+ * Find the material made of a pipeline and binding indexes, or create it.
+ *
+ * Parameters:
+ * - pipelineIndex: The pipeline.
+ * - bindingIndexes: The binding indexes, one per descriptor of the pipeline.
+ * - pMaterialIndex: A pointer to the index of the material.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+static FrResult frGetMaterial(uint32_t pipelineIndex, const uint32_t* bindingIndexes, uint32_t* pMaterialIndex)
+{
+	const size_t bindingIndexesSize = graphicsPipelines.data[pipelineIndex].descriptorTypeCount * sizeof(bindingIndexes[0]);
+	for(uint32_t materialIndex = 0; materialIndex < materials.size; ++materialIndex)
+	{
+		const FrMaterial* const pMaterial = &materials.data[materialIndex];
+		if(pMaterial->pipelineIndex == pipelineIndex && (bindingIndexesSize == 0 || memcmp(pMaterial->bindingIndexes, bindingIndexes, bindingIndexesSize) == 0))
+		{
+			*pMaterialIndex = materialIndex;
+			return FR_SUCCESS;
 		}
 	}
 
-	VkDescriptorPoolSize* const poolSizes = malloc(3 * sizeof(poolSizes[0]));
-	if(!poolSizes)
+	FrMaterial material = {
+		.pipelineIndex = pipelineIndex,
+		.bindingIndexes = NULL
+	};
+	if(bindingIndexesSize)
 	{
-		return FR_ERROR_OUT_OF_HOST_MEMORY;
+		material.bindingIndexes = malloc(bindingIndexesSize);
+		if(!material.bindingIndexes)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		memcpy(material.bindingIndexes, bindingIndexes, bindingIndexesSize);
 	}
-
-	uint32_t poolSizeCount = 0;
-	if(uniformBuffersCount > 0)
+	if(frPushBackMaterialVector(&materials, material) != FR_SUCCESS)
 	{
-		poolSizes[poolSizeCount++] = (VkDescriptorPoolSize){
-			.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-			.descriptorCount = FR_FRAMES_IN_FLIGHT * uniformBuffersCount
-		};
+		free(material.bindingIndexes);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
 	}
-	if(texturesCount > 0)
+
+	*pMaterialIndex = (uint32_t)materials.size - 1;
+
+	return FR_SUCCESS;
+}
+
+FrResult frCreateObject(FrUploadBatch* pBatch, const char* modelPath, uint32_t pipelineIndex, const uint32_t* bindingIndexes)
+{
+	// The descriptors of a pipeline building in the background are known once its shaders are reflected
+	const FrResult layoutResult = frWaitGraphicsPipelineLayout(pipelineIndex);
+	if(layoutResult != FR_SUCCESS)
 	{
-		poolSizes[poolSizeCount++] = (VkDescriptorPoolSize){
-			.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-			.descriptorCount = FR_FRAMES_IN_FLIGHT * texturesCount
-		};
+		return layoutResult;
 	}
-	if(storageBuffersCount > 0)
+
+	// Retired resources cannot be bound, and bindless ones past the capacity of their binding are not in the bindless set
+	const FrPipeline* const pPipeline = &graphicsPipelines.data[pipelineIndex];
+	for(uint32_t i = 0; i < pPipeline->descriptorTypeCount; ++i)
 	{
-		poolSizes[poolSizeCount++] = (VkDescriptorPoolSize){
-			.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-			.descriptorCount = FR_FRAMES_IN_FLIGHT * storageBuffersCount
-		};
+		if(!frIsResourceAlive(pPipeline->descriptorTypes[i], bindingIndexes[i]))
+		{
+			return FR_ERROR_INVALID_ARGUMENT;
+		}
+
+		const uint32_t binding =
+			pPipeline->descriptorTypes[i] == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ? 0 :
+			pPipeline->descriptorTypes[i] == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ? 1 :
+			2;
+		if(pPipeline->bindless && bindingIndexes[i] >= bindless.capacities[binding])
+		{
+			return FR_ERROR_INVALID_ARGUMENT;
+		}
 	}
 
-	const VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-		.maxSets = FR_FRAMES_IN_FLIGHT,
-		.poolSizeCount = poolSizeCount,
-		.pPoolSizes = poolSizes
+	FrVulkanObject object = {
+		.pipelineIndex = pipelineIndex,
+		.alive = true
 	};
+	frIdentity(object.transformation);
 
-	if(vkCreateDescriptorPool(
-		device,
-		&descriptorPoolCreateInfo,
-		NULL,
-		&object.descriptorPool
-	) != VK_SUCCESS)
+	// Objects created from the same file share the mesh
+	if(frGetMesh(pBatch, modelPath, &object.meshIndex) != FR_SUCCESS)
 	{
-		vkDestroyBuffer(device, object.buffer, NULL);
-		vkFreeMemory(device, object.memory, NULL);
 		return FR_ERROR_UNKNOWN;
 	}
+	const FrMesh* const pMesh = &meshArena.meshes.data[object.meshIndex];
+	object.vertexOffset = pMesh->vertexOffset;
+	object.vertexCount = pMesh->vertexCount;
+	object.vertices = pMesh->vertices;
+	object.firstIndex = pMesh->firstIndex;
+	object.indexCount = pMesh->indexCount;
+
+	if(frGetMaterial(pipelineIndex, bindingIndexes, &object.materialIndex) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
 
-	free(poolSizes);
-
-	// Descriptor set
-	VkDescriptorSetLayout layouts[FR_FRAMES_IN_FLIGHT];
-	for(uint32_t i = 0; i < FR_FRAMES_IN_FLIGHT; i++)
+	// The indexes of the material are pushed when drawing, the descriptors are in the bindless set
+	if(pPipeline->bindless)
 	{
-		layouts[i] = graphicsPipelines.data[pipelineIndex].descriptorSetLayout;
+		if(frPushBackVulkanObjectVector(&frObjects, object) != FR_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		return FR_SUCCESS;
 	}
 
-	const VkDescriptorSetAllocateInfo descriptorSetsAllocateInfo = {
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-		.descriptorPool = object.descriptorPool,
-		.descriptorSetCount = FR_FRAMES_IN_FLIGHT,
-		.pSetLayouts = layouts
-	};
-	if(vkAllocateDescriptorSets(device, &descriptorSetsAllocateInfo, object.descriptorSets) != VK_SUCCESS)
+	// Descriptor sets, one per frame slot
+	VkDescriptorSetLayout layouts[FR_MAX_FRAMES_IN_FLIGHT];
+	for(uint32_t i = 0; i < framesInFlight; i++)
+	{
+		layouts[i] = pPipeline->descriptorSetLayout;
+	}
+	if(frAllocateDescriptorSets(&descriptorAllocator, framesInFlight, layouts, object.descriptorSets) != FR_SUCCESS)
 	{
-		vkDestroyDescriptorPool(device, object.descriptorPool, NULL);
-		vkDestroyBuffer(device, object.buffer, NULL);
-		vkFreeMemory(device, object.memory, NULL);
 		return FR_ERROR_UNKNOWN;
 	}
 
-	VkWriteDescriptorSet* const descriptorWrites = malloc(graphicsPipelines.data[pipelineIndex].descriptorTypeCount * sizeof(descriptorWrites[0]));
+	// The writes of every frame slot are made at once
+	const uint32_t writeCount = framesInFlight * pPipeline->descriptorTypeCount;
+	VkWriteDescriptorSet* const descriptorWrites = malloc(writeCount * (sizeof(VkWriteDescriptorSet) + sizeof(VkDescriptorBufferInfo) + sizeof(VkDescriptorImageInfo)));
 	if(!descriptorWrites)
 	{
-		vkDestroyDescriptorPool(device, object.descriptorPool, NULL);
-		vkDestroyBuffer(device, object.buffer, NULL);
-		vkFreeMemory(device, object.memory, NULL);
-		return FR_ERROR_UNKNOWN;
+		frRetireDescriptorSets(&descriptorAllocator, framesInFlight, layouts, object.descriptorSets);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
 	}
-	for(uint32_t descriptorSetIndex = 0; descriptorSetIndex < FR_FRAMES_IN_FLIGHT; ++descriptorSetIndex)
+	VkDescriptorBufferInfo* const bufferInfos = (VkDescriptorBufferInfo*)(descriptorWrites + writeCount);
+	VkDescriptorImageInfo* const imageInfos = (VkDescriptorImageInfo*)(bufferInfos + writeCount);
+	for(uint32_t descriptorSetIndex = 0; descriptorSetIndex < framesInFlight; ++descriptorSetIndex)
 	{
-		for(uint32_t descriptorTypeIndex = 0; descriptorTypeIndex < graphicsPipelines.data[pipelineIndex].descriptorTypeCount; ++descriptorTypeIndex)
+		for(uint32_t descriptorTypeIndex = 0; descriptorTypeIndex < pPipeline->descriptorTypeCount; ++descriptorTypeIndex)
 		{
-			switch(graphicsPipelines.data[pipelineIndex].descriptorTypes[descriptorTypeIndex])
+			const uint32_t writeIndex = descriptorSetIndex * pPipeline->descriptorTypeCount + descriptorTypeIndex;
+			const uint32_t resourceIndex = bindingIndexes[descriptorTypeIndex];
+			descriptorWrites[writeIndex] = (VkWriteDescriptorSet){
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = object.descriptorSets[descriptorSetIndex],
+				.dstBinding = descriptorTypeIndex,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = pPipeline->descriptorTypes[descriptorTypeIndex]
+			};
+			switch(pPipeline->descriptorTypes[descriptorTypeIndex])
 			{
 				case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-				{
-					VkDescriptorBufferInfo* const pBufferInfo = malloc(sizeof(*pBufferInfo));
-					if(!pBufferInfo)
-					{
-						return FR_ERROR_OUT_OF_HOST_MEMORY;
-					}
-					pBufferInfo->buffer = uniformBuffers.data[bindingIndexes[descriptorTypeIndex]].buffers[descriptorSetIndex];
-					pBufferInfo->offset = 0;
-					pBufferInfo->range = uniformBuffers.data[bindingIndexes[descriptorTypeIndex]].buffersSize;
-
-					descriptorWrites[descriptorTypeIndex] = (VkWriteDescriptorSet){
-						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-						.dstSet = object.descriptorSets[descriptorSetIndex],
-						.dstBinding = descriptorTypeIndex,
-						.dstArrayElement = 0,
-						.descriptorCount = 1,
-						.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-						.pBufferInfo = pBufferInfo
+					bufferInfos[writeIndex] = (VkDescriptorBufferInfo){
+						.buffer = uniformBuffers.data[resourceIndex].buffers[descriptorSetIndex],
+						.offset = 0,
+						.range = uniformBuffers.data[resourceIndex].buffersSize
 					};
+					descriptorWrites[writeIndex].pBufferInfo = &bufferInfos[writeIndex];
 					break;
-				}
 
 				case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-				{
-					VkDescriptorBufferInfo* const pBufferInfo = malloc(sizeof(*pBufferInfo));
-					if(!pBufferInfo)
-					{
-						return FR_ERROR_OUT_OF_HOST_MEMORY;
-					}
-					pBufferInfo->buffer = storageBuffers.data[bindingIndexes[descriptorTypeIndex]].buffer;
-					pBufferInfo->offset = 0;
-					pBufferInfo->range = storageBuffers.data[bindingIndexes[descriptorTypeIndex]].bufferSize;
-
-					descriptorWrites[descriptorTypeIndex] = (VkWriteDescriptorSet){
-						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-						.dstSet = object.descriptorSets[descriptorSetIndex],
-						.dstBinding = descriptorTypeIndex,
-						.dstArrayElement = 0,
-						.descriptorCount = 1,
-						.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-						.pBufferInfo = pBufferInfo
+					bufferInfos[writeIndex] = (VkDescriptorBufferInfo){
+						.buffer = storageBuffers.data[resourceIndex].buffer,
+						.offset = 0,
+						.range = storageBuffers.data[resourceIndex].bufferSize
 					};
+					descriptorWrites[writeIndex].pBufferInfo = &bufferInfos[writeIndex];
 					break;
-				}
 
 				case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-				{
-					VkDescriptorImageInfo* const pImageInfo = malloc(sizeof(*pImageInfo));
-					if(!pImageInfo)
-					{
-						return FR_ERROR_OUT_OF_HOST_MEMORY;
-					}
-					pImageInfo->sampler = textureSampler;
-					pImageInfo->imageView = textures.data[bindingIndexes[descriptorTypeIndex]].imageView;
-					pImageInfo->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-					descriptorWrites[descriptorTypeIndex] = (VkWriteDescriptorSet){
-						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-						.dstSet = object.descriptorSets[descriptorSetIndex],
-						.dstBinding = descriptorTypeIndex,
-						.dstArrayElement = 0,
-						.descriptorCount = 1,
-						.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-						.pImageInfo = pImageInfo
+					imageInfos[writeIndex] = (VkDescriptorImageInfo){
+						.sampler = textureSampler,
+						.imageView = textures.data[resourceIndex].imageView,
+						.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
 					};
+					descriptorWrites[writeIndex].pImageInfo = &imageInfos[writeIndex];
 					break;
-				}
 
 				default:
+					free(descriptorWrites);
+					frRetireDescriptorSets(&descriptorAllocator, framesInFlight, layouts, object.descriptorSets);
 					return FR_ERROR_UNKNOWN;
 			}
 		}
-		
-		vkUpdateDescriptorSets(device, graphicsPipelines.data[pipelineIndex].descriptorTypeCount, descriptorWrites, 0, NULL);
-
-		for(uint32_t descriptorTypeIndex = 0; descriptorTypeIndex < graphicsPipelines.data[pipelineIndex].descriptorTypeCount; ++descriptorTypeIndex)
-		{
-			if(descriptorWrites[descriptorTypeIndex].pBufferInfo)
-			{
-				free((void*)descriptorWrites[descriptorTypeIndex].pBufferInfo);
-			}
-			if(descriptorWrites[descriptorTypeIndex].pImageInfo)
-			{
-				free((void*)descriptorWrites[descriptorTypeIndex].pImageInfo);
-			}
-		}
 	}
-
+	vkUpdateDescriptorSets(device, writeCount, descriptorWrites, 0, NULL);
 	free(descriptorWrites);
-	free(model.indexes);
 
 	if(frPushBackVulkanObjectVector(&frObjects, object) != FR_SUCCESS)
 	{
+		frRetireDescriptorSets(&descriptorAllocator, framesInFlight, layouts, object.descriptorSets);
 		return FR_ERROR_UNKNOWN;
 	}
 
 	return FR_SUCCESS;
 }
 
-void frDestroyObject(FrVulkanObject* pObject)
+FrResult frRetireObject(uint32_t objectIndex)
+{
+	if(objectIndex >= frObjects.size || !frObjects.data[objectIndex].alive)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	FrVulkanObject* const pObject = &frObjects.data[objectIndex];
+	const FrPipeline* const pPipeline = &graphicsPipelines.data[pObject->pipelineIndex];
+	if(!pPipeline->bindless)
+	{
+		// The sets go back to the allocator for the next objects with the same layout
+		VkDescriptorSetLayout layouts[FR_MAX_FRAMES_IN_FLIGHT];
+		for(uint32_t i = 0; i < framesInFlight; ++i)
+		{
+			layouts[i] = pPipeline->descriptorSetLayout;
+		}
+		if(frRetireDescriptorSets(&descriptorAllocator, framesInFlight, layouts, pObject->descriptorSets) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+
+	// The mesh may be shared, and the mesh arena is linear, so the mesh stays loaded
+
+	// Keep the slot so the other object indexes stay valid, frDrawFrame skips it
+	*pObject = (FrVulkanObject){0};
+
+	return FR_SUCCESS;
+}
+
+FrResult frSetObjectGeometry(uint32_t objectIndex, const FrObjectGeometry* pGeometry)
 {
-	free(pObject->vertices);
+	assert(pGeometry != NULL);
+
+	// The pipelines with instance transforms read them at vertex binding 1, which the geometry would replace
+	if(
+		objectIndex >= frObjects.size ||
+		pGeometry->vertexBindingCount > FR_MAX_GEOMETRY_VERTEX_BINDINGS ||
+		graphicsPipelines.data[frObjects.data[objectIndex].pipelineIndex].instanceTransforms
+	)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
 
-	vkDestroyDescriptorPool(device, pObject->descriptorPool, NULL);
-	vkDestroyBuffer(device, pObject->buffer, NULL);
-	vkFreeMemory(device, pObject->memory, NULL);
+	frObjects.data[objectIndex].geometry = *pGeometry;
+
+	return FR_SUCCESS;
 }
@@ -0,0 +1,620 @@
+#include "./shader_cache.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <spirv-headers/spirv.h>
+
+#include "./functions.h"
+
+// Larger counts in the cache file mean it is corrupted
+#define FR_SHADER_CACHE_MAX_COUNT 4096
+#define FR_SHADER_CACHE_MAX_CODE_SIZE (16 * 1024 * 1024)
+
+/*
+ * A shader module and its reflection, shared by the pipelines using the same SPIR-V code.
+ */
+typedef struct FrShader
+{
+	// FNV-1a hash of the code
+	uint64_t hash;
+	uint32_t codeSize;
+	// Compared on a hash match, as different codes may share a hash
+	uint32_t* code;
+	// VK_NULL_HANDLE for the reflections read from the cache file and not used yet
+	VkShaderModule module;
+	FrShaderInfo info;
+} FrShader;
+
+typedef struct FrShaderPath
+{
+	char* path;
+	uint32_t shaderIndex;
+} FrShaderPath;
+
+FR_DECLARE_VECTOR(FrShader, Shader)
+FR_DEFINE_VECTOR(FrShader, Shader)
+FR_DECLARE_VECTOR(FrShaderPath, ShaderPath)
+FR_DEFINE_VECTOR(FrShaderPath, ShaderPath)
+
+typedef struct FrShaderCache
+{
+	FrShaderVector shaders;
+	// The files read so far, several of them may share a shader
+	FrShaderPathVector paths;
+	// Owned copy of the path of the cache file, NULL when the reflections are not saved
+	char* filePath;
+	// Whether reflections were added since the cache file was read
+	bool modified;
+	// Held during the whole of frGetShader, loading shaders is cheap next to compiling pipelines
+	FrMutex mutex;
+} FrShaderCache;
+
+static FrShaderCache shaderCache;
+
+/*
+ * Hash SPIR-V code with 64 bits FNV-1a.
+ *
+ * Parameters:
+ * - code: The code.
+ * - size: The size of the code in bytes.
+ *
+ * Returns:
+ * - The hash.
+ */
+static uint64_t frHashCode(const uint32_t* code, size_t size)
+{
+	const unsigned char* const bytes = (const unsigned char*)code;
+	uint64_t hash = UINT64_C(0xCBF29CE484222325);
+	for(size_t byteIndex = 0; byteIndex < size; ++byteIndex)
+	{
+		hash ^= bytes[byteIndex];
+		hash *= UINT64_C(0x100000001B3);
+	}
+
+	return hash;
+}
+
+/*
+ * Copy an array.
+ *
+ * Parameters:
+ * - pSource: The array.
+ * - size: The size of the array in bytes.
+ *
+ * Returns:
+ * - The copy, to be freed, or NULL if size is 0 or the allocation failed.
+ */
+static void* frDuplicateArray(const void* pSource, size_t size)
+{
+	if(!size)
+	{
+		return NULL;
+	}
+
+	void* const pDestination = malloc(size);
+	if(pDestination)
+	{
+		memcpy(pDestination, pSource, size);
+	}
+
+	return pDestination;
+}
+
+static void frFreeShaderInfo(FrShaderInfo* pInfo)
+{
+	free(pInfo->inputs);
+	free(pInfo->outputs);
+	free(pInfo->bindings);
+	free(pInfo->pushConstants);
+	free(pInfo->specializationConstants);
+}
+
+static FrResult frCopyShaderInfo(const FrShaderInfo* pSource, FrShaderInfo* pDestination)
+{
+	*pDestination = *pSource;
+	pDestination->inputs = frDuplicateArray(pSource->inputs, pSource->inputCount * sizeof(pSource->inputs[0]));
+	pDestination->outputs = frDuplicateArray(pSource->outputs, pSource->outputCount * sizeof(pSource->outputs[0]));
+	pDestination->bindings = frDuplicateArray(pSource->bindings, pSource->bindingCount * sizeof(pSource->bindings[0]));
+	pDestination->pushConstants = frDuplicateArray(pSource->pushConstants, pSource->pushConstantCount * sizeof(pSource->pushConstants[0]));
+	pDestination->specializationConstants = frDuplicateArray(pSource->specializationConstants, pSource->specializationConstantCount * sizeof(pSource->specializationConstants[0]));
+	if(
+		(pSource->inputCount && !pDestination->inputs) ||
+		(pSource->outputCount && !pDestination->outputs) ||
+		(pSource->bindingCount && !pDestination->bindings) ||
+		(pSource->pushConstantCount && !pDestination->pushConstants) ||
+		(pSource->specializationConstantCount && !pDestination->specializationConstants)
+	)
+	{
+		frFreeShaderInfo(pDestination);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Read a SPIR-V file, in the byte order of the host.
+ *
+ * Parameters:
+ * - path: The path of the file.
+ * - pCode: A pointer to the code, to be freed.
+ * - pSize: A pointer to the size of the code in bytes.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_FILE_NOT_FOUND if the file could not be opened.
+ * - FR_ERROR_CORRUPTED_FILE if the file is not SPIR-V.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frReadSpirv(const char* path, uint32_t** pCode, size_t* pSize)
+{
+	// Open file
+	FILE* const file = fopen(path, "rb");
+	if(!file)
+	{
+		return FR_ERROR_FILE_NOT_FOUND;
+	}
+
+	// Get file size
+	fseek(file, 0, SEEK_END);
+	const size_t size = ftell(file);
+	if(size == (size_t)-1L)
+	{
+		fclose(file);
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// SPIR-V code must contain 32-bit words
+	if(size == 0 || size % sizeof((*pCode)[0]) != 0)
+	{
+		fclose(file);
+		return FR_ERROR_CORRUPTED_FILE;
+	}
+
+	// Allocate memory for SPIR-V code
+	uint32_t* const code = malloc(size);
+	if(!code)
+	{
+		fclose(file);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	// Read SPIR-V code
+	fseek(file, 0, SEEK_SET);
+	if(fread(code, sizeof(code[0]), size / sizeof(code[0]), file) != size / sizeof(code[0]))
+	{
+		free(code);
+		fclose(file);
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// Close file
+	fclose(file);
+
+	if(code[0] != SpvMagicNumber)
+	{
+		for(uint32_t i = 0; i < size / sizeof(code[0]); ++i)
+		{
+			code[i] = FR_SWAP_BYTES_U32(code[i]);
+		}
+
+		if(code[0] != SpvMagicNumber)
+		{
+			free(code);
+			return FR_ERROR_CORRUPTED_FILE;
+		}
+	}
+
+	*pCode = code;
+	*pSize = size;
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Read the reflections of a cache file written by frWriteShaderCacheFile.
+ * Reading stops at the first corrupted entry, the ones before are kept.
+ */
+static void frReadShaderCacheFile(void)
+{
+	FILE* const file = fopen(shaderCache.filePath, "rb");
+	if(!file)
+	{
+		return;
+	}
+
+	uint32_t header[3];
+	if(fread(header, sizeof(header[0]), FR_LEN(header), file) != FR_LEN(header) || header[0] != FR_SHADER_CACHE_MAGIC || header[1] != FR_SHADER_CACHE_VERSION)
+	{
+		fclose(file);
+		return;
+	}
+
+	for(uint32_t shaderIndex = 0; shaderIndex < header[2]; ++shaderIndex)
+	{
+		// Code size, then the input, output, binding, push constant and specialization constant counts, then the local size and the code
+		uint64_t hash;
+		uint32_t counts[6];
+		uint32_t localSize[3];
+		if(
+			fread(&hash, sizeof(hash), 1, file) != 1 ||
+			fread(counts, sizeof(counts[0]), FR_LEN(counts), file) != FR_LEN(counts) ||
+			fread(localSize, sizeof(localSize[0]), FR_LEN(localSize), file) != FR_LEN(localSize)
+		)
+		{
+			break;
+		}
+		bool valid = counts[0] && counts[0] <= FR_SHADER_CACHE_MAX_CODE_SIZE && counts[0] % sizeof(uint32_t) == 0;
+		for(uint32_t countIndex = 1; countIndex < FR_LEN(counts); ++countIndex)
+		{
+			valid = valid && counts[countIndex] <= FR_SHADER_CACHE_MAX_COUNT;
+		}
+		if(!valid)
+		{
+			break;
+		}
+
+		FrShader shader = {
+			.hash = hash,
+			.codeSize = counts[0],
+			.code = malloc(counts[0]),
+			.info = {
+				.inputCount = counts[1],
+				.inputs = counts[1] ? malloc(counts[1] * sizeof(shader.info.inputs[0])) : NULL,
+				.outputCount = counts[2],
+				.outputs = counts[2] ? malloc(counts[2] * sizeof(shader.info.outputs[0])) : NULL,
+				.bindingCount = counts[3],
+				.bindings = counts[3] ? malloc(counts[3] * sizeof(shader.info.bindings[0])) : NULL,
+				.pushConstantCount = counts[4],
+				.pushConstants = counts[4] ? malloc(counts[4] * sizeof(shader.info.pushConstants[0])) : NULL,
+				.specializationConstantCount = counts[5],
+				.specializationConstants = counts[5] ? malloc(counts[5] * sizeof(shader.info.specializationConstants[0])) : NULL,
+				.localSize = {localSize[0], localSize[1], localSize[2]}
+			}
+		};
+		valid =
+			shader.code &&
+			(!shader.info.inputCount || shader.info.inputs) &&
+			(!shader.info.outputCount || shader.info.outputs) &&
+			(!shader.info.bindingCount || shader.info.bindings) &&
+			(!shader.info.pushConstantCount || shader.info.pushConstants) &&
+			(!shader.info.specializationConstantCount || shader.info.specializationConstants) &&
+			fread(shader.code, 1, shader.codeSize, file) == shader.codeSize;
+
+		// The structures are written field by field, as they may hold padding or pointers
+		uint32_t words[4];
+		for(uint32_t i = 0; valid && i < shader.info.inputCount; ++i)
+		{
+			valid = fread(words, sizeof(words[0]), 3, file) == 3;
+			shader.info.inputs[i] = (FrShaderVariable){.location = words[0], .size = words[1], .format = (VkFormat)words[2]};
+		}
+		for(uint32_t i = 0; valid && i < shader.info.outputCount; ++i)
+		{
+			valid = fread(words, sizeof(words[0]), 3, file) == 3;
+			shader.info.outputs[i] = (FrShaderVariable){.location = words[0], .size = words[1], .format = (VkFormat)words[2]};
+		}
+		for(uint32_t i = 0; valid && i < shader.info.bindingCount; ++i)
+		{
+			valid = fread(words, sizeof(words[0]), 4, file) == 4;
+			shader.info.bindings[i] = (VkDescriptorSetLayoutBinding){
+				.binding = words[0],
+				.descriptorType = (VkDescriptorType)words[1],
+				.descriptorCount = words[2],
+				.stageFlags = words[3]
+			};
+		}
+		for(uint32_t i = 0; valid && i < shader.info.pushConstantCount; ++i)
+		{
+			valid = fread(words, sizeof(words[0]), 3, file) == 3;
+			shader.info.pushConstants[i] = (VkPushConstantRange){.stageFlags = words[0], .offset = words[1], .size = words[2]};
+		}
+		for(uint32_t i = 0; valid && i < shader.info.specializationConstantCount; ++i)
+		{
+			valid = fread(words, sizeof(words[0]), 2, file) == 2;
+			shader.info.specializationConstants[i] = (FrShaderSpecializationConstant){.id = words[0], .size = words[1]};
+		}
+
+		if(!valid || frPushBackShaderVector(&shaderCache.shaders, shader) != FR_SUCCESS)
+		{
+			free(shader.code);
+			frFreeShaderInfo(&shader.info);
+			break;
+		}
+	}
+
+	fclose(file);
+}
+
+/*
+ * Write the code and reflection of the shaders used by this launch to the cache file.
+ * The others are dropped, so the file does not keep the shaders of older builds forever.
+ */
+static void frWriteShaderCacheFile(void)
+{
+	uint32_t usedCount = 0;
+	for(uint32_t shaderIndex = 0; shaderIndex < shaderCache.shaders.size; ++shaderIndex)
+	{
+		usedCount += shaderCache.shaders.data[shaderIndex].module != VK_NULL_HANDLE;
+	}
+	if(!shaderCache.modified && usedCount == shaderCache.shaders.size)
+	{
+		return;
+	}
+
+	// A failed write keeps the previous file
+	FrFileWriter writer;
+	if(frOpenFileWriter(shaderCache.filePath, &writer) != FR_SUCCESS)
+	{
+		return;
+	}
+
+	const uint32_t header[] = {FR_SHADER_CACHE_MAGIC, FR_SHADER_CACHE_VERSION, usedCount};
+	frWriteFileData(&writer, header, sizeof(header));
+	for(uint32_t shaderIndex = 0; shaderIndex < shaderCache.shaders.size; ++shaderIndex)
+	{
+		const FrShader* const pShader = &shaderCache.shaders.data[shaderIndex];
+		const FrShaderInfo* const pInfo = &pShader->info;
+		if(pShader->module == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+
+		const uint32_t counts[] = {
+			pShader->codeSize,
+			pInfo->inputCount,
+			pInfo->outputCount,
+			pInfo->bindingCount,
+			pInfo->pushConstantCount,
+			pInfo->specializationConstantCount
+		};
+		frWriteFileData(&writer, &pShader->hash, sizeof(pShader->hash));
+		frWriteFileData(&writer, counts, sizeof(counts));
+		frWriteFileData(&writer, pInfo->localSize, sizeof(pInfo->localSize));
+		frWriteFileData(&writer, pShader->code, pShader->codeSize);
+
+		for(uint32_t i = 0; i < pInfo->inputCount; ++i)
+		{
+			const uint32_t words[] = {pInfo->inputs[i].location, pInfo->inputs[i].size, (uint32_t)pInfo->inputs[i].format};
+			frWriteFileData(&writer, words, sizeof(words));
+		}
+		for(uint32_t i = 0; i < pInfo->outputCount; ++i)
+		{
+			const uint32_t words[] = {pInfo->outputs[i].location, pInfo->outputs[i].size, (uint32_t)pInfo->outputs[i].format};
+			frWriteFileData(&writer, words, sizeof(words));
+		}
+		for(uint32_t i = 0; i < pInfo->bindingCount; ++i)
+		{
+			const uint32_t words[] = {
+				pInfo->bindings[i].binding,
+				(uint32_t)pInfo->bindings[i].descriptorType,
+				pInfo->bindings[i].descriptorCount,
+				pInfo->bindings[i].stageFlags
+			};
+			frWriteFileData(&writer, words, sizeof(words));
+		}
+		for(uint32_t i = 0; i < pInfo->pushConstantCount; ++i)
+		{
+			const uint32_t words[] = {pInfo->pushConstants[i].stageFlags, pInfo->pushConstants[i].offset, pInfo->pushConstants[i].size};
+			frWriteFileData(&writer, words, sizeof(words));
+		}
+		for(uint32_t i = 0; i < pInfo->specializationConstantCount; ++i)
+		{
+			const uint32_t words[] = {pInfo->specializationConstants[i].id, pInfo->specializationConstants[i].size};
+			frWriteFileData(&writer, words, sizeof(words));
+		}
+	}
+
+	frCloseFileWriter(&writer);
+}
+
+FrResult frCreateShaderCache(const char* path)
+{
+	shaderCache = (FrShaderCache){0};
+	if(frCreateShaderVector(&shaderCache.shaders) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	if(frCreateShaderPathVector(&shaderCache.paths) != FR_SUCCESS)
+	{
+		frDestroyShaderVector(&shaderCache.shaders);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	if(frCreateMutex(&shaderCache.mutex) != FR_SUCCESS)
+	{
+		frDestroyShaderPathVector(&shaderCache.paths);
+		frDestroyShaderVector(&shaderCache.shaders);
+		return FR_ERROR_UNKNOWN;
+	}
+
+	if(path)
+	{
+		const size_t pathSize = strlen(path) + 1;
+		shaderCache.filePath = malloc(pathSize);
+		if(!shaderCache.filePath)
+		{
+			frDestroyShaderCache();
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		memcpy(shaderCache.filePath, path, pathSize);
+
+		// A missing or corrupted file starts an empty cache
+		frReadShaderCacheFile();
+	}
+
+	return FR_SUCCESS;
+}
+
+void frDestroyShaderCache(void)
+{
+	if(shaderCache.filePath)
+	{
+		frWriteShaderCacheFile();
+	}
+
+	for(uint32_t shaderIndex = 0; shaderIndex < shaderCache.shaders.size; ++shaderIndex)
+	{
+		// Null for the reflections read from the cache file and never used
+		vkDestroyShaderModule(device, shaderCache.shaders.data[shaderIndex].module, NULL);
+		free(shaderCache.shaders.data[shaderIndex].code);
+		frFreeShaderInfo(&shaderCache.shaders.data[shaderIndex].info);
+	}
+	for(uint32_t pathIndex = 0; pathIndex < shaderCache.paths.size; ++pathIndex)
+	{
+		free(shaderCache.paths.data[pathIndex].path);
+	}
+	frDestroyShaderPathVector(&shaderCache.paths);
+	frDestroyShaderVector(&shaderCache.shaders);
+	frDestroyMutex(&shaderCache.mutex);
+	free(shaderCache.filePath);
+	shaderCache = (FrShaderCache){0};
+}
+
+/*
+ * Find the shader of a file, reading and reflecting it if it is not known yet.
+ * The mutex of the cache must be held.
+ *
+ * Parameters:
+ * - path: The path of the file.
+ * - pShaderIndex: A pointer to the index of the shader.
+ *
+ * Returns:
+ * - The same as frGetShader.
+ */
+static FrResult frFindShader(const char* path, uint32_t* pShaderIndex)
+{
+	for(uint32_t pathIndex = 0; pathIndex < shaderCache.paths.size; ++pathIndex)
+	{
+		if(strcmp(shaderCache.paths.data[pathIndex].path, path) == 0)
+		{
+			*pShaderIndex = shaderCache.paths.data[pathIndex].shaderIndex;
+			return FR_SUCCESS;
+		}
+	}
+
+	uint32_t* code;
+	size_t codeSize;
+	FrResult result = frReadSpirv(path, &code, &codeSize);
+	if(result != FR_SUCCESS)
+	{
+		return result;
+	}
+	const uint64_t hash = frHashCode(code, codeSize);
+
+	// Another file with the same code, or a reflection from the cache file
+	uint32_t shaderIndex = 0;
+	while(
+		shaderIndex < shaderCache.shaders.size &&
+		(
+			shaderCache.shaders.data[shaderIndex].hash != hash ||
+			shaderCache.shaders.data[shaderIndex].codeSize != codeSize ||
+			memcmp(shaderCache.shaders.data[shaderIndex].code, code, codeSize) != 0
+		)
+	)
+	{
+		++shaderIndex;
+	}
+	if(shaderIndex == shaderCache.shaders.size)
+	{
+		// The shader keeps the code
+		FrShader shader = {
+			.hash = hash,
+			.codeSize = (uint32_t)codeSize,
+			.code = code
+		};
+		if(frParseSpirv(code, codeSize / sizeof(code[0]), &shader.info) != FR_SUCCESS)
+		{
+			free(code);
+			return FR_ERROR_UNKNOWN;
+		}
+		if(frPushBackShaderVector(&shaderCache.shaders, shader) != FR_SUCCESS)
+		{
+			frFreeShaderInfo(&shader.info);
+			free(code);
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		shaderCache.modified = true;
+	}
+	else
+	{
+		free(code);
+	}
+
+	FrShader* const pShader = &shaderCache.shaders.data[shaderIndex];
+	if(pShader->module == VK_NULL_HANDLE)
+	{
+		const VkShaderModuleCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+			.codeSize = codeSize,
+			.pCode = pShader->code
+		};
+		if(vkCreateShaderModule(device, &createInfo, NULL, &pShader->module) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		#ifndef NDEBUG
+		if(debugExtensionAvailable)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "Fraus shader module %"PRIu32, shaderIndex);
+
+			const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+				.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+				.objectType = VK_OBJECT_TYPE_SHADER_MODULE,
+				.objectHandle = (uint64_t)pShader->module,
+				.pObjectName = name
+			};
+			if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+			{
+				return FR_ERROR_UNKNOWN;
+			}
+		}
+		#endif
+	}
+
+	// The next pipelines using the file skip reading it
+	const size_t pathSize = strlen(path) + 1;
+	FrShaderPath shaderPath = {
+		.path = malloc(pathSize),
+		.shaderIndex = shaderIndex
+	};
+	if(!shaderPath.path)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	memcpy(shaderPath.path, path, pathSize);
+	if(frPushBackShaderPathVector(&shaderCache.paths, shaderPath) != FR_SUCCESS)
+	{
+		free(shaderPath.path);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	*pShaderIndex = shaderIndex;
+	return FR_SUCCESS;
+}
+
+FrResult frGetShader(const char* path, VkShaderModule* pModule, FrShaderInfo* pInfo)
+{
+	frLockMutex(&shaderCache.mutex);
+
+	uint32_t shaderIndex;
+	FrResult result = frFindShader(path, &shaderIndex);
+	if(result == FR_SUCCESS)
+	{
+		const FrShader* const pShader = &shaderCache.shaders.data[shaderIndex];
+		*pModule = pShader->module;
+		if(pInfo)
+		{
+			result = frCopyShaderInfo(&pShader->info, pInfo);
+		}
+	}
+
+	frUnlockMutex(&shaderCache.mutex);
+
+	return result;
+}
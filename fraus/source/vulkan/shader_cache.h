@@ -0,0 +1,51 @@
+#ifndef FRAUS_VULKAN_SHADER_CACHE_H
+#define FRAUS_VULKAN_SHADER_CACHE_H
+
+#include "fraus/utils.h"
+#include "fraus/vulkan/include.h"
+#include "./spirv.h"
+
+// Cache file layout version, to be increased whenever FrShaderInfo changes
+#define FR_SHADER_CACHE_VERSION 5
+#define FR_SHADER_CACHE_MAGIC 0x43535246 // "FRSC"
+
+/*
+ * Create the shader cache, seeded with the reflections saved by a previous launch when there are some.
+ *
+ * Parameters:
+ * - path: The file the reflections are loaded from and saved to, or NULL.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frCreateShaderCache(const char* path);
+
+/*
+ * Save the reflections to the cache file, if there is one, then destroy the shader modules.
+ * The pipelines using them must be destroyed first.
+ */
+void frDestroyShaderCache(void);
+
+/*
+ * Get the shader module and reflection of a SPIR-V file.
+ * A file is read once, and files with the same code share their module.
+ * The reflection is skipped when the code is already known, from this launch or the cache file.
+ * Can be called from any thread.
+ *
+ * Parameters:
+ * - path: The path of the SPIR-V file.
+ * - pModule: A pointer to the shader module, owned by the cache.
+ * - pInfo: A pointer to a copy of the reflection, whose arrays are to be freed, or NULL.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_FILE_NOT_FOUND if the file could not be opened.
+ * - FR_ERROR_CORRUPTED_FILE if the file is not SPIR-V.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+FrResult frGetShader(const char* path, VkShaderModule* pModule, FrShaderInfo* pInfo);
+
+#endif
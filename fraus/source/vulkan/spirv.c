@@ -27,7 +27,10 @@ typedef struct FrSpvObject
 			uint32_t location;
 			uint32_t binding;
 			SpvStorageClass storageClass;
-			bool hasBlockDecoration;
+			// VkDescriptorType + 1, 0 when unknown
+			uint32_t descriptorType;
+			// Like typeDescriptorCount
+			uint32_t descriptorCount;
 		};
 
 		// Type
@@ -35,6 +38,25 @@ typedef struct FrSpvObject
 		{
 			uint32_t typeSize;
 			FrBaseType typeBase;
+			// VkDescriptorType + 1, 0 for the types that are not bound to descriptors
+			uint32_t typeDescriptorType;
+			// Length + 1 of arrays of descriptors, 1 for runtime arrays, 0 for the other types
+			uint32_t typeDescriptorCount;
+			// ArrayStride of arrays, 0 when tightly packed
+			uint32_t typeStride;
+			// Member with the largest Offset of structs + 1, 0 when the members have no offset
+			uint32_t lastMemberIndex;
+			uint32_t lastMemberOffset;
+		};
+
+		// Constant
+		struct
+		{
+			// SpecId + 1, 0 for the constants that cannot be specialized
+			uint32_t specId;
+			uint32_t constantSize;
+			// First word of the (default) value, for array lengths
+			uint32_t constantValue;
 		};
 	};
 } FrSpvObject;
@@ -114,6 +136,22 @@ static VkFormat frVariableFormat(uint32_t size, FrBaseType base)
 	return VK_FORMAT_UNDEFINED;
 }
 
+static int frCompareSpecializationConstants(const void* pAV, const void* pBV)
+{
+	const FrShaderSpecializationConstant* const pA = pAV;
+	const FrShaderSpecializationConstant* const pB = pBV;
+
+	if(pA->id < pB->id)
+	{
+		return -1;
+	}
+	if(pA->id > pB->id)
+	{
+		return 1;
+	}
+	return 0;
+}
+
 static int frCompareShaderVariable(const void* a, const void* b)
 {
 	const FrShaderVariable* const pA = a;
@@ -250,6 +288,96 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 				break;
 			}
 
+			case SpvOpTypeImage:
+			{
+				if(wordCount < 9)
+				{
+					free(objects);
+					return FR_ERROR_CORRUPTED_FILE;
+				}
+
+				const SpvId typeId = code[i + 1];
+				const SpvDim dimension = code[i + 3];
+				// 1 when sampled, 2 when read and written without a sampler
+				const uint32_t sampled = code[i + 7];
+
+				objects[typeId].objectType = opcode;
+				if(dimension == SpvDimSubpassData)
+				{
+					objects[typeId].typeDescriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT + 1;
+				}
+				else if(dimension == SpvDimBuffer)
+				{
+					objects[typeId].typeDescriptorType = (sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) + 1;
+				}
+				else
+				{
+					objects[typeId].typeDescriptorType = (sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) + 1;
+				}
+
+				break;
+			}
+
+			case SpvOpTypeSampler:
+			case SpvOpTypeSampledImage:
+			{
+				if(wordCount < 2)
+				{
+					free(objects);
+					return FR_ERROR_CORRUPTED_FILE;
+				}
+
+				const SpvId typeId = code[i + 1];
+
+				objects[typeId].objectType = opcode;
+				objects[typeId].typeDescriptorType = (opcode == SpvOpTypeSampler ? VK_DESCRIPTOR_TYPE_SAMPLER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) + 1;
+
+				break;
+			}
+
+			case SpvOpTypeArray:
+			{
+				if(wordCount != 4)
+				{
+					free(objects);
+					return FR_ERROR_CORRUPTED_FILE;
+				}
+
+				const SpvId typeId = code[i + 1];
+				const SpvId elementTypeId = code[i + 2];
+				const SpvId lengthId = code[i + 3];
+
+				// The stride includes the padding of the std140 and std430 layouts
+				objects[typeId].objectType = opcode;
+				const uint32_t stride = objects[typeId].typeStride ? objects[typeId].typeStride : objects[elementTypeId].typeSize;
+				objects[typeId].typeSize = stride * objects[lengthId].constantValue;
+				objects[typeId].typeBase = objects[elementTypeId].typeBase;
+				objects[typeId].typeDescriptorType = objects[elementTypeId].typeDescriptorType;
+				objects[typeId].typeDescriptorCount = objects[elementTypeId].typeDescriptorType ? objects[lengthId].constantValue + 1 : 0;
+
+				break;
+			}
+
+			case SpvOpTypeRuntimeArray:
+			{
+				if(wordCount != 3)
+				{
+					free(objects);
+					return FR_ERROR_CORRUPTED_FILE;
+				}
+
+				const SpvId typeId = code[i + 1];
+				const SpvId elementTypeId = code[i + 2];
+
+				// Only arrays of descriptors matter, the size of the others is unknown
+				objects[typeId].objectType = opcode;
+				objects[typeId].typeBase = objects[elementTypeId].typeBase;
+				objects[typeId].typeDescriptorType = objects[elementTypeId].typeDescriptorType;
+				objects[typeId].typeDescriptorCount = objects[elementTypeId].typeDescriptorType ? 1 : 0;
+
+				break;
+			}
+
 			case SpvOpTypeStruct:
 			{
 				if(wordCount < 2)
@@ -260,11 +388,20 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 
 				const SpvId typeId = code[i + 1];
 
+				// Members of blocks are laid out by their Offset, the others are packed
 				objects[typeId].objectType = opcode;
-				for(uint32_t j = 2; j < wordCount; ++j)
+				if(objects[typeId].lastMemberIndex && objects[typeId].lastMemberIndex < wordCount - 1)
+				{
+					const SpvId lastMemberTypeId = code[i + 1 + objects[typeId].lastMemberIndex];
+					objects[typeId].typeSize = objects[typeId].lastMemberOffset + objects[lastMemberTypeId].typeSize;
+				}
+				else
 				{
-					const SpvId memberTypeId = code[i + j];
-					objects[typeId].typeSize += objects[memberTypeId].typeSize;
+					for(uint32_t j = 2; j < wordCount; ++j)
+					{
+						const SpvId memberTypeId = code[i + j];
+						objects[typeId].typeSize += objects[memberTypeId].typeSize;
+					}
 				}
 
 				break;
@@ -284,6 +421,49 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 				objects[pointerId].objectType = opcode;
 				objects[pointerId].typeSize = objects[typeId].typeSize;
 				objects[pointerId].typeBase = objects[typeId].typeBase;
+				objects[pointerId].typeDescriptorType = objects[typeId].typeDescriptorType;
+				objects[pointerId].typeDescriptorCount = objects[typeId].typeDescriptorCount;
+
+				break;
+			}
+
+			case SpvOpConstant:
+			{
+				if(wordCount < 4)
+				{
+					free(objects);
+					return FR_ERROR_CORRUPTED_FILE;
+				}
+
+				const SpvId constantId = code[i + 2];
+
+				objects[constantId].objectType = opcode;
+				objects[constantId].constantValue = code[i + 3];
+
+				break;
+			}
+
+			case SpvOpSpecConstantTrue:
+			case SpvOpSpecConstantFalse:
+			case SpvOpSpecConstant:
+			{
+				if(wordCount < 3)
+				{
+					free(objects);
+					return FR_ERROR_CORRUPTED_FILE;
+				}
+
+				const SpvId typeId = code[i + 1];
+				const SpvId constantId = code[i + 2];
+
+				// The SpecId decoration comes first
+				objects[constantId].objectType = opcode;
+				objects[constantId].constantSize = opcode == SpvOpSpecConstant ? objects[typeId].typeSize : sizeof(VkBool32);
+				objects[constantId].constantValue = opcode == SpvOpSpecConstant && wordCount > 3 ? code[i + 3] : 0;
+				if(objects[constantId].specId)
+				{
+					++pInfo->specializationConstantCount;
+				}
 
 				break;
 			}
@@ -304,6 +484,8 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 				objects[variableId].size = objects[typeId].typeSize;
 				objects[variableId].base = objects[typeId].typeBase;
 				objects[variableId].storageClass = storageClass;
+				objects[variableId].descriptorType = objects[typeId].typeDescriptorType;
+				objects[variableId].descriptorCount = objects[typeId].typeDescriptorCount;
 
 				switch(storageClass)
 				{
@@ -334,7 +516,7 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 
 			case SpvOpDecorate:
 			{
-				if(wordCount < 4)
+				if(wordCount < 3)
 				{
 					break;
 				}
@@ -342,6 +524,28 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 				const SpvId targetId = code[i + 1];
 				const SpvDecoration decoration = code[i + 2];
 
+				// Types and constants are typed by their own instruction
+				// Storage buffers are BufferBlock structs in the Uniform storage class before SPIR-V 1.3
+				if(decoration == SpvDecorationBlock || decoration == SpvDecorationBufferBlock)
+				{
+					objects[targetId].typeDescriptorType = (decoration == SpvDecorationBufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) + 1;
+					break;
+				}
+				if(wordCount < 4)
+				{
+					break;
+				}
+				if(decoration == SpvDecorationSpecId)
+				{
+					objects[targetId].specId = code[i + 3] + 1;
+					break;
+				}
+				if(decoration == SpvDecorationArrayStride)
+				{
+					objects[targetId].typeStride = code[i + 3];
+					break;
+				}
+
 				objects[targetId].objectType = SpvOpVariable;
 
 				switch(decoration)
@@ -355,10 +559,6 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 						objects[targetId].location = code[i + 3] + 1;
 						break;
 
-					case SpvDecorationBlock:
-						objects[targetId].hasBlockDecoration = true;
-						break;
-
 					default:
 						break;
 				}
@@ -366,6 +566,38 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 				break;
 			}
 
+			case SpvOpMemberDecorate:
+			{
+				if(wordCount < 5 || code[i + 3] != SpvDecorationOffset)
+				{
+					break;
+				}
+
+				const SpvId typeId = code[i + 1];
+				const uint32_t memberIndex = code[i + 2];
+				const uint32_t offset = code[i + 4];
+
+				if(!objects[typeId].lastMemberIndex || offset >= objects[typeId].lastMemberOffset)
+				{
+					objects[typeId].lastMemberIndex = memberIndex + 1;
+					objects[typeId].lastMemberOffset = offset;
+				}
+
+				break;
+			}
+
+			case SpvOpExecutionMode:
+			{
+				if(wordCount >= 6 && code[i + 2] == SpvExecutionModeLocalSize)
+				{
+					pInfo->localSize[0] = code[i + 3];
+					pInfo->localSize[1] = code[i + 4];
+					pInfo->localSize[2] = code[i + 5];
+				}
+
+				break;
+			}
+
 			default:
 				break;
 		}
@@ -419,6 +651,19 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 			return FR_ERROR_OUT_OF_HOST_MEMORY;
 		}
 	}
+	if(pInfo->specializationConstantCount)
+	{
+		pInfo->specializationConstants = malloc(pInfo->specializationConstantCount * sizeof(pInfo->specializationConstants[0]));
+		if(!pInfo->specializationConstants)
+		{
+			free(pInfo->pushConstants);
+			free(pInfo->outputs);
+			free(pInfo->inputs);
+			free(pInfo->bindings);
+			free(objects);
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
 
 
 	i = idsBound - 1;
@@ -459,18 +704,18 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 		else if(objects[i].binding)
 		{
 			pInfo->bindings[bindingCounter].binding = objects[i].binding - 1;
-			pInfo->bindings[bindingCounter].descriptorCount = 1;
+			pInfo->bindings[bindingCounter].descriptorCount = objects[i].descriptorCount ? objects[i].descriptorCount - 1 : 1;
 			pInfo->bindings[bindingCounter].stageFlags = 0;
 			pInfo->bindings[bindingCounter].pImmutableSamplers = NULL;
 
 			switch(objects[i].storageClass)
 			{
 				case SpvStorageClassUniformConstant:
-					pInfo->bindings[bindingCounter].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+					pInfo->bindings[bindingCounter].descriptorType = objects[i].descriptorType ? (VkDescriptorType)(objects[i].descriptorType - 1) : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 					break;
 
 				case SpvStorageClassUniform:
-					pInfo->bindings[bindingCounter].descriptorType = objects[i].hasBlockDecoration ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+					pInfo->bindings[bindingCounter].descriptorType = objects[i].descriptorType ? (VkDescriptorType)(objects[i].descriptorType - 1) : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 					break;
 
 				case SpvStorageClassStorageBuffer:
@@ -487,8 +732,24 @@ FrResult frParseSpirv(const uint32_t* code, size_t size, FrShaderInfo* pInfo)
 		--i;
 	}
 
+	uint32_t specializationConstantCounter = 0;
+	for(uint32_t objectIndex = 0; objectIndex < idsBound; ++objectIndex)
+	{
+		const SpvOp objectType = objects[objectIndex].objectType;
+		if((objectType == SpvOpSpecConstantTrue || objectType == SpvOpSpecConstantFalse || objectType == SpvOpSpecConstant) && objects[objectIndex].specId)
+		{
+			pInfo->specializationConstants[specializationConstantCounter].id = objects[objectIndex].specId - 1;
+			pInfo->specializationConstants[specializationConstantCounter].size = objects[objectIndex].constantSize;
+			++specializationConstantCounter;
+		}
+	}
+
 	free(objects);
 
+	if(pInfo->specializationConstants)
+	{
+		qsort(pInfo->specializationConstants, pInfo->specializationConstantCount, sizeof(pInfo->specializationConstants[0]), frCompareSpecializationConstants);
+	}
 	if(pInfo->inputs)
 	{
 		qsort(pInfo->inputs, pInfo->inputCount, sizeof(pInfo->inputs[0]), frCompareShaderVariable);
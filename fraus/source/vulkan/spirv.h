@@ -11,6 +11,13 @@ typedef struct FrShaderVariable
 	VkFormat format;
 } FrShaderVariable;
 
+typedef struct FrShaderSpecializationConstant
+{
+	uint32_t id;
+	// Booleans are VkBool32
+	uint32_t size;
+} FrShaderSpecializationConstant;
+
 typedef struct FrShaderInfo
 {
 	uint32_t inputCount;
@@ -18,11 +25,19 @@ typedef struct FrShaderInfo
 	uint32_t outputCount;
 	FrShaderVariable* outputs;
 
+	// Arrays of descriptors have their length as descriptorCount, 0 for runtime arrays
 	uint32_t bindingCount;
 	VkDescriptorSetLayoutBinding* bindings;
 
 	uint32_t pushConstantCount;
 	VkPushConstantRange* pushConstants;
+
+	// Sorted by id
+	uint32_t specializationConstantCount;
+	FrShaderSpecializationConstant* specializationConstants;
+
+	// Workgroup size of compute shaders, 0 for the other stages
+	uint32_t localSize[3];
 } FrShaderInfo;
 
 int frCompareBindings(const void* pAV, const void* pAB);
@@ -2,20 +2,26 @@
 
 #include <assert.h>
 #include <inttypes.h>
+#include <stdalign.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <spirv-headers/spirv.h>
 
 #include "../../include/fraus/fraus.h"
+#include "./shader_cache.h"
 #include "./spirv.h"
 
 FR_DEFINE_VECTOR(FrPipeline, Pipeline)
+FR_DEFINE_VECTOR(FrComputePipeline, ComputePipeline)
+FR_DEFINE_VECTOR(FrComputeDispatch, ComputeDispatch)
 FR_DEFINE_VECTOR(FrUniformBuffer, UniformBuffer)
 FR_DEFINE_VECTOR(FrStorageBuffer, StorageBuffer)
 FR_DEFINE_VECTOR(FrTexture, Texture)
+FR_DEFINE_VECTOR(FrRetiredResource, RetiredResource)
 
 VkInstance instance;
 #ifndef NDEBUG
@@ -27,31 +33,59 @@ VkPhysicalDevice physicalDevice;
 VkDevice device;
 uint32_t queueFamily;
 VkQueue queue;
+uint32_t transferQueueFamily;
+VkQueue transferQueue;
+bool multiDrawIndirectAvailable;
+bool drawIndirectFirstInstanceAvailable;
 
 VkSwapchainKHR swapchain;
 VkExtent2D swapchainExtent;
 VkFormat swapchainFormat;
+FrPresentMode presentModePreference;
+VkPresentModeKHR swapchainPresentMode;
 uint32_t swapchainImageCount;
 VkImage* swapchainImages;
 VkImageView* swapchainImageViews;
 
 VkRenderPass renderPass;
+VkRenderPass earlyRenderPass;
 VkFramebuffer* framebuffers;
 
 FrPipelineVector graphicsPipelines;
+FrComputePipelineVector computePipelines;
+FrComputeDispatches computeDispatches;
+FrBindless bindless;
+FrDescriptorAllocator descriptorAllocator;
+FrDescriptorAllocator frameDescriptorAllocators[FR_MAX_FRAMES_IN_FLIGHT];
 FrUniformBufferVector uniformBuffers;
 FrStorageBufferVector storageBuffers;
 uint32_t textureMipLevels;
 FrTextureVector textures;
 VkSampleCountFlagBits msaaSamples;
+VkSampleCountFlagBits maxMsaaSamples;
+VkSampleCountFlagBits msaaSamplesPreference;
+FrPostProcess postProcess;
+bool postProcessPreference;
 FrVulkanObjectVector frObjects;
-
-VkSemaphore imageAvailableSemaphores[FR_FRAMES_IN_FLIGHT];
-VkSemaphore renderFinishedSemaphores[FR_FRAMES_IN_FLIGHT];
-VkFence frameInFlightFences[FR_FRAMES_IN_FLIGHT];
-
-VkCommandPool commandPools[FR_FRAMES_IN_FLIGHT];
-VkCommandBuffer commandBuffers[FR_FRAMES_IN_FLIGHT];
+FrMeshArena meshArena;
+FrMaterialVector materials;
+FrFrameBuffer transformBuffer;
+FrFrameBuffer indirectBuffer;
+FrCulling culling;
+FrSphereVector cullSpheres;
+FrRetiredResourceVector retiredResources;
+FrDrawPacketVector drawList;
+FrDrawPacketVector drawListScratch;
+FrDrawStatistics drawStatistics;
+
+VkSemaphore imageAvailableSemaphores[FR_MAX_FRAMES_IN_FLIGHT];
+VkSemaphore renderFinishedSemaphores[FR_MAX_FRAMES_IN_FLIGHT];
+
+VkCommandPool commandPools[FR_MAX_FRAMES_IN_FLIGHT];
+VkCommandBuffer commandBuffers[FR_MAX_FRAMES_IN_FLIGHT];
+FrRecording recording;
+FrFrameState frameState;
+FrFrameSteps frameSteps;
 
 VkImage colorImage;
 VkDeviceMemory colorImageMemory;
@@ -60,7 +94,11 @@ VkImage depthImage;
 VkDeviceMemory depthImageMemory;
 VkImageView depthImageView;
 VkSampler textureSampler;
+FrPipelineCache pipelineCache;
 
+uint32_t framesInFlight;
+VkSemaphore frameTimelineSemaphore;
+uint64_t frameCounter;
 uint32_t frameInFlightIndex;
 uint32_t swapchainImageIndex;
 
@@ -75,16 +113,99 @@ static FrResult frCreateDevice(void);
 static FrResult frCreateSwapchain(void);
 static FrResult frCreateRenderPass(void);
 static FrResult frCreateFramebuffers(void);
-static FrResult frCreateShaderModule(const char* path, VkShaderModule* pShaderModule, FrShaderInfo* pInfo);
+static FrResult frCreatePipelineCache(const char* path);
+static void frSavePipelineCache(void);
+static VkResult frCompileGraphicsPipeline(const VkGraphicsPipelineCreateInfo* pCreateInfo, VkPipeline* pPipeline);
+static VkResult frCompileComputePipeline(const VkComputePipelineCreateInfo* pCreateInfo, VkPipeline* pPipeline);
 static FrResult frCreateSampler(void);
 static FrResult frCreateColorImage(void);
 static FrResult frCreateDepthImage(void);
 static FrResult frCreateCommandPools(void);
+static FrResult frCreatePostProcess(const char* vertexShaderPath, const char* fragmentShaderPath);
+static FrResult frCreateCulling(const char* computeShaderPath, const char* pyramidShaderPath);
+static bool frIsOcclusionCullingActive(void);
+static FrResult frCreateDepthPyramid(void);
+static FrResult frBuildGraphicsPipeline(const FrPipeline* pPipeline, uint32_t pipelineIndex, VkPipeline* pHandle);
+static void frPublishPipelines(bool wait);
+static FrResult frLoadComputePipeline(const char* shaderPath, const char* name, FrComputePipeline* pPipeline);
+static void frDestroyComputePipeline(FrComputePipeline* pPipeline);
+static void frGetComputeGroupCounts(const FrComputePipeline* pPipeline, const uint32_t invocationCounts[3], uint32_t groupCounts[3]);
+static bool frAreDispatchResourcesAlive(const FrComputePipeline* pPipeline, const uint32_t* bindingIndexes);
+static FrResult frCreateBindless(void);
+static FrResult frCaptureComputeDispatches(void);
+static void frRecordStorageImageBarriers(const FrComputePipeline* pPipeline, const uint32_t* bindingIndexes, bool write);
+static FrResult frRecordComputeDispatches(void);
+static FrResult frRetireRenderTargets(void);
+static bool frIsIndirectObject(const FrVulkanObject* pObject);
+static FrResult frBuildDrawList(const FrFrustum* pFrustum, uint32_t* pCulledCount, uint32_t* pGpuCullCount);
+static FrResult frCreateRecorders(void);
+static void frDestroyRecorders(void);
+static size_t frGetBatchEnd(size_t packetIndex);
+static uint32_t frSplitDrawList(uint32_t maxRangeCount, FrDrawRange* pRanges);
+static void frSetViewport(VkCommandBuffer commandBuffer);
+static void frAddDrawStatistics(FrDrawStatistics* pTotal, const FrDrawStatistics* pStatistics);
+static void frRecordIndirectDraws(VkCommandBuffer commandBuffer, uint32_t firstCommand, uint32_t commandCount, FrDrawStatistics* pStatistics);
+static uint32_t frRecordSceneDraws(VkCommandBuffer commandBuffer, bool earlyPass, const FrDrawRange* pRange, uint32_t lateCommandOffset, FrCullInstance* pCullInstances, FrDrawStatistics* pStatistics);
+static FrResult frRecordDrawRange(FrRecorder* pRecorder);
+static void frRecordDrawRangeJob(void* pRecorderVoid);
+static FrResult frReserveFrameState(FrFrameState* pState, uint32_t objectCount);
+static FrResult frCaptureState(FrFrameState* pState);
+static FrResult frReserveVisibilityBuffer(void);
+static void frDispatchCulling(const FrCullConstants* pConstants);
+static void frBuildDepthPyramid(void);
+
+/*
+ * Check that a sample count is a single VkSampleCountFlagBits value.
+ *
+ * Parameters:
+ * - samples: The sample count.
+ *
+ * Returns:
+ * - true if the sample count is valid.
+ * - false otherwise.
+ */
+static bool frIsSampleCountValid(VkSampleCountFlagBits samples)
+{
+	return samples && samples <= VK_SAMPLE_COUNT_64_BIT && !(samples & (samples - 1));
+}
+
+/*
+ * Get the highest sample count supported by the device that does not exceed a requested count.
+ *
+ * Parameters:
+ * - samples: The requested sample count.
+ *
+ * Returns:
+ * - The sample count to use.
+ */
+static VkSampleCountFlagBits frChooseSampleCount(VkSampleCountFlagBits samples)
+{
+	return samples < maxMsaaSamples ? samples : maxMsaaSamples;
+}
 
-FrResult frCreateVulkanData(const char* name, uint32_t version)
+FrResult frCreateVulkanData(const char* name, uint32_t version, const FrVulkanCreateInfo* pCreateInfo)
 {
 	assert(name != NULL);
 
+	framesInFlight = pCreateInfo && pCreateInfo->framesInFlight ? pCreateInfo->framesInFlight : FR_DEFAULT_FRAMES_IN_FLIGHT;
+	if(framesInFlight > FR_MAX_FRAMES_IN_FLIGHT)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+	presentModePreference = pCreateInfo ? pCreateInfo->presentMode : FR_PRESENT_MODE_DEFAULT;
+	if(presentModePreference > FR_PRESENT_MODE_IMMEDIATE)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+	msaaSamplesPreference = pCreateInfo && pCreateInfo->msaaSamples ? pCreateInfo->msaaSamples : FR_DEFAULT_MSAA_SAMPLES;
+	if(!frIsSampleCountValid(msaaSamplesPreference))
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+	const bool postProcessAvailable = pCreateInfo && pCreateInfo->postProcessVertexShaderPath && pCreateInfo->postProcessFragmentShaderPath;
+	postProcessPreference = postProcessAvailable;
+	postProcess = (FrPostProcess){0};
+
 	swapchain = VK_NULL_HANDLE;
 	swapchainImages = NULL;
 	swapchainImageViews = NULL;
@@ -94,10 +215,41 @@ FrResult frCreateVulkanData(const char* name, uint32_t version)
 	{
 		return EXIT_FAILURE;
 	}
+	if(frCreateMaterialVector(&materials) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	// Both are also read and written by the culling compute shader
+	transformBuffer = (FrFrameBuffer){.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT};
+	indirectBuffer = (FrFrameBuffer){.usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT};
+	culling = (FrCulling){
+		.instanceBuffer.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		.visibleTransformBuffer = {
+			.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			.deviceLocal = true
+		}
+	};
+	if(frCreateSphereVector(&cullSpheres) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 	if(frCreatePipelineVector(&graphicsPipelines) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
+	if(frCreateComputePipelineVector(&computePipelines) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	computeDispatches = (FrComputeDispatches){0};
+	if(frCreateComputeDispatchVector(&computeDispatches.queued) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	if(frCreateComputeDispatchVector(&computeDispatches.captured) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 	if(frCreateUniformBufferVector(&uniformBuffers) != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
@@ -110,6 +262,18 @@ FrResult frCreateVulkanData(const char* name, uint32_t version)
 	{
 		return EXIT_FAILURE;
 	}
+	if(frCreateRetiredResourceVector(&retiredResources) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	if(frCreateDrawPacketVector(&drawList) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	if(frCreateDrawPacketVector(&drawListScratch) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 
 	if(frCreateInstance(name, version) != FR_SUCCESS)
 	{
@@ -123,18 +287,40 @@ FrResult frCreateVulkanData(const char* name, uint32_t version)
 	{
 		return EXIT_FAILURE;
 	}
+	msaaSamples = frChooseSampleCount(msaaSamplesPreference);
+	postProcess.enabled = postProcessPreference;
 	if(frCreateDevice() != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
+	if(frCreatePipelineCache(pCreateInfo ? pCreateInfo->pipelineCachePath : NULL) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	if(frCreateShaderCache(pCreateInfo ? pCreateInfo->shaderCachePath : NULL) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 	if(frCreateSwapchain() != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
+	// Culled instances are drawn with a non zero first instance
+	if(
+		pCreateInfo && pCreateInfo->cullComputeShaderPath && drawIndirectFirstInstanceAvailable &&
+		frCreateCulling(pCreateInfo->cullComputeShaderPath, pCreateInfo->depthPyramidComputeShaderPath) != FR_SUCCESS
+	)
+	{
+		return EXIT_FAILURE;
+	}
 	if(frCreateRenderPass() != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
+	if(postProcessAvailable && frCreatePostProcess(pCreateInfo->postProcessVertexShaderPath, pCreateInfo->postProcessFragmentShaderPath) != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 	if(frCreateColorImage() != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
@@ -143,6 +329,10 @@ FrResult frCreateVulkanData(const char* name, uint32_t version)
 	{
 		return EXIT_FAILURE;
 	}
+	if(culling.enabled && frCreateDepthPyramid() != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 	if(frCreateFramebuffers() != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
@@ -151,10 +341,22 @@ FrResult frCreateVulkanData(const char* name, uint32_t version)
 	{
 		return EXIT_FAILURE;
 	}
+	if(frCreateRecorders() != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 	if(frCreateSampler() != FR_SUCCESS)
 	{
 		return EXIT_FAILURE;
 	}
+	if(bindless.available && frCreateBindless() != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
+	if(frCreateMeshArena() != FR_SUCCESS)
+	{
+		return EXIT_FAILURE;
+	}
 	// Camera transform buffer
 	if(frCreateUniformBuffer(sizeof(float[16])) != FR_SUCCESS)
 	{
@@ -166,16 +368,29 @@ FrResult frCreateVulkanData(const char* name, uint32_t version)
 
 FrResult frDestroyVulkanData(void)
 {
+	// The jobs of the background builds must not outlive the job system
+	frPublishPipelines(true);
+
 	vkDestroyBuffer(device, instanceBuffer, NULL);
 	vkFreeMemory(device, instanceBufferMemory, NULL);
 
-	for(uint32_t i = 0; i < FR_FRAMES_IN_FLIGHT; ++i)
+	frDestroyRecorders();
+	for(uint32_t i = 0; i < framesInFlight; ++i)
 	{
 		vkDestroyCommandPool(device, commandPools[i], NULL);
 		vkDestroySemaphore(device, imageAvailableSemaphores[i], NULL);
 		vkDestroySemaphore(device, renderFinishedSemaphores[i], NULL);
-		vkDestroyFence(device, frameInFlightFences[i], NULL);
 	}
+	vkDestroySemaphore(device, frameTimelineSemaphore, NULL);
+	vkDestroyDescriptorPool(device, bindless.descriptorPool, NULL);
+	vkDestroyDescriptorSetLayout(device, bindless.descriptorSetLayout, NULL);
+	vkDestroyBuffer(device, bindless.defaultStorageBuffer, NULL);
+	vkFreeMemory(device, bindless.defaultStorageBufferMemory, NULL);
+	vkDestroyImageView(device, bindless.defaultImageView, NULL);
+	vkDestroyImage(device, bindless.defaultImage, NULL);
+	vkFreeMemory(device, bindless.defaultImageMemory, NULL);
+	// The retired descriptors left are not written anymore
+	bindless.available = false;
 	vkDestroySampler(device, textureSampler, NULL);
 	
 	for(uint32_t textureIndex = 0; textureIndex < textures.size; ++textureIndex)
@@ -195,7 +410,7 @@ FrResult frDestroyVulkanData(void)
 
 	for(uint32_t uniformBufferIndex = 0; uniformBufferIndex < uniformBuffers.size; ++uniformBufferIndex)
 	{
-		for(uint32_t frameIndex = 0; frameIndex < FR_FRAMES_IN_FLIGHT; ++frameIndex)
+		for(uint32_t frameIndex = 0; frameIndex < framesInFlight; ++frameIndex)
 		{
 			vkDestroyBuffer(device, uniformBuffers.data[uniformBufferIndex].buffers[frameIndex], NULL);
 			vkFreeMemory(device, uniformBuffers.data[uniformBufferIndex].bufferMemories[frameIndex], NULL);
@@ -203,37 +418,92 @@ FrResult frDestroyVulkanData(void)
 	}
 	frDestroyUniformBufferVector(&uniformBuffers);
 
-	for(uint32_t objectIndex = 0; objectIndex < frObjects.size; ++objectIndex)
+	frDestroyVulkanObjectVector(&frObjects);
+	frDestroyMeshArena();
+	for(uint32_t materialIndex = 0; materialIndex < materials.size; ++materialIndex)
 	{
-		frDestroyObject(&frObjects.data[objectIndex]);
+		free(materials.data[materialIndex].bindingIndexes);
 	}
-	frDestroyVulkanObjectVector(&frObjects);
+	frDestroyMaterialVector(&materials);
+	frDestroyFrameBuffer(&transformBuffer);
+	frDestroyFrameBuffer(&indirectBuffer);
+	frDestroySphereVector(&cullSpheres);
+
+	frDestroyComputePipeline(&culling.pipeline);
+	vkDestroyDescriptorPool(device, culling.descriptorPool, NULL);
+	frDestroyFrameBuffer(&culling.instanceBuffer);
+	frDestroyFrameBuffer(&culling.visibleTransformBuffer);
+	frDestroyComputePipeline(&culling.pyramidPipeline);
+	vkDestroySampler(device, culling.pyramidSampler, NULL);
+	vkDestroyBuffer(device, culling.visibilityBuffer, NULL);
+	vkFreeMemory(device, culling.visibilityBufferMemory, NULL);
 
 	for(uint32_t pipelineIndex = 0; pipelineIndex < graphicsPipelines.size; ++pipelineIndex)
 	{
 		vkDestroyPipeline(device, graphicsPipelines.data[pipelineIndex].pipeline, NULL);
 		vkDestroyPipelineLayout(device, graphicsPipelines.data[pipelineIndex].pipelineLayout, NULL);
 		vkDestroyDescriptorSetLayout(device, graphicsPipelines.data[pipelineIndex].descriptorSetLayout, NULL);
+		free(graphicsPipelines.data[pipelineIndex].vertexBindings);
+		free(graphicsPipelines.data[pipelineIndex].vertexAttributes);
 		free(graphicsPipelines.data[pipelineIndex].descriptorTypes);
+		free(graphicsPipelines.data[pipelineIndex].specializationEntries);
+		free(graphicsPipelines.data[pipelineIndex].specializationData);
 	}
 	frDestroyPipelineVector(&graphicsPipelines);
 
+	for(uint32_t pipelineIndex = 0; pipelineIndex < computePipelines.size; ++pipelineIndex)
+	{
+		frDestroyComputePipeline(&computePipelines.data[pipelineIndex]);
+	}
+	frDestroyComputePipelineVector(&computePipelines);
+	frDestroyComputeDispatchVector(&computeDispatches.queued);
+	frDestroyComputeDispatchVector(&computeDispatches.captured);
+
+	vkDestroyPipeline(device, postProcess.pipeline, NULL);
+	vkDestroyPipelineLayout(device, postProcess.pipelineLayout, NULL);
+	vkDestroyDescriptorPool(device, postProcess.descriptorPool, NULL);
+	vkDestroyDescriptorSetLayout(device, postProcess.descriptorSetLayout, NULL);
+	vkDestroySampler(device, postProcess.sampler, NULL);
+	vkDestroyRenderPass(device, postProcess.renderPass, NULL);
+
 	vkDestroyRenderPass(device, renderPass, NULL);
-	vkDestroyImageView(device, depthImageView, NULL);
-	vkDestroyImage(device, depthImage, NULL);
-	vkFreeMemory(device, depthImageMemory, NULL);
-	vkDestroyImageView(device, colorImageView, NULL);
-	vkDestroyImage(device, colorImage, NULL);
-	vkFreeMemory(device, colorImageMemory, NULL);
+	vkDestroyRenderPass(device, earlyRenderPass, NULL);
+	if(frRetireRenderTargets() != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	// The device is idle, every retired resource can go
+	frDestroyRetiredResources(UINT64_MAX);
+	frDestroyRetiredResourceVector(&retiredResources);
+	// After the retired resources, which give descriptor sets back to their allocator
+	frDestroyDescriptorAllocator(&descriptorAllocator);
+	for(uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		frDestroyDescriptorAllocator(&frameDescriptorAllocators[i]);
+	}
+	frDestroyDrawPacketVector(&drawList);
+	frDestroyDrawPacketVector(&drawListScratch);
+	free(frameState.transforms);
+	frameState = (FrFrameState){0};
+	free(frameSteps.states[0].transforms);
+	free(frameSteps.states[1].transforms);
+	frameSteps = (FrFrameSteps){0};
 	for(uint32_t i = 0; i < swapchainImageCount; ++i)
 	{
-		vkDestroyFramebuffer(device, framebuffers[i], NULL);
 		vkDestroyImageView(device, swapchainImageViews[i], NULL);
 	}
 	free(framebuffers);
 	free(swapchainImageViews);
 	free(swapchainImages);
 	vkDestroySwapchainKHR(device, swapchain, NULL);
+	// A cache that cannot be saved is rebuilt by the next launch
+	frSavePipelineCache();
+	vkDestroyPipelineCache(device, pipelineCache.cache, NULL);
+	free(pipelineCache.path);
+	pipelineCache = (FrPipelineCache){0};
+	// Every pipeline is destroyed, and the culling and post-process ones
+	frDestroyShaderCache();
+
 	vkDestroyDevice(device, NULL);
 	vkDestroySurfaceKHR(instance, surface, NULL);
 #ifndef NDEBUG
@@ -636,6 +906,11 @@ static FrResult frCreateInstance(const char* name, uint32_t version)
 		if(vkEnumerateInstanceVersion(&vulkanVersion) != VK_SUCCESS) return FR_ERROR_UNKNOWN;
 	}
 	#endif
+	// Timeline semaphores are core since Vulkan 1.2
+	if(vulkanVersion < VK_API_VERSION_1_2)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
 
 	const VkApplicationInfo applicationInfo = {
 		.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
@@ -704,6 +979,26 @@ static FrResult frChoosePhysicalDevice(void)
 
 	for(uint32_t i = 1; i < physicalDeviceCount; ++i)
 	{
+		// Frame pacing requires timeline semaphores
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevices[i], &deviceProperties);
+		if(deviceProperties.apiVersion < VK_API_VERSION_1_2)
+		{
+			continue;
+		}
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES
+		};
+		VkPhysicalDeviceFeatures2 features = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &vulkan12Features
+		};
+		vkGetPhysicalDeviceFeatures2(physicalDevices[i], &features);
+		if(!vulkan12Features.timelineSemaphore)
+		{
+			continue;
+		}
+
 		uint32_t queueFamilyPropertyCount;
 		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevices[i], &queueFamilyPropertyCount, NULL);
 		VkQueueFamilyProperties* const queueFamilyProperties = malloc(queueFamilyPropertyCount * sizeof(queueFamilyProperties[0]));
@@ -729,37 +1024,51 @@ static FrResult frChoosePhysicalDevice(void)
 				physicalDevice = physicalDevices[i];
 				queueFamily = j;
 
+				// Prefer a transfer-only queue family (DMA engine) for uploads
+				transferQueueFamily = queueFamily;
+				for(uint32_t k = 0; k < queueFamilyPropertyCount; ++k)
+				{
+					if(
+						(queueFamilyProperties[k].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+						!(queueFamilyProperties[k].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+					)
+					{
+						transferQueueFamily = k;
+						break;
+					}
+				}
+
 				VkPhysicalDeviceProperties properties;
 				vkGetPhysicalDeviceProperties(physicalDevice, &properties);
 
 				const VkSampleCountFlags counts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
 				if(counts & VK_SAMPLE_COUNT_64_BIT)
 				{
-					msaaSamples = VK_SAMPLE_COUNT_64_BIT;
+					maxMsaaSamples = VK_SAMPLE_COUNT_64_BIT;
 				}
 				else if(counts & VK_SAMPLE_COUNT_32_BIT)
 				{
-					msaaSamples = VK_SAMPLE_COUNT_32_BIT;
+					maxMsaaSamples = VK_SAMPLE_COUNT_32_BIT;
 				}
 				else if(counts & VK_SAMPLE_COUNT_16_BIT)
 				{
-					msaaSamples = VK_SAMPLE_COUNT_16_BIT;
+					maxMsaaSamples = VK_SAMPLE_COUNT_16_BIT;
 				}
 				else if(counts & VK_SAMPLE_COUNT_8_BIT)
 				{
-					msaaSamples = VK_SAMPLE_COUNT_8_BIT;
+					maxMsaaSamples = VK_SAMPLE_COUNT_8_BIT;
 				}
 				else if(counts & VK_SAMPLE_COUNT_4_BIT)
 				{
-					msaaSamples = VK_SAMPLE_COUNT_4_BIT;
+					maxMsaaSamples = VK_SAMPLE_COUNT_4_BIT;
 				}
 				else if(counts & VK_SAMPLE_COUNT_2_BIT)
 				{
-					msaaSamples = VK_SAMPLE_COUNT_2_BIT;
+					maxMsaaSamples = VK_SAMPLE_COUNT_2_BIT;
 				}
 				else
 				{
-					msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+					maxMsaaSamples = VK_SAMPLE_COUNT_1_BIT;
 				}
 
 				free(queueFamilyProperties);
@@ -864,22 +1173,133 @@ static FrResult frCreateDevice(void)
 		}
 	}
 
-	const VkDeviceQueueCreateInfo queueCreateInfo = {
-		.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-		.queueFamilyIndex = queueFamily,
-		.queueCount = 1,
-		.pQueuePriorities = &priority
+	const VkDeviceQueueCreateInfo queueCreateInfos[] = {
+		{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.queueFamilyIndex = queueFamily,
+			.queueCount = 1,
+			.pQueuePriorities = &priority
+		},
+		{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.queueFamilyIndex = transferQueueFamily,
+			.queueCount = 1,
+			.pQueuePriorities = &priority
+		}
 	};
 
 	VkPhysicalDeviceFeatures features, wantedFeatures = {VK_FALSE};
 	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
 	wantedFeatures.samplerAnisotropy = features.samplerAnisotropy;
 	wantedFeatures.sampleRateShading = features.sampleRateShading;
+	// Without them, draws fall back to one indirect command per call or to direct draws
+	wantedFeatures.multiDrawIndirect = features.multiDrawIndirect;
+	wantedFeatures.drawIndirectFirstInstance = features.drawIndirectFirstInstance;
+	multiDrawIndirectAvailable = features.multiDrawIndirect;
+	drawIndirectFirstInstanceAvailable = features.drawIndirectFirstInstance;
+
+	VkPhysicalDeviceVulkan12Features availableVulkan12Features = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES
+	};
+	VkPhysicalDeviceFeatures2 features2 = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		.pNext = &availableVulkan12Features
+	};
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+	// Without them, bindless pipelines cannot be created
+	bindless.available =
+		features.shaderUniformBufferArrayDynamicIndexing &&
+		features.shaderStorageBufferArrayDynamicIndexing &&
+		features.shaderSampledImageArrayDynamicIndexing &&
+		availableVulkan12Features.runtimeDescriptorArray &&
+		availableVulkan12Features.descriptorBindingPartiallyBound &&
+		availableVulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+		availableVulkan12Features.descriptorBindingUniformBufferUpdateAfterBind &&
+		availableVulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+		availableVulkan12Features.descriptorBindingSampledImageUpdateAfterBind;
+	if(bindless.available)
+	{
+		VkPhysicalDeviceVulkan12Properties vulkan12Properties = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES
+		};
+		VkPhysicalDeviceProperties2 properties2 = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+			.pNext = &vulkan12Properties
+		};
+		vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+		// Every binding is visible to both stages, and combined image samplers count as samplers and as sampled images
+		// The buffers have no sampler limits, UINT32_MAX fills their rows
+		const uint32_t limits[][5] = {
+			{
+				FR_BINDLESS_MAX_UNIFORM_BUFFERS,
+				vulkan12Properties.maxPerStageDescriptorUpdateAfterBindUniformBuffers,
+				vulkan12Properties.maxDescriptorSetUpdateAfterBindUniformBuffers,
+				UINT32_MAX,
+				UINT32_MAX
+			},
+			{
+				FR_BINDLESS_MAX_STORAGE_BUFFERS,
+				vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+				vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+				UINT32_MAX,
+				UINT32_MAX
+			},
+			{
+				FR_BINDLESS_MAX_TEXTURES,
+				vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+				vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+				vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+				vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers
+			}
+		};
+		for(uint32_t i = 0; i < FR_LEN(limits); ++i)
+		{
+			bindless.capacities[i] = limits[i][0];
+			for(uint32_t j = 1; j < FR_LEN(limits[i]); ++j)
+			{
+				bindless.capacities[i] = limits[i][j] < bindless.capacities[i] ? limits[i][j] : bindless.capacities[i];
+			}
+		}
+		const uint32_t resourceCount = bindless.capacities[0] + bindless.capacities[1] + bindless.capacities[2];
+		if(resourceCount > vulkan12Properties.maxPerStageUpdateAfterBindResources)
+		{
+			// Scale every binding down alike
+			for(uint32_t i = 0; i < FR_LEN(bindless.capacities); ++i)
+			{
+				bindless.capacities[i] = (uint32_t)((uint64_t)bindless.capacities[i] * vulkan12Properties.maxPerStageUpdateAfterBindResources / resourceCount);
+			}
+		}
+		for(uint32_t i = 0; i < FR_LEN(bindless.capacities); ++i)
+		{
+			if(bindless.capacities[i] == 0)
+			{
+				bindless.available = false;
+			}
+		}
+	}
+
+	wantedFeatures.shaderUniformBufferArrayDynamicIndexing = bindless.available;
+	wantedFeatures.shaderStorageBufferArrayDynamicIndexing = bindless.available;
+	wantedFeatures.shaderSampledImageArrayDynamicIndexing = bindless.available;
+
+	const VkPhysicalDeviceVulkan12Features vulkan12Features = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+		.runtimeDescriptorArray = bindless.available,
+		.descriptorBindingPartiallyBound = bindless.available,
+		.descriptorBindingUpdateUnusedWhilePending = bindless.available,
+		.descriptorBindingUniformBufferUpdateAfterBind = bindless.available,
+		.descriptorBindingStorageBufferUpdateAfterBind = bindless.available,
+		.descriptorBindingSampledImageUpdateAfterBind = bindless.available,
+		.timelineSemaphore = VK_TRUE
+	};
 
 	const VkDeviceCreateInfo createInfo = {
 		.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-		.queueCreateInfoCount = 1,
-		.pQueueCreateInfos = &queueCreateInfo,
+		.pNext = &vulkan12Features,
+		.queueCreateInfoCount = transferQueueFamily != queueFamily ? 2 : 1,
+		.pQueueCreateInfos = queueCreateInfos,
 		.enabledExtensionCount = finalExtensionCount,
 		.ppEnabledExtensionNames = finalExtensions,
 		.pEnabledFeatures = &wantedFeatures
@@ -939,6 +1359,7 @@ static FrResult frCreateDevice(void)
 	}
 
 	vkGetDeviceQueue(device, queueFamily, 0, &queue);
+	vkGetDeviceQueue(device, transferQueueFamily, 0, &transferQueue);
 
 	#ifndef NDEBUG
 	if(debugExtensionAvailable)
@@ -953,6 +1374,16 @@ static FrResult frCreateDevice(void)
 		{
 			return FR_ERROR_UNKNOWN;
 		}
+
+		if(transferQueue != queue)
+		{
+			nameInfo.objectHandle = (uint64_t)transferQueue;
+			nameInfo.pObjectName = "Fraus transfer queue";
+			if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+			{
+				return FR_ERROR_UNKNOWN;
+			}
+		}
 	}
 	#endif
 
@@ -1013,30 +1444,33 @@ static FrResult frCreateSwapchain(void)
 		return FR_ERROR_UNKNOWN;
 	}
 
-	uint32_t presentModeIndex;
-	uint32_t fifoIndex = presentModeCount;
-	for(presentModeIndex = 0; presentModeIndex < presentModeCount; ++presentModeIndex)
+	VkPresentModeKHR wantedPresentMode;
+	switch(presentModePreference)
 	{
-		if(presentModes[presentModeIndex] == VK_PRESENT_MODE_FIFO_KHR)
-		{
-			fifoIndex = presentModeIndex;
-			continue;
-		}
-
-		if(presentModes[presentModeIndex] == VK_PRESENT_MODE_MAILBOX_KHR)
-		{
+		case FR_PRESENT_MODE_FIFO:
+			wantedPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+			break;
+		case FR_PRESENT_MODE_FIFO_RELAXED:
+			wantedPresentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+			break;
+		case FR_PRESENT_MODE_IMMEDIATE:
+			wantedPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			break;
+		case FR_PRESENT_MODE_DEFAULT:
+		case FR_PRESENT_MODE_MAILBOX:
+		default:
+			wantedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
 			break;
-		}
 	}
-	if(presentModeIndex == presentModeCount)
+
+	// FIFO support is required by the specification
+	swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+	for(uint32_t presentModeIndex = 0; presentModeIndex < presentModeCount; ++presentModeIndex)
 	{
-		if(fifoIndex < presentModeCount)
-		{
-			presentModeIndex = fifoIndex;
-		}
-		else
+		if(presentModes[presentModeIndex] == wantedPresentMode)
 		{
-			presentModeIndex = 0;
+			swapchainPresentMode = wantedPresentMode;
+			break;
 		}
 	}
 
@@ -1052,7 +1486,7 @@ static FrResult frCreateSwapchain(void)
 		.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
 		.preTransform = surfaceCapabilities.currentTransform,
 		.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-		.presentMode = presentModes[presentModeIndex],
+		.presentMode = swapchainPresentMode,
 		.clipped = VK_TRUE,
 		.oldSwapchain = swapchain
 	};
@@ -1176,25 +1610,34 @@ static FrResult frCreateSwapchain(void)
 
 static FrResult frCreateRenderPass(void)
 {
-	const VkAttachmentDescription attachments[] = {
+	// The scene is either presented directly or sampled by the post-process pass
+	const VkImageLayout targetLayout = postProcess.enabled ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	const bool multisampled = msaaSamples != VK_SAMPLE_COUNT_1_BIT;
+
+	// With occlusion culling, the early render pass already drew part of the scene, which is loaded
+	const bool occlusion = frIsOcclusionCullingActive();
+
+	// Without multisampling the scene is rendered to the target directly and there is nothing to resolve
+	// The multisampled color and the depth are never stored, so they can live in transient, lazily allocated images
+	VkAttachmentDescription attachments[] = {
 		{
 			.format = swapchainFormat,
 			.samples = msaaSamples,
-			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-			.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.loadOp = occlusion ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE,
 			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-			.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+			.initialLayout = occlusion ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+			.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : targetLayout
 		},
 		{
 			.format = VK_FORMAT_D24_UNORM_S8_UINT,
 			.samples = msaaSamples,
-			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.loadOp = occlusion ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
 			.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.initialLayout = occlusion ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
 			.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
 		},
 		{
@@ -1205,7 +1648,7 @@ static FrResult frCreateRenderPass(void)
 			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-			.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+			.finalLayout = targetLayout
 		}
 	};
 
@@ -1225,27 +1668,40 @@ static FrResult frCreateRenderPass(void)
 		.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
 		.colorAttachmentCount = 1,
 		.pColorAttachments = &colorAttachmentReference,
-		.pResolveAttachments = &resolveAttachmentReference,
+		.pResolveAttachments = multisampled ? &resolveAttachmentReference : NULL,
 		.pDepthStencilAttachment = &depthAttachmentReference
 	};
 
-	const VkSubpassDependency dependency = {
-		.srcSubpass = VK_SUBPASS_EXTERNAL,
-		.dstSubpass = 0,
-		.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-		.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-		.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-		.dstAccessMask =  VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+	VkSubpassDependency dependencies[] = {
+		{
+			.srcSubpass = VK_SUBPASS_EXTERNAL,
+			.dstSubpass = 0,
+			// The fragment shader stage covers the previous frame's post-process reads of the target
+			// and the compute stage the depth pyramid reads of the depth
+			.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+			.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask =  VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+		},
+		{
+			// Make the scene visible to the post-process pass
+			.srcSubpass = 0,
+			.dstSubpass = VK_SUBPASS_EXTERNAL,
+			.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT
+		}
 	};
 
 	const VkRenderPassCreateInfo createInfo = {
 		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-		.attachmentCount = FR_LEN(attachments),
+		.attachmentCount = multisampled ? 3 : 2,
 		.pAttachments = attachments,
 		.subpassCount = 1,
 		.pSubpasses = &subpass,
-		.dependencyCount = 1,
-		.pDependencies = &dependency
+		.dependencyCount = postProcess.enabled ? 2 : 1,
+		.pDependencies = dependencies
 	};
 
 	if(vkCreateRenderPass(device, &createInfo, NULL, &renderPass) != VK_SUCCESS)
@@ -1253,6 +1709,42 @@ static FrResult frCreateRenderPass(void)
 		return FR_ERROR_UNKNOWN;
 	}
 
+	// The early render pass clears and keeps the color and depth, the depth pyramid is then built from the latter
+	earlyRenderPass = VK_NULL_HANDLE;
+	if(occlusion)
+	{
+		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		dependencies[1] = (VkSubpassDependency){
+			.srcSubpass = 0,
+			.dstSubpass = VK_SUBPASS_EXTERNAL,
+			.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT
+		};
+		const VkRenderPassCreateInfo earlyCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.attachmentCount = 2,
+			.pAttachments = attachments,
+			.subpassCount = 1,
+			.pSubpasses = &subpass,
+			.dependencyCount = FR_LEN(dependencies),
+			.pDependencies = dependencies
+		};
+		if(vkCreateRenderPass(device, &earlyCreateInfo, NULL, &earlyRenderPass) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
 	#ifndef NDEBUG
 	if(debugExtensionAvailable)
 	{
@@ -1284,15 +1776,18 @@ static FrResult frCreateFramebuffers(void)
 
 	for(uint32_t imageIndex = 0; imageIndex < swapchainImageCount; ++imageIndex)
 	{
+		// Must match the attachments of frCreateRenderPass
+		const VkImageView targetView = postProcess.enabled ? postProcess.imageView : swapchainImageViews[imageIndex];
+		const bool multisampled = msaaSamples != VK_SAMPLE_COUNT_1_BIT;
 		const VkImageView attachments[] = {
-			colorImageView,
+			multisampled ? colorImageView : targetView,
 			depthImageView,
-			swapchainImageViews[imageIndex]
+			targetView
 		};
 		const VkFramebufferCreateInfo framebufferInfo = {
 			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
 			.renderPass = renderPass,
-			.attachmentCount = FR_LEN(attachments),
+			.attachmentCount = multisampled ? 3 : 2,
 			.pAttachments = attachments,
 			.width = swapchainExtent.width,
 			.height = swapchainExtent.height,
@@ -1334,94 +1829,284 @@ static FrResult frCreateFramebuffers(void)
 	}
 	#endif
 
+	if(!postProcess.enabled)
+	{
+		return FR_SUCCESS;
+	}
+
+	VkFramebuffer* const newPostProcessFramebuffers = realloc(postProcess.framebuffers, swapchainImageCount * sizeof(newPostProcessFramebuffers[0]));
+	if(!newPostProcessFramebuffers)
+	{
+		free(postProcess.framebuffers);
+		postProcess.framebuffers = NULL;
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	postProcess.framebuffers = newPostProcessFramebuffers;
+
+	for(uint32_t imageIndex = 0; imageIndex < swapchainImageCount; ++imageIndex)
+	{
+		const VkFramebufferCreateInfo framebufferInfo = {
+			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+			.renderPass = postProcess.renderPass,
+			.attachmentCount = 1,
+			.pAttachments = &swapchainImageViews[imageIndex],
+			.width = swapchainExtent.width,
+			.height = swapchainExtent.height,
+			.layers = 1
+		};
+		if(vkCreateFramebuffer(device, &framebufferInfo, NULL, &postProcess.framebuffers[imageIndex]) != VK_SUCCESS)
+		{
+			for(uint32_t j = 0; j < imageIndex; ++j)
+			{
+				vkDestroyFramebuffer(device, postProcess.framebuffers[j], NULL);
+			}
+
+			free(postProcess.framebuffers);
+			postProcess.framebuffers = NULL;
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
 	return FR_SUCCESS;
 }
 
-static FrResult frCreateShaderModule(const char* path, VkShaderModule* pShaderModule, FrShaderInfo* pInfo)
+/*
+ * Read a pipeline cache file written by frSavePipelineCache.
+ *
+ * Parameters:
+ * - path: The path of the file.
+ * - pDataSize: A pointer to the size of the cache data.
+ *
+ * Returns:
+ * - The cache data, to be freed, if the file exists and matches the device and driver.
+ * - NULL otherwise.
+ */
+static void* frReadPipelineCacheFile(const char* path, size_t* pDataSize)
 {
-	// Prepare create info
-	VkShaderModuleCreateInfo createInfo = {
-		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO
-	};
-
-	// Open file
 	FILE* const file = fopen(path, "rb");
 	if(!file)
 	{
-		return FR_ERROR_FILE_NOT_FOUND;
+		return NULL;
 	}
-	
-	// Get file size
-	fseek(file, 0, SEEK_END);
-	createInfo.codeSize = ftell(file);
-	if(createInfo.codeSize == (size_t)-1L)
+
+	FrPipelineCacheHeader header;
+	if(fread(&header, sizeof(header), 1, file) != 1)
 	{
 		fclose(file);
-		return FR_ERROR_UNKNOWN;
+		return NULL;
 	}
 
-	// SPIR-V code must contain 32-bit words
-	if(createInfo.codeSize % sizeof(createInfo.pCode[0]) != 0)
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if(
+		header.magic != FR_PIPELINE_CACHE_MAGIC ||
+		header.vendorID != properties.vendorID ||
+		header.deviceID != properties.deviceID ||
+		header.driverVersion != properties.driverVersion ||
+		memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0 ||
+		header.dataSize < sizeof(VkPipelineCacheHeaderVersionOne)
+	)
 	{
 		fclose(file);
-		return FR_ERROR_CORRUPTED_FILE;
+		return NULL;
 	}
 
-	// Allocate memory for SPIR-V code
-	uint32_t* const code = malloc(createInfo.codeSize);
-	if(!code)
+	void* const data = malloc(header.dataSize);
+	if(!data || fread(data, 1, header.dataSize, file) != header.dataSize)
 	{
+		free(data);
 		fclose(file);
-		return FR_ERROR_OUT_OF_HOST_MEMORY;
+		return NULL;
 	}
+	fclose(file);
 
-	// Read SPIR-V code
-	fseek(file, 0, SEEK_SET);
-	if(fread(code, sizeof(code[0]), createInfo.codeSize / sizeof(code[0]), file) != createInfo.codeSize / sizeof(code[0]))
+	// The data starts with the header of the driver, checked too in case the file was only partly overwritten
+	VkPipelineCacheHeaderVersionOne dataHeader;
+	memcpy(&dataHeader, data, sizeof(dataHeader));
+	if(
+		dataHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+		dataHeader.vendorID != properties.vendorID ||
+		dataHeader.deviceID != properties.deviceID ||
+		memcmp(dataHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0
+	)
 	{
-		free(code);
-		fclose(file);
-		return FR_ERROR_UNKNOWN;
+		free(data);
+		return NULL;
 	}
-	createInfo.pCode = code;
 
-	// Close file
-	fclose(file);
+	*pDataSize = header.dataSize;
+	return data;
+}
 
-	if(code[0] != SpvMagicNumber)
+/*
+ * Create the pipeline cache, seeded with the data saved by a previous launch when there is some.
+ *
+ * Parameters:
+ * - path: The file of the cache, or NULL.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frCreatePipelineCache(const char* path)
+{
+	pipelineCache = (FrPipelineCache){0};
+	if(path)
 	{
-		for(uint32_t i = 0; i < createInfo.codeSize / sizeof(code[0]); ++i)
+		const size_t pathSize = strlen(path) + 1;
+		pipelineCache.path = malloc(pathSize);
+		if(!pipelineCache.path)
 		{
-			code[i] = FR_SWAP_BYTES_U32(code[i]);
-		}
-
-		if(code[0] != SpvMagicNumber)
-		{
-			free(code);
-			return FR_ERROR_CORRUPTED_FILE;
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
 		}
+		memcpy(pipelineCache.path, path, pathSize);
 	}
-	
-	// Create shader module
-	if(vkCreateShaderModule(device, &createInfo, NULL, pShaderModule) != VK_SUCCESS)
+
+	// A missing, stale or corrupted file starts an empty cache
+	size_t dataSize = 0;
+	void* const data = path ? frReadPipelineCacheFile(path, &dataSize) : NULL;
+
+	const VkPipelineCacheCreateInfo createInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.initialDataSize = dataSize,
+		.pInitialData = data
+	};
+	const VkResult result = vkCreatePipelineCache(device, &createInfo, NULL, &pipelineCache.cache);
+	free(data);
+	if(result != VK_SUCCESS)
 	{
-		free(code);
 		return FR_ERROR_UNKNOWN;
 	}
 
-	if(frParseSpirv(code, createInfo.codeSize / sizeof(code[0]), pInfo) != FR_SUCCESS)
+	#ifndef NDEBUG
+	if(debugExtensionAvailable)
 	{
-		free(code);
-		return FR_ERROR_UNKNOWN;
+		const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.objectType = VK_OBJECT_TYPE_PIPELINE_CACHE,
+			.objectHandle = (uint64_t)pipelineCache.cache,
+			.pObjectName = "Fraus pipeline cache"
+		};
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
 	}
-
-	// Free SPIR-V code
-	free(code);
+	#endif
 
 	return FR_SUCCESS;
 }
 
-static int frComparePushConstants(const void* pAV, const void* pBV)
+/*
+ * Write the pipeline cache to its file, if it has one.
+ */
+static void frSavePipelineCache(void)
+{
+	if(!pipelineCache.path || pipelineCache.cache == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	size_t dataSize;
+	if(vkGetPipelineCacheData(device, pipelineCache.cache, &dataSize, NULL) != VK_SUCCESS || dataSize > UINT32_MAX)
+	{
+		return;
+	}
+	void* const data = malloc(dataSize);
+	if(!data)
+	{
+		return;
+	}
+	if(vkGetPipelineCacheData(device, pipelineCache.cache, &dataSize, data) != VK_SUCCESS)
+	{
+		free(data);
+		return;
+	}
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	FrPipelineCacheHeader header = {
+		.magic = FR_PIPELINE_CACHE_MAGIC,
+		.dataSize = (uint32_t)dataSize,
+		.vendorID = properties.vendorID,
+		.deviceID = properties.deviceID,
+		.driverVersion = properties.driverVersion
+	};
+	memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+	// A failed write keeps the previous file
+	FrFileWriter writer;
+	if(frOpenFileWriter(pipelineCache.path, &writer) == FR_SUCCESS)
+	{
+		frWriteFileData(&writer, &header, sizeof(header));
+		frWriteFileData(&writer, data, dataSize);
+		frCloseFileWriter(&writer);
+	}
+	free(data);
+}
+
+/*
+ * Get the current time.
+ *
+ * Returns:
+ * - The time in seconds, 0 if it is unavailable.
+ */
+static double frGetTime(void)
+{
+	struct timespec time;
+	if(timespec_get(&time, TIME_UTC) != TIME_UTC)
+	{
+		return 0.;
+	}
+
+	return (double)time.tv_sec + time.tv_nsec / 1000000000.;
+}
+
+/*
+ * Create a graphics pipeline through the pipeline cache, timing it.
+ *
+ * Parameters:
+ * - pCreateInfo: The create info.
+ * - pPipeline: A pointer to the created pipeline.
+ *
+ * Returns:
+ * - The result of vkCreateGraphicsPipelines.
+ */
+static VkResult frCompileGraphicsPipeline(const VkGraphicsPipelineCreateInfo* pCreateInfo, VkPipeline* pPipeline)
+{
+	const double start = frGetTime();
+	const VkResult result = vkCreateGraphicsPipelines(device, pipelineCache.cache, 1, pCreateInfo, NULL, pPipeline);
+	frAtomicAdd(&pipelineCache.creationTime, (uint32_t)((frGetTime() - start) * 1e6));
+
+	return result;
+}
+
+/*
+ * Create a compute pipeline through the pipeline cache, timing it.
+ *
+ * Parameters:
+ * - pCreateInfo: The create info.
+ * - pPipeline: A pointer to the created pipeline.
+ *
+ * Returns:
+ * - The result of vkCreateComputePipelines.
+ */
+static VkResult frCompileComputePipeline(const VkComputePipelineCreateInfo* pCreateInfo, VkPipeline* pPipeline)
+{
+	const double start = frGetTime();
+	const VkResult result = vkCreateComputePipelines(device, pipelineCache.cache, 1, pCreateInfo, NULL, pPipeline);
+	frAtomicAdd(&pipelineCache.creationTime, (uint32_t)((frGetTime() - start) * 1e6));
+
+	return result;
+}
+
+float frGetPipelineCreationTime(void)
+{
+	return (float)frAtomicLoad(&pipelineCache.creationTime) * 1e-6f;
+}
+
+static int frComparePushConstants(const void* pAV, const void* pBV)
 {
 	const VkPushConstantRange* pA = pAV;
 	const VkPushConstantRange* pB = pBV;
@@ -1437,22 +2122,164 @@ static int frComparePushConstants(const void* pAV, const void* pBV)
 	return 0;
 }
 
-FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
+/*
+ * Check the create info of a graphics pipeline.
+ *
+ * Parameters:
+ * - pCreateInfo: The create info.
+ *
+ * Returns:
+ * - true if the create info is valid.
+ * - false otherwise.
+ */
+static bool frIsPipelineCreateInfoValid(const FrPipelineCreateInfo* pCreateInfo)
+{
+	if(
+		!pCreateInfo || !pCreateInfo->vertexShaderPath || !pCreateInfo->fragmentShaderPath ||
+		(pCreateInfo->vertexInputRateCount && (!pCreateInfo->vertexInputRates || !pCreateInfo->vertexInputStrides)) ||
+		(pCreateInfo->instanceTransforms && pCreateInfo->vertexInputRateCount) ||
+		(pCreateInfo->specializationConstantCount && !pCreateInfo->specializationConstants) ||
+		(pCreateInfo->bindless && !bindless.available) ||
+		(!pCreateInfo->bindless && pCreateInfo->bindlessIndexCount) ||
+		pCreateInfo->bindlessIndexCount > FR_BINDLESS_MAX_INDEXES ||
+		(pCreateInfo->bindlessIndexCount && !pCreateInfo->bindlessIndexTypes)
+	)
+	{
+		return false;
+	}
+
+	// Only the resource types of the bindless set can be indexed
+	for(uint32_t i = 0; i < pCreateInfo->bindlessIndexCount; ++i)
+	{
+		if(
+			pCreateInfo->bindlessIndexTypes[i] != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER &&
+			pCreateInfo->bindlessIndexTypes[i] != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER &&
+			pCreateInfo->bindlessIndexTypes[i] != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+		)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Lay out the specialization constants of a graphics pipeline for the stages declaring them.
+ *
+ * Parameters:
+ * - pCreateInfo: The create info.
+ * - pVertexInfo: The reflection of the vertex shader.
+ * - pFragmentInfo: The reflection of the fragment shader.
+ * - pPipeline: The pipeline, whose specialization is set.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if a constant is given twice or declared by neither shader.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+static FrResult frSpecializeGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo, const FrShaderInfo* pVertexInfo, const FrShaderInfo* pFragmentInfo, FrPipeline* pPipeline)
 {
-	if(!pCreateInfo || !pCreateInfo->vertexShaderPath || !pCreateInfo->fragmentShaderPath || (pCreateInfo->vertexInputRateCount && (!pCreateInfo->vertexInputRates || !pCreateInfo->vertexInputStrides)))
+	const uint32_t constantCount = pCreateInfo->specializationConstantCount;
+	if(!constantCount)
 	{
-		return FR_ERROR_INVALID_ARGUMENT;
+		return FR_SUCCESS;
 	}
 
-	if(frPushBackPipelineVector(&graphicsPipelines, (FrPipeline){0}) != FR_SUCCESS)
+	// A stage cannot have two map entries for the same constant
+	for(uint32_t constantIndex = 1; constantIndex < constantCount; ++constantIndex)
 	{
-		return FR_ERROR_UNKNOWN;
+		for(uint32_t previousIndex = 0; previousIndex < constantIndex; ++previousIndex)
+		{
+			if(pCreateInfo->specializationConstants[previousIndex].id == pCreateInfo->specializationConstants[constantIndex].id)
+			{
+				return FR_ERROR_INVALID_ARGUMENT;
+			}
+		}
+	}
+
+	// Each value takes a slot large enough for any type, of which the stages read the size they declare
+	const size_t slotSize = sizeof(pCreateInfo->specializationConstants[0].uint64Value);
+	pPipeline->specializationData = malloc(constantCount * slotSize);
+	pPipeline->specializationEntries = malloc(2 * constantCount * sizeof(pPipeline->specializationEntries[0]));
+	if(!pPipeline->specializationData || !pPipeline->specializationEntries)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	const FrShaderInfo* const stageInfos[] = {pVertexInfo, pFragmentInfo};
+	VkSpecializationInfo* const specializations[] = {&pPipeline->vertexSpecialization, &pPipeline->fragmentSpecialization};
+	for(uint32_t stageIndex = 0; stageIndex < FR_LEN(specializations); ++stageIndex)
+	{
+		*specializations[stageIndex] = (VkSpecializationInfo){
+			.mapEntryCount = 0,
+			.pMapEntries = pPipeline->specializationEntries + stageIndex * constantCount,
+			.dataSize = constantCount * slotSize,
+			.pData = pPipeline->specializationData
+		};
+	}
+
+	for(uint32_t constantIndex = 0; constantIndex < constantCount; ++constantIndex)
+	{
+		const FrSpecializationConstant* const pConstant = &pCreateInfo->specializationConstants[constantIndex];
+		memcpy((char*)pPipeline->specializationData + constantIndex * slotSize, &pConstant->uint64Value, slotSize);
+
+		bool declared = false;
+		for(uint32_t stageIndex = 0; stageIndex < FR_LEN(stageInfos); ++stageIndex)
+		{
+			for(uint32_t i = 0; i < stageInfos[stageIndex]->specializationConstantCount; ++i)
+			{
+				if(stageInfos[stageIndex]->specializationConstants[i].id != pConstant->id)
+				{
+					continue;
+				}
+
+				VkSpecializationMapEntry* const pEntries = (VkSpecializationMapEntry*)specializations[stageIndex]->pMapEntries;
+				pEntries[specializations[stageIndex]->mapEntryCount++] = (VkSpecializationMapEntry){
+					.constantID = pConstant->id,
+					.offset = (uint32_t)(constantIndex * slotSize),
+					.size = stageInfos[stageIndex]->specializationConstants[i].size
+				};
+				declared = true;
+				break;
+			}
+		}
+		if(!declared)
+		{
+			return FR_ERROR_INVALID_ARGUMENT;
+		}
 	}
 
+	return FR_SUCCESS;
+}
+
+/*
+ * Get the shaders of a graphics pipeline from the shader cache, then create its layouts.
+ * Only touches the given pipeline, so it can run on any thread.
+ *
+ * Parameters:
+ * - pCreateInfo: The create info, already checked.
+ * - pPipeline: The pipeline, zero initialized. On failure, it keeps what was created.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if the vertex input does not match the vertex shader.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frLoadGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo, FrPipeline* pPipeline)
+{
+	// Mesh vertices, then the model matrix of each instance
+	const VkVertexInputRate instanceTransformsRates[] = {VK_VERTEX_INPUT_RATE_VERTEX, VK_VERTEX_INPUT_RATE_INSTANCE};
+	const uint32_t instanceTransformsStrides[] = {sizeof(FrVertex), FR_INSTANCE_TRANSFORM_SIZE};
+	const uint32_t vertexInputRateCount = pCreateInfo->instanceTransforms ? FR_LEN(instanceTransformsRates) : pCreateInfo->vertexInputRateCount;
+	const VkVertexInputRate* const vertexInputRates = pCreateInfo->instanceTransforms ? instanceTransformsRates : pCreateInfo->vertexInputRates;
+	const uint32_t* const vertexInputStrides = pCreateInfo->instanceTransforms ? instanceTransformsStrides : pCreateInfo->vertexInputStrides;
+
 	// Shader stages
 	FrShaderInfo vertexInfo;
 	VkShaderModule vertexModule;
-	if(frCreateShaderModule(pCreateInfo->vertexShaderPath, &vertexModule, &vertexInfo) != FR_SUCCESS)
+	if(frGetShader(pCreateInfo->vertexShaderPath, &vertexModule, &vertexInfo) != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
@@ -1467,7 +2294,7 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 
 	FrShaderInfo fragmentInfo;
 	VkShaderModule fragmentModule;
-	if(frCreateShaderModule(pCreateInfo->fragmentShaderPath, &fragmentModule, &fragmentInfo) != FR_SUCCESS)
+	if(frGetShader(pCreateInfo->fragmentShaderPath, &fragmentModule, &fragmentInfo) != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
@@ -1480,6 +2307,22 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 		fragmentInfo.pushConstants[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 	}
 
+	const FrResult specializationResult = frSpecializeGraphicsPipeline(pCreateInfo, &vertexInfo, &fragmentInfo, pPipeline);
+	free(vertexInfo.specializationConstants);
+	free(fragmentInfo.specializationConstants);
+	if(specializationResult != FR_SUCCESS)
+	{
+		free(vertexInfo.inputs);
+		free(fragmentInfo.inputs);
+		free(vertexInfo.outputs);
+		free(fragmentInfo.outputs);
+		free(vertexInfo.bindings);
+		free(fragmentInfo.bindings);
+		free(vertexInfo.pushConstants);
+		free(fragmentInfo.pushConstants);
+		return specializationResult;
+	}
+
 	if(vertexInfo.outputCount != fragmentInfo.inputCount)
 	{
 		free(vertexInfo.inputs);
@@ -1518,8 +2361,34 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 	}
 	frMergeSorted(vertexInfo.bindingCount, vertexInfo.bindings, fragmentInfo.bindingCount, fragmentInfo.bindings, bindings, sizeof(bindings[0]), frCompareBindings);
 
+	// Bindless shaders declare the arrays of the bindless set, the others a single descriptor per binding
+	const VkDescriptorType bindlessTypes[] = {
+		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+	};
+	for(uint32_t i = 0; i < bindingCount; ++i)
+	{
+		const bool valid = pCreateInfo->bindless ?
+			bindings[i].binding < FR_LEN(bindlessTypes) && bindings[i].descriptorType == bindlessTypes[bindings[i].binding] :
+			bindings[i].descriptorCount == 1;
+		if(!valid)
+		{
+			free(bindings);
+			free(vertexInfo.inputs);
+			free(fragmentInfo.inputs);
+			free(vertexInfo.outputs);
+			free(fragmentInfo.outputs);
+			free(vertexInfo.bindings);
+			free(fragmentInfo.bindings);
+			free(vertexInfo.pushConstants);
+			free(fragmentInfo.pushConstants);
+			return FR_ERROR_INVALID_ARGUMENT;
+		}
+	}
+
 	const uint32_t pushConstantCount = vertexInfo.pushConstantCount + fragmentInfo.pushConstantCount;
-	graphicsPipelines.data[graphicsPipelines.size - 1].hasPushConstants = pushConstantCount > 0;
+	pPipeline->hasPushConstants = pushConstantCount > 0 || pCreateInfo->bindless;
 	VkPushConstantRange* pushConstants = NULL;
 	if(pushConstantCount)
 	{
@@ -1542,48 +2411,6 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 	free(vertexInfo.pushConstants);
 	free(fragmentInfo.pushConstants);
 
-	#ifndef NDEBUG
-	if(debugExtensionAvailable)
-	{
-		char name[32];
-
-		snprintf(name, sizeof(name), "Fraus vertex shader module %zu", graphicsPipelines.size - 1);
-		VkDebugUtilsObjectNameInfoEXT nameInfo = {
-			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-			.objectType = VK_OBJECT_TYPE_SHADER_MODULE,
-			.objectHandle = (uint64_t)vertexModule,
-			.pObjectName = name
-		};
-		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
-		{
-			return FR_ERROR_UNKNOWN;
-		}
-
-		snprintf(name, sizeof(name), "Fraus fragment shader module %zu", graphicsPipelines.size - 1);
-		nameInfo.objectHandle = (uint64_t)fragmentModule;
-		nameInfo.pObjectName = name;
-		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
-		{
-			return FR_ERROR_UNKNOWN;
-		}
-	}
-	#endif
-
-	const VkPipelineShaderStageCreateInfo stageInfos[] = {
-		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			.stage = VK_SHADER_STAGE_VERTEX_BIT,
-			.module = vertexModule,
-			.pName = "main",
-		},
-		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-			.module = fragmentModule,
-			.pName = "main",
-		}
-	};
-
 	// Vertex input
 	VkVertexInputAttributeDescription* const attributes = malloc(vertexInfo.inputCount * sizeof(attributes[0]));
 	if(!attributes)
@@ -1606,11 +2433,11 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 		offset += vertexInfo.inputs[i].size;
 		total += vertexInfo.inputs[i].size;
 
-		if(pCreateInfo->vertexInputRateCount && pCreateInfo->vertexInputStrides[bindingI] < offset)
+		if(vertexInputRateCount && vertexInputStrides[bindingI] < offset)
 		{
 			return FR_ERROR_INVALID_ARGUMENT;
 		}
-		if(pCreateInfo->vertexInputRateCount && pCreateInfo->vertexInputStrides[bindingI] == offset)
+		if(vertexInputRateCount && vertexInputStrides[bindingI] == offset)
 		{
 			++bindingI;
 			offset = 0;
@@ -1625,9 +2452,9 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 	};
 	uint32_t inputBindingCount;
 	VkVertexInputBindingDescription* inputBindings;
-	if(pCreateInfo->vertexInputRateCount)
+	if(vertexInputRateCount)
 	{
-		inputBindingCount = pCreateInfo->vertexInputRateCount;
+		inputBindingCount = vertexInputRateCount;
 		inputBindings = malloc(inputBindingCount * sizeof(inputBindings[0]));
 		if(!inputBindings)
 		{
@@ -1638,11 +2465,11 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 		}
 
 		uint32_t s = 0;
-		for(uint32_t i = 0; i < inputBindingCount; s += pCreateInfo->vertexInputStrides[i], ++i)
+		for(uint32_t i = 0; i < inputBindingCount; s += vertexInputStrides[i], ++i)
 		{
 			inputBindings[i].binding = i;
-			inputBindings[i].stride = pCreateInfo->vertexInputStrides[i];
-			inputBindings[i].inputRate = pCreateInfo->vertexInputRates[i];
+			inputBindings[i].stride = vertexInputStrides[i];
+			inputBindings[i].inputRate = vertexInputRates[i];
 		}
 
 		if(total != s)
@@ -1657,66 +2484,420 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 	else
 	{
 		inputBindingCount = 1;
-		inputBindings = &binding;
+		inputBindings = malloc(sizeof(inputBindings[0]));
+		if(!inputBindings)
+		{
+			free(bindings);
+			free(attributes);
+			free(pushConstants);
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		inputBindings[0] = binding;
+	}
+
+	// Keep what is needed to rebuild the pipeline
+	pPipeline->vertexModule = vertexModule;
+	pPipeline->fragmentModule = fragmentModule;
+	pPipeline->vertexBindingCount = inputBindingCount;
+	pPipeline->vertexBindings = inputBindings;
+	pPipeline->vertexAttributeCount = vertexInfo.inputCount;
+	pPipeline->vertexAttributes = attributes;
+	pPipeline->depthTestDisable = pCreateInfo->depthTestDisable;
+	pPipeline->alphaBlendEnable = pCreateInfo->alphaBlendEnable;
+	pPipeline->instanceTransforms = pCreateInfo->instanceTransforms;
+	pPipeline->bindless = pCreateInfo->bindless;
+
+	// The objects of bindless pipelines give the indexes of their resources instead of descriptors
+	pPipeline->descriptorTypeCount = pCreateInfo->bindless ? pCreateInfo->bindlessIndexCount : bindingCount;
+	pPipeline->descriptorTypes = malloc(pPipeline->descriptorTypeCount * sizeof(pPipeline->descriptorTypes[0]));
+	if(!pPipeline->descriptorTypes)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	for(uint32_t i = 0; i < pPipeline->descriptorTypeCount; ++i)
+	{
+		pPipeline->descriptorTypes[i] = pCreateInfo->bindless ? pCreateInfo->bindlessIndexTypes[i] : bindings[i].descriptorType;
 	}
 
-	const VkPipelineVertexInputStateCreateInfo vertexInput = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-		.vertexBindingDescriptionCount = inputBindingCount,
-		.pVertexBindingDescriptions = inputBindings,
-		.vertexAttributeDescriptionCount = vertexInfo.inputCount,
-		.pVertexAttributeDescriptions = attributes
-	};
-
-	// Input assembly
-	const VkPipelineInputAssemblyStateCreateInfo inputAssembly = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-		.primitiveRestartEnable = VK_FALSE
-	};
+	if(!pCreateInfo->bindless)
+	{
+		const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.bindingCount = bindingCount,
+			.pBindings = bindings
+		};
+		if(vkCreateDescriptorSetLayout(
+			device,
+			&descriptorSetLayoutInfo,
+			NULL,
+			&pPipeline->descriptorSetLayout
+		) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	free(bindings);
 
-	// Viewport
-	const VkPipelineViewportStateCreateInfo viewport = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-		.viewportCount = 1,
-		.scissorCount = 1
+	// Bindless pipelines share one range, with the resource indexes after the model matrix
+	VkPushConstantRange bindlessPushConstants = {
+		.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+		.offset = 0,
+		.size = FR_BINDLESS_INDEXES_OFFSET + pCreateInfo->bindlessIndexCount * sizeof(uint32_t)
 	};
+	for(uint32_t i = 0; pCreateInfo->bindless && i < pushConstantCount; ++i)
+	{
+		const uint32_t end = pushConstants[i].offset + pushConstants[i].size;
+		bindlessPushConstants.size = end > bindlessPushConstants.size ? end : bindlessPushConstants.size;
+	}
 
-	// Rasterization
-	const VkPipelineRasterizationStateCreateInfo rasterization = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-		.depthClampEnable = VK_FALSE,
-		.rasterizerDiscardEnable = VK_FALSE,
-		.polygonMode = VK_POLYGON_MODE_FILL,
-		.cullMode = VK_CULL_MODE_BACK_BIT,
-		.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
-		.depthBiasEnable = VK_FALSE,
-		.lineWidth = 1.f
+	// Layout
+	const VkPipelineLayoutCreateInfo layoutInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 1,
+		.pSetLayouts = pCreateInfo->bindless ? &bindless.descriptorSetLayout : &pPipeline->descriptorSetLayout,
+		.pushConstantRangeCount = pCreateInfo->bindless ? 1 : pushConstantCount,
+		.pPushConstantRanges = pCreateInfo->bindless ? &bindlessPushConstants : pushConstants
 	};
 
-	// Multisample
-	VkPhysicalDeviceFeatures features;
-	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
-	const VkPipelineMultisampleStateCreateInfo multisample = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-		.rasterizationSamples = msaaSamples,
-		.sampleShadingEnable = features.sampleRateShading,
-		.minSampleShading = 1.f
-	};
+	if(vkCreatePipelineLayout(
+		device,
+		&layoutInfo,
+		NULL,
+		&pPipeline->pipelineLayout
+	) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	free(pushConstants);
 
-	// Depth stencil
-	const VkPipelineDepthStencilStateCreateInfo depthStencil = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-		.depthTestEnable = pCreateInfo->depthTestDisable ? VK_FALSE : VK_TRUE,
-		.depthWriteEnable = VK_TRUE,
-		.depthCompareOp = VK_COMPARE_OP_LESS,
-		.depthBoundsTestEnable = VK_FALSE,
-		.stencilTestEnable = VK_FALSE
-	};
+	return FR_SUCCESS;
+}
+
+FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
+{
+	if(!frIsPipelineCreateInfoValid(pCreateInfo))
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	if(frPushBackPipelineVector(&graphicsPipelines, (FrPipeline){0}) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	const uint32_t pipelineIndex = (uint32_t)graphicsPipelines.size - 1;
+
+	FrPipeline pipeline = {0};
+	FrResult result = frLoadGraphicsPipeline(pCreateInfo, &pipeline);
+	if(result == FR_SUCCESS)
+	{
+		result = frBuildGraphicsPipeline(&pipeline, pipelineIndex, &pipeline.pipeline);
+	}
+	graphicsPipelines.data[pipelineIndex] = pipeline;
+
+	return result;
+}
+
+/*
+ * Compile job of a background pipeline build.
+ *
+ * Parameters:
+ * - pBuildVoid: The build.
+ */
+static void frCompilePipelineJob(void* pBuildVoid)
+{
+	FrPipelineBuild* const pBuild = pBuildVoid;
+	frBuildGraphicsPipeline(&pBuild->pipeline, pBuild->pipelineIndex, &pBuild->compiledPipeline);
+}
+
+/*
+ * Load job of a background pipeline build, which queues the compile job once the layouts exist.
+ *
+ * Parameters:
+ * - pBuildVoid: The build.
+ */
+static void frLoadPipelineJob(void* pBuildVoid)
+{
+	FrPipelineBuild* const pBuild = pBuildVoid;
+
+	const FrPipelineCreateInfo createInfo = {
+		.vertexShaderPath = pBuild->vertexShaderPath,
+		.fragmentShaderPath = pBuild->fragmentShaderPath,
+		.vertexInputRateCount = pBuild->vertexInputRateCount,
+		.vertexInputRates = pBuild->vertexInputRates,
+		.vertexInputStrides = pBuild->vertexInputStrides,
+		.depthTestDisable = pBuild->depthTestDisable,
+		.alphaBlendEnable = pBuild->alphaBlendEnable,
+		.instanceTransforms = pBuild->instanceTransforms,
+		.bindless = pBuild->bindless,
+		.bindlessIndexCount = pBuild->bindlessIndexCount,
+		.bindlessIndexTypes = pBuild->bindlessIndexTypes,
+		.specializationConstantCount = pBuild->specializationConstantCount,
+		.specializationConstants = pBuild->specializationConstants
+	};
+	pBuild->loadResult = frLoadGraphicsPipeline(&createInfo, &pBuild->pipeline);
+
+	// Counted before this job completes, so the build never looks finished in between
+	if(pBuild->loadResult == FR_SUCCESS)
+	{
+		const FrJob compileJob = {
+			.function = frCompilePipelineJob,
+			.pData = pBuild
+		};
+		frRunJobs(1, &compileJob, &pBuild->compileCounter);
+	}
+}
+
+FrResult frCreateGraphicsPipelineAsync(const FrPipelineCreateInfo* pCreateInfo, uint32_t* pPipelineIndex)
+{
+	if(!frIsPipelineCreateInfoValid(pCreateInfo) || !pPipelineIndex)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	// The create info arrays and paths are copied after the build, in the same allocation
+	const size_t constantsOffset = (sizeof(FrPipelineBuild) + alignof(FrSpecializationConstant) - 1) / alignof(FrSpecializationConstant) * alignof(FrSpecializationConstant);
+	const size_t constantsSize = pCreateInfo->specializationConstantCount * sizeof(pCreateInfo->specializationConstants[0]);
+	const size_t ratesSize = pCreateInfo->vertexInputRateCount * sizeof(pCreateInfo->vertexInputRates[0]);
+	const size_t bindlessTypesSize = pCreateInfo->bindlessIndexCount * sizeof(pCreateInfo->bindlessIndexTypes[0]);
+	const size_t stridesSize = pCreateInfo->vertexInputRateCount * sizeof(pCreateInfo->vertexInputStrides[0]);
+	const size_t vertexPathSize = strlen(pCreateInfo->vertexShaderPath) + 1;
+	const size_t fragmentPathSize = strlen(pCreateInfo->fragmentShaderPath) + 1;
+	FrPipelineBuild* const pBuild = malloc(constantsOffset + constantsSize + ratesSize + bindlessTypesSize + stridesSize + vertexPathSize + fragmentPathSize);
+	if(!pBuild)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	*pBuild = (FrPipelineBuild){
+		.vertexInputRateCount = pCreateInfo->vertexInputRateCount,
+		.depthTestDisable = pCreateInfo->depthTestDisable,
+		.alphaBlendEnable = pCreateInfo->alphaBlendEnable,
+		.instanceTransforms = pCreateInfo->instanceTransforms,
+		.bindless = pCreateInfo->bindless,
+		.specializationConstantCount = pCreateInfo->specializationConstantCount,
+		.bindlessIndexCount = pCreateInfo->bindlessIndexCount,
+		.pipelineIndex = (uint32_t)graphicsPipelines.size
+	};
+	pBuild->specializationConstants = (FrSpecializationConstant*)((char*)pBuild + constantsOffset);
+	pBuild->vertexInputRates = (VkVertexInputRate*)((char*)pBuild->specializationConstants + constantsSize);
+	pBuild->bindlessIndexTypes = (VkDescriptorType*)((char*)pBuild->vertexInputRates + ratesSize);
+	pBuild->vertexInputStrides = (uint32_t*)((char*)pBuild->bindlessIndexTypes + bindlessTypesSize);
+	pBuild->vertexShaderPath = (char*)pBuild->vertexInputStrides + stridesSize;
+	pBuild->fragmentShaderPath = pBuild->vertexShaderPath + vertexPathSize;
+	if(pCreateInfo->vertexInputRateCount)
+	{
+		memcpy(pBuild->vertexInputRates, pCreateInfo->vertexInputRates, ratesSize);
+		memcpy(pBuild->vertexInputStrides, pCreateInfo->vertexInputStrides, stridesSize);
+	}
+	if(pCreateInfo->specializationConstantCount)
+	{
+		memcpy(pBuild->specializationConstants, pCreateInfo->specializationConstants, constantsSize);
+	}
+	if(pCreateInfo->bindlessIndexCount)
+	{
+		memcpy(pBuild->bindlessIndexTypes, pCreateInfo->bindlessIndexTypes, bindlessTypesSize);
+	}
+	memcpy(pBuild->vertexShaderPath, pCreateInfo->vertexShaderPath, vertexPathSize);
+	memcpy(pBuild->fragmentShaderPath, pCreateInfo->fragmentShaderPath, fragmentPathSize);
+
+	if(frPushBackPipelineVector(&graphicsPipelines, (FrPipeline){.pBuild = pBuild}) != FR_SUCCESS)
+	{
+		free(pBuild);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	const FrJob loadJob = {
+		.function = frLoadPipelineJob,
+		.pData = pBuild
+	};
+	frRunJobs(1, &loadJob, &pBuild->loadCounter);
+
+	*pPipelineIndex = pBuild->pipelineIndex;
+
+	return FR_SUCCESS;
+}
+
+bool frIsGraphicsPipelineReady(uint32_t pipelineIndex)
+{
+	return pipelineIndex < graphicsPipelines.size && graphicsPipelines.data[pipelineIndex].pipeline != VK_NULL_HANDLE;
+}
+
+FrResult frWaitGraphicsPipeline(uint32_t pipelineIndex)
+{
+	if(pipelineIndex >= graphicsPipelines.size)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	FrPipelineBuild* const pBuild = graphicsPipelines.data[pipelineIndex].pBuild;
+	if(pBuild)
+	{
+		// The compile job is queued by the load job
+		frFinishJobs(&pBuild->loadCounter);
+		frFinishJobs(&pBuild->compileCounter);
+
+		// A failed build keeps what it created, which is destroyed with the other pipelines
+		graphicsPipelines.data[pipelineIndex] = pBuild->pipeline;
+		graphicsPipelines.data[pipelineIndex].pipeline = pBuild->compiledPipeline;
+		free(pBuild);
+	}
+
+	return graphicsPipelines.data[pipelineIndex].pipeline != VK_NULL_HANDLE ? FR_SUCCESS : FR_ERROR_UNKNOWN;
+}
+
+FrResult frWaitGraphicsPipelineLayout(uint32_t pipelineIndex)
+{
+	if(pipelineIndex >= graphicsPipelines.size)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	FrPipeline* const pPipeline = &graphicsPipelines.data[pipelineIndex];
+	FrPipelineBuild* const pBuild = pPipeline->pBuild;
+	if(!pBuild || pPipeline->pipelineLayout != VK_NULL_HANDLE)
+	{
+		return FR_SUCCESS;
+	}
+
+	frFinishJobs(&pBuild->loadCounter);
+	if(pBuild->loadResult != FR_SUCCESS)
+	{
+		return pBuild->loadResult;
+	}
+
+	// The compile job only reads the loaded pipeline, and writes its handle to the build
+	*pPipeline = pBuild->pipeline;
+	pPipeline->pBuild = pBuild;
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Publish the background pipeline builds that completed, so that their objects are drawn from now on.
+ * Without job threads, the builds only progress here, one job per call so that a frame never waits for all of them.
+ *
+ * Parameters:
+ * - wait: Whether to wait for the other builds too.
+ */
+static void frPublishPipelines(bool wait)
+{
+	bool jobRun = frGetJobThreadCount() > 1;
+	for(uint32_t pipelineIndex = 0; pipelineIndex < graphicsPipelines.size; ++pipelineIndex)
+	{
+		FrPipelineBuild* const pBuild = graphicsPipelines.data[pipelineIndex].pBuild;
+		if(!pBuild)
+		{
+			continue;
+		}
+
+		// The compile job is queued by the load job
+		if(!wait && !jobRun && !frIsJobCounterDone(&pBuild->loadCounter))
+		{
+			frFinishJobs(&pBuild->loadCounter);
+			jobRun = true;
+		}
+		else if(!wait && !jobRun && !frIsJobCounterDone(&pBuild->compileCounter))
+		{
+			frFinishJobs(&pBuild->compileCounter);
+			jobRun = true;
+		}
+
+		if(wait || (frIsJobCounterDone(&pBuild->loadCounter) && frIsJobCounterDone(&pBuild->compileCounter)))
+		{
+			// A failed build is left out of the draws, like one still running
+			frWaitGraphicsPipeline(pipelineIndex);
+		}
+	}
+}
+
+/*
+ * Create the VkPipeline of a graphics pipeline for the current render pass and sample count.
+ * Only reads the given pipeline, so it can run on any thread while the render pass is kept.
+ *
+ * Parameters:
+ * - pPipeline: The pipeline, whose layout, shader modules and vertex input are already set.
+ * - pipelineIndex: The index of the pipeline, used to name it.
+ * - pHandle: A pointer to the created VkPipeline.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frBuildGraphicsPipeline(const FrPipeline* pPipeline, uint32_t pipelineIndex, VkPipeline* pHandle)
+{
+	const VkPipelineShaderStageCreateInfo stageInfos[] = {
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.module = pPipeline->vertexModule,
+			.pName = "main",
+			.pSpecializationInfo = pPipeline->vertexSpecialization.mapEntryCount ? &pPipeline->vertexSpecialization : NULL
+		},
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module = pPipeline->fragmentModule,
+			.pName = "main",
+			.pSpecializationInfo = pPipeline->fragmentSpecialization.mapEntryCount ? &pPipeline->fragmentSpecialization : NULL
+		}
+	};
+
+	const VkPipelineVertexInputStateCreateInfo vertexInput = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		.vertexBindingDescriptionCount = pPipeline->vertexBindingCount,
+		.pVertexBindingDescriptions = pPipeline->vertexBindings,
+		.vertexAttributeDescriptionCount = pPipeline->vertexAttributeCount,
+		.pVertexAttributeDescriptions = pPipeline->vertexAttributes
+	};
+
+	// Input assembly
+	const VkPipelineInputAssemblyStateCreateInfo inputAssembly = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+		.primitiveRestartEnable = VK_FALSE
+	};
+
+	// Viewport
+	const VkPipelineViewportStateCreateInfo viewport = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+		.viewportCount = 1,
+		.scissorCount = 1
+	};
+
+	// Rasterization
+	const VkPipelineRasterizationStateCreateInfo rasterization = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+		.depthClampEnable = VK_FALSE,
+		.rasterizerDiscardEnable = VK_FALSE,
+		.polygonMode = VK_POLYGON_MODE_FILL,
+		.cullMode = VK_CULL_MODE_BACK_BIT,
+		.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+		.depthBiasEnable = VK_FALSE,
+		.lineWidth = 1.f
+	};
+
+	// Multisample
+	VkPhysicalDeviceFeatures features;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+	const VkPipelineMultisampleStateCreateInfo multisample = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+		.rasterizationSamples = msaaSamples,
+		.sampleShadingEnable = features.sampleRateShading,
+		.minSampleShading = 1.f
+	};
+
+	// Depth stencil
+	const VkPipelineDepthStencilStateCreateInfo depthStencil = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+		.depthTestEnable = pPipeline->depthTestDisable ? VK_FALSE : VK_TRUE,
+		.depthWriteEnable = VK_TRUE,
+		.depthCompareOp = VK_COMPARE_OP_LESS,
+		.depthBoundsTestEnable = VK_FALSE,
+		.stencilTestEnable = VK_FALSE
+	};
 
 	// Color blend
 	const VkPipelineColorBlendAttachmentState colorAttachment = {
-		.blendEnable = pCreateInfo->alphaBlendEnable ? VK_TRUE : VK_FALSE,
+		.blendEnable = pPipeline->alphaBlendEnable ? VK_TRUE : VK_FALSE,
 		.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
 		.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
 		.colorBlendOp = VK_BLEND_OP_ADD,
@@ -1742,53 +2923,6 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 		.pDynamicStates = dynamics
 	};
 
-	graphicsPipelines.data[graphicsPipelines.size - 1].descriptorTypeCount = bindingCount;
-	graphicsPipelines.data[graphicsPipelines.size - 1].descriptorTypes = malloc(bindingCount * sizeof(graphicsPipelines.data[graphicsPipelines.size - 1].descriptorTypes[0]));
-	if(!graphicsPipelines.data[graphicsPipelines.size - 1].descriptorTypes)
-	{
-		return FR_ERROR_OUT_OF_HOST_MEMORY;
-	}
-	for(uint32_t i = 0; i < bindingCount; ++i)
-	{
-		graphicsPipelines.data[graphicsPipelines.size - 1].descriptorTypes[i] = bindings[i].descriptorType;
-	}
-
-	const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = {
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-		.bindingCount = bindingCount,
-		.pBindings = bindings
-	};
-	if(vkCreateDescriptorSetLayout(
-		device,
-		&descriptorSetLayoutInfo,
-		NULL,
-		&graphicsPipelines.data[graphicsPipelines.size - 1].descriptorSetLayout
-	) != VK_SUCCESS)
-	{
-		return FR_ERROR_UNKNOWN;
-	}
-	free(bindings);
-
-	// Layout
-	const VkPipelineLayoutCreateInfo layoutInfo = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-		.setLayoutCount = 1,
-		.pSetLayouts = &graphicsPipelines.data[graphicsPipelines.size - 1].descriptorSetLayout,
-		.pushConstantRangeCount = pushConstantCount,
-		.pPushConstantRanges = pushConstants
-	};
-
-	if(vkCreatePipelineLayout(
-		device,
-		&layoutInfo,
-		NULL,
-		&graphicsPipelines.data[graphicsPipelines.size - 1].pipelineLayout
-	) != VK_SUCCESS)
-	{
-		return FR_ERROR_UNKNOWN;
-	}
-	free(pushConstants);
-
 	// Pipeline
 	const VkGraphicsPipelineCreateInfo createInfo = {
 		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -1802,324 +2936,2692 @@ FrResult frCreateGraphicsPipeline(const FrPipelineCreateInfo* pCreateInfo)
 		.pDepthStencilState = &depthStencil,
 		.pColorBlendState = &colorBlend,
 		.pDynamicState = &dynamic,
-		.layout = graphicsPipelines.data[graphicsPipelines.size - 1].pipelineLayout,
+		.layout = pPipeline->pipelineLayout,
 		.renderPass = renderPass,
 		.subpass = 0
 	};
 
-	if(vkCreateGraphicsPipelines(
-		device,
-		VK_NULL_HANDLE,
+	if(frCompileGraphicsPipeline(&createInfo, pHandle) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	#ifndef NDEBUG
+	if(debugExtensionAvailable)
+	{
+		char pipelineName[32];
+		snprintf(pipelineName, sizeof(pipelineName), "Fraus graphics pipeline %"PRIu32, pipelineIndex);
+
+		const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.objectType = VK_OBJECT_TYPE_PIPELINE,
+			.objectHandle = (uint64_t)*pHandle,
+			.pObjectName = pipelineName
+		};
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	#endif
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Create a compute pipeline and its layouts from the reflection of its shader.
+ *
+ * Parameters:
+ * - shaderPath: The path of the compute shader.
+ * - name: The debug name of the pipeline.
+ * - pPipeline: A pointer to the pipeline, to be destroyed with frDestroyComputePipeline even on failure.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_INVALID_ARGUMENT if the bindings of the shader are not 0 to n-1.
+ * - FR_ERROR_FILE_NOT_FOUND if the shader could not be found.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frLoadComputePipeline(const char* shaderPath, const char* name, FrComputePipeline* pPipeline)
+{
+	*pPipeline = (FrComputePipeline){0};
+
+	FrShaderInfo info;
+	VkShaderModule module;
+	FrResult result = frGetShader(shaderPath, &module, &info);
+	if(result != FR_SUCCESS)
+	{
+		return result;
+	}
+	free(info.inputs);
+	free(info.outputs);
+	free(info.specializationConstants);
+
+	memcpy(pPipeline->localSize, info.localSize, sizeof(pPipeline->localSize));
+	for(uint32_t i = 0; i < info.pushConstantCount; ++i)
+	{
+		const uint32_t end = info.pushConstants[i].offset + info.pushConstants[i].size;
+		pPipeline->pushConstantSize = end > pPipeline->pushConstantSize ? end : pPipeline->pushConstantSize;
+	}
+	free(info.pushConstants);
+
+	pPipeline->descriptorTypeCount = info.bindingCount;
+	if(info.bindingCount)
+	{
+		pPipeline->descriptorTypes = malloc(info.bindingCount * sizeof(pPipeline->descriptorTypes[0]));
+		if(!pPipeline->descriptorTypes)
+		{
+			free(info.bindings);
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+	// Descriptors are written by binding index, one per binding
+	for(uint32_t i = 0; i < info.bindingCount; ++i)
+	{
+		if(info.bindings[i].binding != i || info.bindings[i].descriptorCount != 1)
+		{
+			free(info.bindings);
+			return FR_ERROR_INVALID_ARGUMENT;
+		}
+		info.bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pPipeline->descriptorTypes[i] = info.bindings[i].descriptorType;
+	}
+
+	const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount = info.bindingCount,
+		.pBindings = info.bindings
+	};
+	const VkResult setLayoutResult = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutInfo, NULL, &pPipeline->descriptorSetLayout);
+	free(info.bindings);
+	if(setLayoutResult != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// The blocks of the shader are merged into a single range
+	const VkPushConstantRange pushConstantRange = {
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = pPipeline->pushConstantSize
+	};
+	const VkPipelineLayoutCreateInfo layoutInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 1,
+		.pSetLayouts = &pPipeline->descriptorSetLayout,
+		.pushConstantRangeCount = pPipeline->pushConstantSize ? 1 : 0,
+		.pPushConstantRanges = &pushConstantRange
+	};
+	if(vkCreatePipelineLayout(device, &layoutInfo, NULL, &pPipeline->pipelineLayout) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	const VkComputePipelineCreateInfo pipelineInfo = {
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.stage = {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+			.module = module,
+			.pName = "main"
+		},
+		.layout = pPipeline->pipelineLayout
+	};
+	if(frCompileComputePipeline(&pipelineInfo, &pPipeline->pipeline) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	#ifndef NDEBUG
+	if(debugExtensionAvailable)
+	{
+		const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.objectType = VK_OBJECT_TYPE_PIPELINE,
+			.objectHandle = (uint64_t)pPipeline->pipeline,
+			.pObjectName = name
+		};
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	#else
+	(void)name;
+	#endif
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Destroy a compute pipeline and its layouts. The device must not use them anymore.
+ *
+ * Parameters:
+ * - pPipeline: The pipeline.
+ */
+static void frDestroyComputePipeline(FrComputePipeline* pPipeline)
+{
+	vkDestroyPipeline(device, pPipeline->pipeline, NULL);
+	vkDestroyPipelineLayout(device, pPipeline->pipelineLayout, NULL);
+	vkDestroyDescriptorSetLayout(device, pPipeline->descriptorSetLayout, NULL);
+	free(pPipeline->descriptorTypes);
+	*pPipeline = (FrComputePipeline){0};
+}
+
+FrResult frCreateComputePipeline(const FrComputePipelineCreateInfo* pCreateInfo, uint32_t* pPipelineIndex)
+{
+	if(!pCreateInfo || !pCreateInfo->computeShaderPath || !pPipelineIndex)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	const uint32_t pipelineIndex = (uint32_t)computePipelines.size;
+	char pipelineName[32];
+	snprintf(pipelineName, sizeof(pipelineName), "Fraus compute pipeline %"PRIu32, pipelineIndex);
+
+	FrComputePipeline pipeline;
+	FrResult result = frLoadComputePipeline(pCreateInfo->computeShaderPath, pipelineName, &pipeline);
+
+	// Dispatches bind the resources objects bind, and copy their push constants
+	if(result == FR_SUCCESS && (pipeline.descriptorTypeCount > FR_MAX_DISPATCH_BINDINGS || pipeline.pushConstantSize > FR_MAX_PUSH_CONSTANTS_SIZE))
+	{
+		result = FR_ERROR_INVALID_ARGUMENT;
+	}
+	for(uint32_t i = 0; result == FR_SUCCESS && i < pipeline.descriptorTypeCount; ++i)
+	{
+		if(
+			pipeline.descriptorTypes[i] != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER &&
+			pipeline.descriptorTypes[i] != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER &&
+			pipeline.descriptorTypes[i] != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER &&
+			pipeline.descriptorTypes[i] != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+		)
+		{
+			result = FR_ERROR_INVALID_ARGUMENT;
+		}
+	}
+
+	if(result == FR_SUCCESS && frPushBackComputePipelineVector(&computePipelines, pipeline) != FR_SUCCESS)
+	{
+		result = FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	if(result != FR_SUCCESS)
+	{
+		frDestroyComputePipeline(&pipeline);
+		return result;
+	}
+
+	*pPipelineIndex = pipelineIndex;
+
+	return FR_SUCCESS;
+}
+
+FrResult frCreateUniformBuffer(VkDeviceSize size)
+{
+	if(frPushBackUniformBufferVector(&uniformBuffers, (FrUniformBuffer){0}) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	uniformBuffers.data[uniformBuffers.size - 1].buffersSize = size;
+
+	// Create uniform buffers
+	for(uint32_t frameIndex = 0; frameIndex < framesInFlight; ++frameIndex)
+	{
+		if(frCreateBuffer(
+			size,
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			&uniformBuffers.data[uniformBuffers.size - 1].buffers[frameIndex],
+			&uniformBuffers.data[uniformBuffers.size - 1].bufferMemories[frameIndex]
+		) != FR_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		if(vkMapMemory(device, uniformBuffers.data[uniformBuffers.size - 1].bufferMemories[frameIndex], 0, size, 0, &uniformBuffers.data[uniformBuffers.size - 1].bufferDatas[frameIndex]) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
+	frWriteBindlessDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (uint32_t)uniformBuffers.size - 1);
+
+	return FR_SUCCESS;
+}
+
+FrResult frCreateStorageBuffer(VkDeviceSize size)
+{
+	if(frPushBackStorageBufferVector(&storageBuffers, (FrStorageBuffer){0}) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	storageBuffers.data[storageBuffers.size - 1].bufferSize = size;
+
+	// Create storage buffer
+	if(frCreateBuffer(
+		size,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&storageBuffers.data[storageBuffers.size - 1].buffer,
+		&storageBuffers.data[storageBuffers.size - 1].bufferMemory
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	frWriteBindlessDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (uint32_t)storageBuffers.size - 1);
+
+	return FR_SUCCESS;
+}
+
+FrResult frSetStorageBufferData(FrUploadBatch* pBatch, uint32_t storageBufferIndex, const void* data, VkDeviceSize size)
+{
+	VkBuffer stagingBuffer;
+	void* mappedData;
+	if(frCreateStagingBuffer(pBatch, size, &stagingBuffer, &mappedData) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	memcpy(mappedData, data, size);
+
+	if(frCopyBuffer(pBatch, stagingBuffer, storageBuffers.data[storageBufferIndex].buffer, 0, size) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	return FR_SUCCESS;
+}
+
+FrResult frRetireUniformBuffer(uint32_t uniformBufferIndex)
+{
+	// The first uniform buffer holds the camera, and a retired slot is zeroed
+	if(uniformBufferIndex == 0 || uniformBufferIndex >= uniformBuffers.size || uniformBuffers.data[uniformBufferIndex].buffers[0] == VK_NULL_HANDLE)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	FrUniformBuffer* const pUniformBuffer = &uniformBuffers.data[uniformBufferIndex];
+	FrRetiredResource resources[2 * FR_MAX_FRAMES_IN_FLIGHT + 1];
+	for(uint32_t frameIndex = 0; frameIndex < framesInFlight; ++frameIndex)
+	{
+		resources[2 * frameIndex] = (FrRetiredResource){.type = FR_RETIRED_RESOURCE_BUFFER, .buffer = pUniformBuffer->buffers[frameIndex]};
+		resources[2 * frameIndex + 1] = (FrRetiredResource){.type = FR_RETIRED_RESOURCE_MEMORY, .memory = pUniformBuffer->bufferMemories[frameIndex]};
+	}
+	resources[2 * framesInFlight] = (FrRetiredResource){
+		.type = FR_RETIRED_RESOURCE_BINDLESS_DESCRIPTOR,
+		.bindlessType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+		.bindlessIndex = uniformBufferIndex
+	};
+	if(frRetireResources(2 * framesInFlight + 1, resources) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	// Keep the slot so the other uniform buffer indexes stay valid
+	*pUniformBuffer = (FrUniformBuffer){0};
+
+	return FR_SUCCESS;
+}
+
+FrResult frRetireStorageBuffer(uint32_t storageBufferIndex)
+{
+	if(storageBufferIndex >= storageBuffers.size || storageBuffers.data[storageBufferIndex].buffer == VK_NULL_HANDLE)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	FrStorageBuffer* const pStorageBuffer = &storageBuffers.data[storageBufferIndex];
+	const FrRetiredResource resources[] = {
+		{.type = FR_RETIRED_RESOURCE_BUFFER, .buffer = pStorageBuffer->buffer},
+		{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = pStorageBuffer->bufferMemory},
+		{.type = FR_RETIRED_RESOURCE_BINDLESS_DESCRIPTOR, .bindlessType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .bindlessIndex = storageBufferIndex}
+	};
+	if(frRetireResources(FR_LEN(resources), resources) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	// Keep the slot so the other storage buffer indexes stay valid
+	*pStorageBuffer = (FrStorageBuffer){0};
+
+	return FR_SUCCESS;
+}
+
+static FrResult frCreateSampler(void)
+{
+	VkPhysicalDeviceFeatures features;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	const VkSamplerCreateInfo samplerCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+		.magFilter = VK_FILTER_LINEAR,
+		.minFilter = VK_FILTER_LINEAR,
+		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+		.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		.mipLodBias = 0.f,
+		.anisotropyEnable = features.samplerAnisotropy,
+		.maxAnisotropy = properties.limits.maxSamplerAnisotropy,
+		.compareEnable = VK_FALSE,
+		.compareOp = VK_COMPARE_OP_ALWAYS,
+		.minLod = 0.f,
+		.maxLod = VK_LOD_CLAMP_NONE,
+		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+		.unnormalizedCoordinates = VK_FALSE
+	};
+	if(vkCreateSampler(device, &samplerCreateInfo, NULL, &textureSampler) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	return FR_SUCCESS;
+}
+
+static FrResult frCreateColorImage(void)
+{
+	// Multisampled color target, not needed when rendering with a single sample
+	if(msaaSamples != VK_SAMPLE_COUNT_1_BIT)
+	{
+		if(frCreateImage(swapchainExtent.width, swapchainExtent.height, 1, msaaSamples, swapchainFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &colorImage, &colorImageMemory) != FR_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+		if(frCreateImageView(colorImage, swapchainFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, &colorImageView) != FR_SUCCESS)
+		{
+			vkDestroyImage(device, colorImage, NULL);
+			vkFreeMemory(device, colorImageMemory, NULL);
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
+	// Scene image sampled by the post-process pass
+	if(postProcess.enabled)
+	{
+		if(frCreateImage(swapchainExtent.width, swapchainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, swapchainFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &postProcess.image, &postProcess.imageMemory) != FR_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+		if(frCreateImageView(postProcess.image, swapchainFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, &postProcess.imageView) != FR_SUCCESS)
+		{
+			vkDestroyImage(device, postProcess.image, NULL);
+			vkFreeMemory(device, postProcess.imageMemory, NULL);
+			return FR_ERROR_UNKNOWN;
+		}
+
+		// The descriptor sets are updated by frDrawFrame once their frame slot is free
+		for(uint32_t i = 0; i < framesInFlight; ++i)
+		{
+			postProcess.descriptorSetsOutdated[i] = true;
+		}
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Create the post-process render pass, sampler, descriptor set and pipeline.
+ * The image it samples is created with the other render targets.
+ *
+ * Parameters:
+ * - vertexShaderPath: The path of the fullscreen vertex shader.
+ * - fragmentShaderPath: The path of the fragment shader, sampling the scene at binding 0.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_FILE_NOT_FOUND if a shader could not be found.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frCreatePostProcess(const char* vertexShaderPath, const char* fragmentShaderPath)
+{
+	// Render pass, writing the whole swapchain image
+	const VkAttachmentDescription attachment = {
+		.format = swapchainFormat,
+		.samples = VK_SAMPLE_COUNT_1_BIT,
+		.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+		.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+		.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+		.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+	};
+	const VkAttachmentReference attachmentReference = {
+		.attachment = 0,
+		.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+	};
+	const VkSubpassDescription subpass = {
+		.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+		.colorAttachmentCount = 1,
+		.pColorAttachments = &attachmentReference
+	};
+	const VkSubpassDependency dependency = {
+		.srcSubpass = VK_SUBPASS_EXTERNAL,
+		.dstSubpass = 0,
+		.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		.srcAccessMask = 0,
+		.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+	};
+	const VkRenderPassCreateInfo renderPassInfo = {
+		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+		.attachmentCount = 1,
+		.pAttachments = &attachment,
+		.subpassCount = 1,
+		.pSubpasses = &subpass,
+		.dependencyCount = 1,
+		.pDependencies = &dependency
+	};
+	if(vkCreateRenderPass(device, &renderPassInfo, NULL, &postProcess.renderPass) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// Sampler, clamped so that edge pixels do not wrap around
+	const VkSamplerCreateInfo samplerInfo = {
+		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+		.magFilter = VK_FILTER_LINEAR,
+		.minFilter = VK_FILTER_LINEAR,
+		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+		.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.maxLod = 0.f,
+		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK
+	};
+	if(vkCreateSampler(device, &samplerInfo, NULL, &postProcess.sampler) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// Descriptor set
+	const VkDescriptorSetLayoutBinding binding = {
+		.binding = 0,
+		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+	};
+	const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount = 1,
+		.pBindings = &binding
+	};
+	if(vkCreateDescriptorSetLayout(device, &descriptorSetLayoutInfo, NULL, &postProcess.descriptorSetLayout) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	const VkDescriptorPoolSize poolSize = {
+		.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorCount = framesInFlight
+	};
+	const VkDescriptorPoolCreateInfo poolInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.maxSets = framesInFlight,
+		.poolSizeCount = 1,
+		.pPoolSizes = &poolSize
+	};
+	if(vkCreateDescriptorPool(device, &poolInfo, NULL, &postProcess.descriptorPool) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// One set per frame slot, so a resize never updates a set used by a frame in flight
+	VkDescriptorSetLayout setLayouts[FR_MAX_FRAMES_IN_FLIGHT];
+	for(uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		setLayouts[i] = postProcess.descriptorSetLayout;
+	}
+	const VkDescriptorSetAllocateInfo allocateInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = postProcess.descriptorPool,
+		.descriptorSetCount = framesInFlight,
+		.pSetLayouts = setLayouts
+	};
+	if(vkAllocateDescriptorSets(device, &allocateInfo, postProcess.descriptorSets) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	const VkPipelineLayoutCreateInfo layoutInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 1,
+		.pSetLayouts = &postProcess.descriptorSetLayout
+	};
+	if(vkCreatePipelineLayout(device, &layoutInfo, NULL, &postProcess.pipelineLayout) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// Shaders, only the modules are needed
+	VkShaderModule vertexModule;
+	FrResult result = frGetShader(vertexShaderPath, &vertexModule, NULL);
+	if(result != FR_SUCCESS)
+	{
+		return result;
+	}
+
+	VkShaderModule fragmentModule;
+	result = frGetShader(fragmentShaderPath, &fragmentModule, NULL);
+	if(result != FR_SUCCESS)
+	{
+		return result;
+	}
+
+	const VkPipelineShaderStageCreateInfo stageInfos[] = {
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.module = vertexModule,
+			.pName = "main",
+		},
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module = fragmentModule,
+			.pName = "main",
+		}
+	};
+
+	// Fullscreen triangle generated from the vertex index
+	const VkPipelineVertexInputStateCreateInfo vertexInput = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO
+	};
+	const VkPipelineInputAssemblyStateCreateInfo inputAssembly = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+	};
+	const VkPipelineViewportStateCreateInfo viewport = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+		.viewportCount = 1,
+		.scissorCount = 1
+	};
+	const VkPipelineRasterizationStateCreateInfo rasterization = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+		.polygonMode = VK_POLYGON_MODE_FILL,
+		.cullMode = VK_CULL_MODE_NONE,
+		.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+		.lineWidth = 1.f
+	};
+	const VkPipelineMultisampleStateCreateInfo multisample = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+		.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+	};
+	const VkPipelineColorBlendAttachmentState colorAttachment = {
+		.blendEnable = VK_FALSE,
+		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_A_BIT
+	};
+	const VkPipelineColorBlendStateCreateInfo colorBlend = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+		.attachmentCount = 1,
+		.pAttachments = &colorAttachment
+	};
+	const VkDynamicState dynamics[] = {VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VIEWPORT};
+	const VkPipelineDynamicStateCreateInfo dynamic = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		.dynamicStateCount = FR_LEN(dynamics),
+		.pDynamicStates = dynamics
+	};
+
+	const VkGraphicsPipelineCreateInfo pipelineInfo = {
+		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.stageCount = FR_LEN(stageInfos),
+		.pStages = stageInfos,
+		.pVertexInputState = &vertexInput,
+		.pInputAssemblyState = &inputAssembly,
+		.pViewportState = &viewport,
+		.pRasterizationState = &rasterization,
+		.pMultisampleState = &multisample,
+		.pColorBlendState = &colorBlend,
+		.pDynamicState = &dynamic,
+		.layout = postProcess.pipelineLayout,
+		.renderPass = postProcess.renderPass,
+		.subpass = 0
+	};
+	if(frCompileGraphicsPipeline(&pipelineInfo, &postProcess.pipeline) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	#ifndef NDEBUG
+	if(debugExtensionAvailable)
+	{
+		VkDebugUtilsObjectNameInfoEXT nameInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.objectType = VK_OBJECT_TYPE_RENDER_PASS,
+			.objectHandle = (uint64_t)postProcess.renderPass,
+			.pObjectName = "Fraus post-process render pass"
+		};
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		nameInfo.objectType = VK_OBJECT_TYPE_PIPELINE;
+		nameInfo.objectHandle = (uint64_t)postProcess.pipeline;
+		nameInfo.pObjectName = "Fraus post-process pipeline";
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	#endif
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Create the culling descriptor sets and compute pipelines, and enable GPU culling.
+ * The culling shader reads the instances at binding 0 and the transforms at binding 1, writes the visible transforms
+ * at binding 2, increments the instance counts of the indirect commands at binding 3 and tracks the visibility
+ * of the objects at binding 4. It samples the depth pyramid at binding 5 and reads the camera at binding 6.
+ * The frustum planes, the instance count and the phase are push constants.
+ *
+ * Parameters:
+ * - computeShaderPath: The path of the culling compute shader.
+ * - pyramidShaderPath: The path of the depth pyramid compute shader, NULL to cull against the frustum only.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_FILE_NOT_FOUND if a shader could not be found.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frCreateCulling(const char* computeShaderPath, const char* pyramidShaderPath)
+{
+	FrResult result = frLoadComputePipeline(computeShaderPath, "Fraus culling pipeline", &culling.pipeline);
+	if(result != FR_SUCCESS)
+	{
+		return result;
+	}
+	if(culling.pipeline.descriptorTypeCount != 7 || culling.pipeline.pushConstantSize != sizeof(FrCullConstants))
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	const VkDescriptorPoolSize poolSizes[] = {
+		{
+			.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = framesInFlight * 5
+		},
+		{
+			.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.descriptorCount = framesInFlight
+		},
+		{
+			.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+			.descriptorCount = framesInFlight
+		}
+	};
+	const VkDescriptorPoolCreateInfo poolInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.maxSets = framesInFlight,
+		.poolSizeCount = FR_LEN(poolSizes),
+		.pPoolSizes = poolSizes
+	};
+	if(vkCreateDescriptorPool(device, &poolInfo, NULL, &culling.descriptorPool) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// One set per frame slot, rewritten by each frame as the buffers may have grown
+	VkDescriptorSetLayout setLayouts[FR_MAX_FRAMES_IN_FLIGHT];
+	for(uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		setLayouts[i] = culling.pipeline.descriptorSetLayout;
+	}
+	const VkDescriptorSetAllocateInfo allocateInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = culling.descriptorPool,
+		.descriptorSetCount = framesInFlight,
+		.pSetLayouts = setLayouts
+	};
+	if(vkAllocateDescriptorSets(device, &allocateInfo, culling.descriptorSets) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// The culling shader always samples the pyramid, which is 1x1 without occlusion culling
+	const VkSamplerCreateInfo samplerInfo = {
+		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+		.magFilter = VK_FILTER_NEAREST,
+		.minFilter = VK_FILTER_NEAREST,
+		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+		.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.maxLod = VK_LOD_CLAMP_NONE
+	};
+	if(vkCreateSampler(device, &samplerInfo, NULL, &culling.pyramidSampler) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	culling.enabled = true;
+
+	// The depth pyramid samples the depth buffer and is written as a storage image
+	VkFormatProperties depthProperties;
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_D24_UNORM_S8_UINT, &depthProperties);
+	VkFormatProperties pyramidProperties;
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R32_SFLOAT, &pyramidProperties);
+	if(
+		!pyramidShaderPath ||
+		!(depthProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) ||
+		!(pyramidProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)
+	)
+	{
+		return FR_SUCCESS;
+	}
+
+	// Depth pyramid, each level reduces the previous one
+	result = frLoadComputePipeline(pyramidShaderPath, "Fraus depth pyramid pipeline", &culling.pyramidPipeline);
+	if(result != FR_SUCCESS)
+	{
+		return result;
+	}
+	if(
+		culling.pyramidPipeline.descriptorTypeCount != 2 ||
+		culling.pyramidPipeline.descriptorTypes[0] != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+		culling.pyramidPipeline.descriptorTypes[1] != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+	)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	culling.occlusionAvailable = true;
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Check whether the frames test the instances against the depth pyramid.
+ * The pyramid is built from the depth buffer, which cannot be sampled directly when multisampled.
+ *
+ * Returns:
+ * - true if occlusion culling is active.
+ * - false otherwise.
+ */
+static bool frIsOcclusionCullingActive(void)
+{
+	return culling.occlusionAvailable && msaaSamples == VK_SAMPLE_COUNT_1_BIT;
+}
+
+/*
+ * Create the depth pyramid for the current depth image, 1x1 when occlusion culling is not active.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+static FrResult frCreateDepthPyramid(void)
+{
+	FrDepthPyramid* const pPyramid = &culling.pyramid;
+	*pPyramid = (FrDepthPyramid){
+		.width = 1,
+		.height = 1,
+		.levelCount = 1
+	};
+
+	const bool occlusion = frIsOcclusionCullingActive();
+	if(occlusion)
+	{
+		pPyramid->width = swapchainExtent.width / 2 > 1 ? swapchainExtent.width / 2 : 1;
+		pPyramid->height = swapchainExtent.height / 2 > 1 ? swapchainExtent.height / 2 : 1;
+		const uint32_t size = pPyramid->width > pPyramid->height ? pPyramid->width : pPyramid->height;
+		while(pPyramid->levelCount < FR_DEPTH_PYRAMID_MAX_LEVELS && size >> pPyramid->levelCount)
+		{
+			++pPyramid->levelCount;
+		}
+	}
+
+	if(frCreateImage(
+		pPyramid->width,
+		pPyramid->height,
+		pPyramid->levelCount,
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_FORMAT_R32_SFLOAT,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&pPyramid->image,
+		&pPyramid->imageMemory
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	if(frCreateImageView(pPyramid->image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, pPyramid->levelCount, &pPyramid->imageView) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// Each level is written through its own view
+	for(uint32_t levelIndex = 0; levelIndex < pPyramid->levelCount; ++levelIndex)
+	{
+		const VkImageViewCreateInfo viewInfo = {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = pPyramid->image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = VK_FORMAT_R32_SFLOAT,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = levelIndex,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			}
+		};
+		if(vkCreateImageView(device, &viewInfo, NULL, &pPyramid->levelViews[levelIndex]) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
+	if(!occlusion)
+	{
+		return FR_SUCCESS;
+	}
+
+	// One set per level, reading the previous level or the depth buffer for the first one
+	const VkDescriptorPoolSize poolSizes[] = {
+		{
+			.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.descriptorCount = pPyramid->levelCount
+		},
+		{
+			.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			.descriptorCount = pPyramid->levelCount
+		}
+	};
+	const VkDescriptorPoolCreateInfo poolInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.maxSets = pPyramid->levelCount,
+		.poolSizeCount = FR_LEN(poolSizes),
+		.pPoolSizes = poolSizes
+	};
+	if(vkCreateDescriptorPool(device, &poolInfo, NULL, &pPyramid->descriptorPool) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	VkDescriptorSetLayout setLayouts[FR_DEPTH_PYRAMID_MAX_LEVELS];
+	for(uint32_t levelIndex = 0; levelIndex < pPyramid->levelCount; ++levelIndex)
+	{
+		setLayouts[levelIndex] = culling.pyramidPipeline.descriptorSetLayout;
+	}
+	const VkDescriptorSetAllocateInfo allocateInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = pPyramid->descriptorPool,
+		.descriptorSetCount = pPyramid->levelCount,
+		.pSetLayouts = setLayouts
+	};
+	if(vkAllocateDescriptorSets(device, &allocateInfo, pPyramid->descriptorSets) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	for(uint32_t levelIndex = 0; levelIndex < pPyramid->levelCount; ++levelIndex)
+	{
+		const VkDescriptorImageInfo imageInfos[] = {
+			{
+				.sampler = culling.pyramidSampler,
+				.imageView = levelIndex ? pPyramid->levelViews[levelIndex - 1] : depthImageView,
+				.imageLayout = levelIndex ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+			},
+			{
+				.imageView = pPyramid->levelViews[levelIndex],
+				.imageLayout = VK_IMAGE_LAYOUT_GENERAL
+			}
+		};
+		const VkWriteDescriptorSet writes[] = {
+			{
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = pPyramid->descriptorSets[levelIndex],
+				.dstBinding = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+				.pImageInfo = &imageInfos[0]
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = pPyramid->descriptorSets[levelIndex],
+				.dstBinding = 1,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.pImageInfo = &imageInfos[1]
+			}
+		};
+		vkUpdateDescriptorSets(device, FR_LEN(writes), writes, 0, NULL);
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Retire the framebuffers and the color, depth and post-process images,
+ * which depend on the swapchain extent and the anti-aliasing settings.
+ * Frames in flight may still use them, so they are destroyed once those complete.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a resource could not be retired.
+ */
+static FrResult frRetireRenderTargets(void)
+{
+	for(uint32_t imageIndex = 0; imageIndex < swapchainImageCount; ++imageIndex)
+	{
+		if(frRetireResource((FrRetiredResource){.type = FR_RETIRED_RESOURCE_FRAMEBUFFER, .framebuffer = framebuffers[imageIndex]}) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		if(postProcess.framebuffers && frRetireResource((FrRetiredResource){.type = FR_RETIRED_RESOURCE_FRAMEBUFFER, .framebuffer = postProcess.framebuffers[imageIndex]}) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+	free(postProcess.framebuffers);
+	postProcess.framebuffers = NULL;
+
+	const FrRetiredResource resources[] = {
+		{.type = FR_RETIRED_RESOURCE_IMAGE_VIEW, .imageView = depthImageView},
+		{.type = FR_RETIRED_RESOURCE_IMAGE, .image = depthImage},
+		{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = depthImageMemory},
+		{.type = FR_RETIRED_RESOURCE_IMAGE_VIEW, .imageView = colorImageView},
+		{.type = FR_RETIRED_RESOURCE_IMAGE, .image = colorImage},
+		{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = colorImageMemory},
+		{.type = FR_RETIRED_RESOURCE_IMAGE_VIEW, .imageView = postProcess.imageView},
+		{.type = FR_RETIRED_RESOURCE_IMAGE, .image = postProcess.image},
+		{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = postProcess.imageMemory}
+	};
+	for(uint32_t resourceIndex = 0; resourceIndex < FR_LEN(resources); ++resourceIndex)
+	{
+		if(frRetireResource(resources[resourceIndex]) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+
+	// The depth pyramid follows the depth image
+	if(culling.enabled)
+	{
+		for(uint32_t levelIndex = 0; levelIndex < culling.pyramid.levelCount; ++levelIndex)
+		{
+			if(frRetireResource((FrRetiredResource){.type = FR_RETIRED_RESOURCE_IMAGE_VIEW, .imageView = culling.pyramid.levelViews[levelIndex]}) != FR_SUCCESS)
+			{
+				return FR_ERROR_OUT_OF_HOST_MEMORY;
+			}
+		}
+		const FrRetiredResource pyramidResources[] = {
+			{.type = FR_RETIRED_RESOURCE_DESCRIPTOR_POOL, .descriptorPool = culling.pyramid.descriptorPool},
+			{.type = FR_RETIRED_RESOURCE_IMAGE_VIEW, .imageView = culling.pyramid.imageView},
+			{.type = FR_RETIRED_RESOURCE_IMAGE, .image = culling.pyramid.image},
+			{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = culling.pyramid.imageMemory}
+		};
+		if(frRetireResources(FR_LEN(pyramidResources), pyramidResources) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		culling.pyramid = (FrDepthPyramid){0};
+	}
+
+	colorImageView = VK_NULL_HANDLE;
+	colorImage = VK_NULL_HANDLE;
+	colorImageMemory = VK_NULL_HANDLE;
+	postProcess.imageView = VK_NULL_HANDLE;
+	postProcess.image = VK_NULL_HANDLE;
+	postProcess.imageMemory = VK_NULL_HANDLE;
+
+	return FR_SUCCESS;
+}
+
+static FrResult frCreateDepthImage(void)
+{
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_D24_UNORM_S8_UINT, &properties);
+	if(!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT))
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	if(frCreateImage(
+		swapchainExtent.width,
+		swapchainExtent.height,
+		1,
+		msaaSamples,
+		VK_FORMAT_D24_UNORM_S8_UINT,
+		VK_IMAGE_TILING_OPTIMAL,
+		// The depth pyramid samples it, so it must be stored
+		frIsOcclusionCullingActive() ? VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&depthImage,
+		&depthImageMemory
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	if(frCreateImageView(depthImage, VK_FORMAT_D24_UNORM_S8_UINT, VK_IMAGE_ASPECT_DEPTH_BIT, 1, &depthImageView) != FR_SUCCESS)
+	{
+		vkDestroyImage(device, depthImage, NULL);
+		vkFreeMemory(device, depthImageMemory, NULL);
+		return FR_ERROR_UNKNOWN;
+	}
+
+	return FR_SUCCESS;
+}
+
+static FrResult frCreateCommandPools(void)
+{
+	frameInFlightIndex = 0;
+	frameCounter = 0;
+
+	const VkSemaphoreTypeCreateInfo timelineCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = 0
+	};
+	const VkSemaphoreCreateInfo timelineSemaphoreCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &timelineCreateInfo
+	};
+	if(vkCreateSemaphore(device, &timelineSemaphoreCreateInfo, NULL, &frameTimelineSemaphore) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	#ifndef NDEBUG
+	if(debugExtensionAvailable)
+	{
+		const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.objectType = VK_OBJECT_TYPE_SEMAPHORE,
+			.objectHandle = (uint64_t)frameTimelineSemaphore,
+			.pObjectName = "Fraus frame timeline semaphore"
+		};
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	#endif
+
+	for(uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		const VkCommandPoolCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.queueFamilyIndex = queueFamily
+		};
+		if(vkCreateCommandPool(device, &createInfo, NULL, &commandPools[i]) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		#ifndef NDEBUG
+		if(debugExtensionAvailable)
+		{
+			char commandPoolName[32];
+			snprintf(commandPoolName, sizeof(commandPoolName), "Fraus command pool %"PRIu32, i);
+
+			const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+				.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+				.objectType = VK_OBJECT_TYPE_COMMAND_POOL,
+				.objectHandle = (uint64_t)commandPools[i],
+				.pObjectName = commandPoolName
+			};
+			if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+			{
+				return FR_ERROR_UNKNOWN;
+			}
+		}
+		#endif
+
+		const VkCommandBufferAllocateInfo allocateInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = commandPools[i],
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1
+		};
+		if(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffers[i]) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		#ifndef NDEBUG
+		if(debugExtensionAvailable)
+		{
+			char commandBufferName[32];
+			snprintf(commandBufferName, sizeof(commandBufferName), "Fraus command buffer %"PRIu32, i);
+
+			const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+				.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+				.objectType = VK_OBJECT_TYPE_COMMAND_BUFFER,
+				.objectHandle = (uint64_t)commandBuffers[i],
+				.pObjectName = commandBufferName
+			};
+			if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+			{
+				return FR_ERROR_UNKNOWN;
+			}
+		}
+		#endif
+
+		const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+		};
+		if(vkCreateSemaphore(device, &semaphoreCreateInfo, NULL, &imageAvailableSemaphores[i]) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+		if(vkCreateSemaphore(device, &semaphoreCreateInfo, NULL, &renderFinishedSemaphores[i]) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Create the recorders, one per job thread.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+static FrResult frCreateRecorders(void)
+{
+	const uint32_t threadCount = frGetJobThreadCount();
+	const uint32_t recorderCount = threadCount < FR_MAX_RECORDERS ? threadCount : FR_MAX_RECORDERS;
+	recording.recorderCount = 0;
+	for(uint32_t recorderIndex = 0; recorderIndex < recorderCount; ++recorderIndex)
+	{
+		FrRecorder* const pRecorder = &recording.recorders[recorderIndex];
+		*pRecorder = (FrRecorder){0};
+
+		// Counted first, so the pools created before a failure are destroyed
+		++recording.recorderCount;
+		for(uint32_t i = 0; i < framesInFlight; ++i)
+		{
+			const VkCommandPoolCreateInfo createInfo = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = queueFamily
+			};
+			if(vkCreateCommandPool(device, &createInfo, NULL, &pRecorder->commandPools[i]) != VK_SUCCESS)
+			{
+				return FR_ERROR_UNKNOWN;
+			}
+
+			VkCommandBuffer secondaryCommandBuffers[2];
+			const VkCommandBufferAllocateInfo allocateInfo = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = pRecorder->commandPools[i],
+				.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+				.commandBufferCount = FR_LEN(secondaryCommandBuffers)
+			};
+			if(vkAllocateCommandBuffers(device, &allocateInfo, secondaryCommandBuffers) != VK_SUCCESS)
+			{
+				return FR_ERROR_UNKNOWN;
+			}
+			pRecorder->earlyCommandBuffers[i] = secondaryCommandBuffers[0];
+			pRecorder->commandBuffers[i] = secondaryCommandBuffers[1];
+		}
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Destroy the command pools of the recorders. The device must not use them anymore.
+ */
+static void frDestroyRecorders(void)
+{
+	for(uint32_t recorderIndex = 0; recorderIndex < recording.recorderCount; ++recorderIndex)
+	{
+		for(uint32_t i = 0; i < framesInFlight; ++i)
+		{
+			// Null for the pools that were never created
+			vkDestroyCommandPool(device, recording.recorders[recorderIndex].commandPools[i], NULL);
+		}
+	}
+	recording.recorderCount = 0;
+}
+
+/*
+ * Check whether an object is drawn from the indirect buffer, as part of an instanced mesh batch.
+ *
+ * Parameters:
+ * - pObject: The object.
+ *
+ * Returns:
+ * - true if the object is drawn indirectly.
+ * - false otherwise.
+ */
+static bool frIsIndirectObject(const FrVulkanObject* pObject)
+{
+	// A non zero firstInstance in an indirect command needs drawIndirectFirstInstance
+	return
+		graphicsPipelines.data[pObject->pipelineIndex].instanceTransforms &&
+		pObject->geometry.buffer == VK_NULL_HANDLE &&
+		drawIndirectFirstInstanceAvailable;
+}
+
+/*
+ * Submit a draw packet for every live and visible object and sort them by key.
+ * Indirect objects are left to the culling compute pass when it is enabled,
+ * other objects with a mesh are culled here, and objects with their own geometry are never culled.
+ *
+ * Parameters:
+ * - pFrustum: The camera frustum.
+ * - pCulledCount: A pointer to the number of objects culled on the CPU.
+ * - pGpuCullCount: A pointer to the number of packets left to the culling compute pass.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+static FrResult frBuildDrawList(const FrFrustum* pFrustum, uint32_t* pCulledCount, uint32_t* pGpuCullCount)
+{
+	// The objects culled on the CPU are submitted first, so that their packets are contiguous
+	drawList.size = 0;
+	cullSpheres.size = 0;
+	*pGpuCullCount = 0;
+	for(uint32_t step = 0; step < 2; ++step)
+	{
+		for(uint32_t objectIndex = 0; objectIndex < frameState.objectCount; ++objectIndex)
+		{
+			const FrVulkanObject* const pObject = &frObjects.data[objectIndex];
+			// Retired object, or pipeline still building in the background
+			if(!pObject->alive || graphicsPipelines.data[pObject->pipelineIndex].pipeline == VK_NULL_HANDLE)
+			{
+				continue;
+			}
+
+			const bool gpuCulled = culling.enabled && frIsIndirectObject(pObject);
+			const bool cpuCulled = pObject->geometry.buffer == VK_NULL_HANDLE && !gpuCulled;
+			if(cpuCulled != (step == 0))
+			{
+				continue;
+			}
+
+			if(cpuCulled)
+			{
+				const FrSphere sphere = frTransformSphere(&meshArena.meshes.data[pObject->meshIndex].bounds, frameState.transforms[objectIndex]);
+				if(frPushBackSphereVector(&cullSpheres, sphere) != FR_SUCCESS)
+				{
+					return FR_ERROR_OUT_OF_HOST_MEMORY;
+				}
+			}
+			else if(gpuCulled)
+			{
+				++*pGpuCullCount;
+			}
+
+			const FrPipeline* const pPipeline = &graphicsPipelines.data[pObject->pipelineIndex];
+			const FrDrawPass drawPass =
+				pPipeline->depthTestDisable ? FR_DRAW_PASS_OVERLAY :
+				pPipeline->alphaBlendEnable ? FR_DRAW_PASS_TRANSPARENT :
+				FR_DRAW_PASS_OPAQUE;
+
+			// Squared distance from the camera to the object origin, enough to order them
+			const float* const transform = frameState.transforms[objectIndex];
+			const FrVec3 offset = {
+				.x = transform[12] - frameState.camera.position.x,
+				.y = transform[13] - frameState.camera.position.y,
+				.z = transform[14] - frameState.camera.position.z
+			};
+			const float depth = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+
+			// Objects with their own geometry are never instanced together
+			const uint32_t mesh = pObject->geometry.buffer != VK_NULL_HANDLE ? UINT32_MAX : pObject->meshIndex;
+			const FrDrawPacket packet = {
+				.key = frMakeDrawKey(drawPass, pObject->pipelineIndex, pObject->materialIndex, mesh, depth),
+				.objectIndex = objectIndex
+			};
+			if(frPushBackDrawPacketVector(&drawList, packet) != FR_SUCCESS)
+			{
+				return FR_ERROR_OUT_OF_HOST_MEMORY;
+			}
+		}
+
+		if(step == 0)
+		{
+			drawList.size = frCullDrawPackets(pFrustum, drawList.size, cullSpheres.data, drawList.data);
+			*pCulledCount = (uint32_t)(cullSpheres.size - drawList.size);
+		}
+	}
+
+	if(drawListScratch.capacity < drawList.size)
+	{
+		FrDrawPacket* const newScratch = realloc(drawListScratch.data, drawList.capacity * sizeof(newScratch[0]));
+		if(!newScratch)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		drawListScratch.data = newScratch;
+		drawListScratch.capacity = drawList.capacity;
+	}
+
+	frSortDrawPackets(drawList.size, drawList.data, drawListScratch.data);
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Find the end of the batch starting at a packet of the draw list.
+ * The following objects sharing the mesh and the material are drawn as instances of the first one.
+ *
+ * Parameters:
+ * - packetIndex: The first packet of the batch.
+ *
+ * Returns:
+ * - The index of the packet following the batch.
+ */
+static size_t frGetBatchEnd(size_t packetIndex)
+{
+	const FrVulkanObject* const pObject = &frObjects.data[drawList.data[packetIndex].objectIndex];
+	size_t batchEnd = packetIndex + 1;
+	if(!graphicsPipelines.data[pObject->pipelineIndex].instanceTransforms || pObject->geometry.buffer != VK_NULL_HANDLE)
+	{
+		return batchEnd;
+	}
+
+	while(batchEnd < drawList.size)
+	{
+		const FrVulkanObject* const pNextObject = &frObjects.data[drawList.data[batchEnd].objectIndex];
+		if(
+			pNextObject->materialIndex != pObject->materialIndex ||
+			pNextObject->meshIndex != pObject->meshIndex ||
+			pNextObject->geometry.buffer != VK_NULL_HANDLE
+		)
+		{
+			break;
+		}
+		++batchEnd;
+	}
+
+	return batchEnd;
+}
+
+/*
+ * Split the draw list into ranges of about the same number of packets, without splitting batches.
+ * Only the batches are walked, which is much cheaper than recording them.
+ *
+ * Parameters:
+ * - maxRangeCount: The maximum number of ranges, at least 1.
+ * - pRanges: The ranges.
+ *
+ * Returns:
+ * - The number of ranges, at most maxRangeCount.
+ */
+static uint32_t frSplitDrawList(uint32_t maxRangeCount, FrDrawRange* pRanges)
+{
+	const size_t targetSize = (drawList.size + maxRangeCount - 1) / maxRangeCount;
+
+	uint32_t rangeCount = 0;
+	FrDrawRange range = {0};
+	for(size_t packetIndex = 0; packetIndex < drawList.size;)
+	{
+		if(packetIndex - range.packetBegin >= targetSize && rangeCount + 1 < maxRangeCount)
+		{
+			range.packetEnd = packetIndex;
+			pRanges[rangeCount++] = range;
+			range.packetBegin = packetIndex;
+		}
+
+		const FrVulkanObject* const pObject = &frObjects.data[drawList.data[packetIndex].objectIndex];
+		const size_t batchEnd = frGetBatchEnd(packetIndex);
+		const uint32_t batchInstanceCount = (uint32_t)(batchEnd - packetIndex);
+		if(graphicsPipelines.data[pObject->pipelineIndex].instanceTransforms)
+		{
+			range.transformOffset += batchInstanceCount;
+		}
+		if(frIsIndirectObject(pObject))
+		{
+			++range.commandOffset;
+			if(culling.enabled)
+			{
+				range.cullInstanceOffset += batchInstanceCount;
+			}
+		}
+
+		packetIndex = batchEnd;
+	}
+	range.packetEnd = drawList.size;
+	pRanges[rangeCount++] = range;
+
+	// The counters were accumulated up to the end of each range, shift them to its start
+	for(uint32_t rangeIndex = rangeCount - 1; rangeIndex > 0; --rangeIndex)
+	{
+		pRanges[rangeIndex].transformOffset = pRanges[rangeIndex - 1].transformOffset;
+		pRanges[rangeIndex].commandOffset = pRanges[rangeIndex - 1].commandOffset;
+		pRanges[rangeIndex].cullInstanceOffset = pRanges[rangeIndex - 1].cullInstanceOffset;
+	}
+	pRanges[0].transformOffset = 0;
+	pRanges[0].commandOffset = 0;
+	pRanges[0].cullInstanceOffset = 0;
+
+	return rangeCount;
+}
+
+/*
+ * Set the viewport and scissor to the swapchain extent. Secondary command buffers do not inherit them.
+ *
+ * Parameters:
+ * - commandBuffer: The command buffer.
+ */
+static void frSetViewport(VkCommandBuffer commandBuffer)
+{
+	const VkViewport viewport = {
+		.x = 0.f,
+		.y = 0.f,
+		.width = (float)swapchainExtent.width,
+		.height = (float)swapchainExtent.height,
+		.minDepth = 0.f,
+		.maxDepth = 1.f
+	};
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+	const VkRect2D scissor = {
+		.offset = {0, 0},
+		.extent = swapchainExtent
+	};
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+/*
+ * Add the draws and state changes recorded by a recorder to the frame statistics.
+ *
+ * Parameters:
+ * - pTotal: The frame statistics.
+ * - pStatistics: The statistics of the recorder.
+ */
+static void frAddDrawStatistics(FrDrawStatistics* pTotal, const FrDrawStatistics* pStatistics)
+{
+	pTotal->drawCount += pStatistics->drawCount;
+	pTotal->indirectCommandCount += pStatistics->indirectCommandCount;
+	pTotal->instanceCount += pStatistics->instanceCount;
+	pTotal->pipelineBindCount += pStatistics->pipelineBindCount;
+	pTotal->descriptorSetBindCount += pStatistics->descriptorSetBindCount;
+	pTotal->vertexBufferBindCount += pStatistics->vertexBufferBindCount;
+}
+
+/*
+ * Record the draws of a run of commands from the indirect buffer of the current frame slot.
+ * A single call covers the run when multi draw indirect is available.
+ *
+ * Parameters:
+ * - commandBuffer: The command buffer.
+ * - firstCommand: The index of the first command.
+ * - commandCount: The number of commands.
+ * - pStatistics: The statistics to update.
+ */
+static void frRecordIndirectDraws(VkCommandBuffer commandBuffer, uint32_t firstCommand, uint32_t commandCount, FrDrawStatistics* pStatistics)
+{
+	// Minimum maxDrawIndirectCount guaranteed with multiDrawIndirect
+	const uint32_t maxCommandCount = multiDrawIndirectAvailable ? UINT16_MAX : 1;
+
+	while(commandCount)
+	{
+		const uint32_t drawCommandCount = commandCount < maxCommandCount ? commandCount : maxCommandCount;
+		vkCmdDrawIndexedIndirect(
+			commandBuffer,
+			indirectBuffer.buffers[frameInFlightIndex],
+			firstCommand * sizeof(VkDrawIndexedIndirectCommand),
+			drawCommandCount,
+			sizeof(VkDrawIndexedIndirectCommand)
+		);
+		++pStatistics->drawCount;
+
+		firstCommand += drawCommandCount;
+		commandCount -= drawCommandCount;
+	}
+}
+
+/*
+ * Record the draws of a range of the draw list in the current render pass, binding only the state that changes.
+ * The main render pass writes the transforms, the indirect commands and the culled instances of the range,
+ * the early one only draws the early commands of the instances tested against the depth pyramid.
+ * Ranges write to disjoint parts of the buffers, so they can be recorded by several threads.
+ *
+ * Parameters:
+ * - commandBuffer: The command buffer, either the primary one or a secondary one continuing the render pass.
+ * - earlyPass: Whether the early render pass of occlusion culling is recorded.
+ * - pRange: The range.
+ * - lateCommandOffset: The offset of the late indirect commands and visible transforms, 0 without occlusion culling.
+ * - pCullInstances: The instances culled on the GPU, ignored by the early pass.
+ * - pStatistics: The statistics, the instances and commands are counted by the main pass only.
+ *
+ * Returns:
+ * - The number of culled instances written.
+ */
+static uint32_t frRecordSceneDraws(VkCommandBuffer commandBuffer, bool earlyPass, const FrDrawRange* pRange, uint32_t lateCommandOffset, FrCullInstance* pCullInstances, FrDrawStatistics* pStatistics)
+{
+	VkDrawIndexedIndirectCommand* const indirectCommands = indirectBuffer.bufferDatas[frameInFlightIndex];
+	const uint32_t commandOffset = earlyPass ? 0 : lateCommandOffset;
+
+	uint32_t boundPipelineIndex = UINT32_MAX;
+	uint32_t boundMaterialIndex = UINT32_MAX;
+	// NULL when the mesh arena is bound
+	const FrObjectGeometry* pBoundGeometry = NULL;
+	bool geometryBound = false;
+	uint32_t transformCount = pRange->transformOffset;
+	// Indirect commands written so far, the ones from runStart on share the bound state and are not recorded yet
+	uint32_t indirectCount = pRange->commandOffset;
+	uint32_t runStart = indirectCount;
+	uint32_t cullInstanceCount = pRange->cullInstanceOffset;
+	for(size_t packetIndex = pRange->packetBegin; packetIndex < pRange->packetEnd;)
+	{
+		const FrVulkanObject* const pObject = &frObjects.data[drawList.data[packetIndex].objectIndex];
+		const FrPipeline* const pPipeline = &graphicsPipelines.data[pObject->pipelineIndex];
+		const FrObjectGeometry* const pGeometry = pObject->geometry.buffer != VK_NULL_HANDLE ? &pObject->geometry : NULL;
+
+		const size_t batchEnd = frGetBatchEnd(packetIndex);
+		const uint32_t batchInstanceCount = (uint32_t)(batchEnd - packetIndex);
+
+		// Arena batches go through the indirect buffer
+		const bool indirect = frIsIndirectObject(pObject);
+		// Blending needs the draw order, so only opaque instances can be drawn early
+		const bool occlusionTested = culling.enabled && indirect && !pPipeline->depthTestDisable && !pPipeline->alphaBlendEnable;
+		const bool drawn = !earlyPass || occlusionTested;
+		if(
+			indirectCount != runStart &&
+			(!drawn || !indirect || pObject->pipelineIndex != boundPipelineIndex || pObject->materialIndex != boundMaterialIndex)
+		)
+		{
+			frRecordIndirectDraws(commandBuffer, commandOffset + runStart, indirectCount - runStart, pStatistics);
+			runStart = indirectCount;
+		}
+
+		const uint32_t firstInstance = pPipeline->instanceTransforms ? transformCount : 0;
+		if(pPipeline->instanceTransforms)
+		{
+			transformCount += batchInstanceCount;
+		}
+
+		// The early pass keeps the counters in step with the main one
+		if(!drawn)
+		{
+			if(indirect)
+			{
+				runStart = ++indirectCount;
+			}
+			packetIndex = batchEnd;
+			continue;
+		}
+
+		if(pObject->pipelineIndex != boundPipelineIndex)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->pipeline);
+			boundPipelineIndex = pObject->pipelineIndex;
+			++pStatistics->pipelineBindCount;
+
+			// The push constant ranges differ between bindless pipelines, so the set is bound again
+			if(pPipeline->bindless)
+			{
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->pipelineLayout, 0, 1, &bindless.descriptorSets[frameInFlightIndex], 0, NULL);
+				++pStatistics->descriptorSetBindCount;
+			}
+		}
+
+		// Objects sharing a material have equivalent descriptor sets, or resource indexes for bindless pipelines
+		if(pObject->materialIndex != boundMaterialIndex)
+		{
+			if(!pPipeline->bindless)
+			{
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->pipelineLayout, 0, 1, &pObject->descriptorSets[frameInFlightIndex], 0, NULL);
+				++pStatistics->descriptorSetBindCount;
+			}
+			else if(pPipeline->descriptorTypeCount)
+			{
+				vkCmdPushConstants(
+					commandBuffer,
+					pPipeline->pipelineLayout,
+					VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+					FR_BINDLESS_INDEXES_OFFSET,
+					pPipeline->descriptorTypeCount * sizeof(uint32_t),
+					materials.data[pObject->materialIndex].bindingIndexes
+				);
+			}
+			boundMaterialIndex = pObject->materialIndex;
+		}
+
+		if(pPipeline->instanceTransforms)
+		{
+			if(!earlyPass)
+			{
+				for(size_t batchIndex = packetIndex; batchIndex < batchEnd; ++batchIndex)
+				{
+					memcpy(
+						(char*)transformBuffer.bufferDatas[frameInFlightIndex] + FR_INSTANCE_TRANSFORM_SIZE * (firstInstance + (batchIndex - packetIndex)),
+						frameState.transforms[drawList.data[batchIndex].objectIndex],
+						FR_INSTANCE_TRANSFORM_SIZE
+					);
+				}
+			}
+		}
+		else if(pPipeline->hasPushConstants)
+		{
+			const VkShaderStageFlags stageFlags = pPipeline->bindless ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
+			vkCmdPushConstants(commandBuffer, pPipeline->pipelineLayout, stageFlags, 0, sizeof(frameState.transforms[0]), frameState.transforms[drawList.data[packetIndex].objectIndex]);
+		}
+
+		if(!geometryBound || pGeometry != pBoundGeometry)
+		{
+			if(pGeometry)
+			{
+				const VkBuffer buffers[FR_MAX_GEOMETRY_VERTEX_BINDINGS] = {pGeometry->buffer, pGeometry->buffer};
+				vkCmdBindVertexBuffers(commandBuffer, 0, pGeometry->vertexBindingCount, buffers, pGeometry->vertexOffsets);
+				vkCmdBindIndexBuffer(commandBuffer, pGeometry->buffer, pGeometry->indexOffset, pGeometry->indexType);
+			}
+			else
+			{
+				// The transform buffer is ignored by the pipelines without instance transforms
+				const VkBuffer buffers[] = {
+					meshArena.vertexBuffer,
+					culling.enabled ? culling.visibleTransformBuffer.buffers[frameInFlightIndex] : transformBuffer.buffers[frameInFlightIndex]
+				};
+				const VkDeviceSize offsets[] = {0, 0};
+				vkCmdBindVertexBuffers(commandBuffer, 0, FR_LEN(buffers), buffers, offsets);
+				vkCmdBindIndexBuffer(commandBuffer, meshArena.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			}
+			pBoundGeometry = pGeometry;
+			geometryBound = true;
+			++pStatistics->vertexBufferBindCount;
+		}
+
+		if(indirect)
+		{
+			if(!earlyPass)
+			{
+				// With GPU culling, the compute passes count the visible instances and pack their transforms from firstInstance on
+				if(culling.enabled)
+				{
+					const FrSphere* const pBounds = &meshArena.meshes.data[pObject->meshIndex].bounds;
+					for(uint32_t instanceIndex = 0; instanceIndex < batchInstanceCount; ++instanceIndex)
+					{
+						pCullInstances[cullInstanceCount++] = (FrCullInstance){
+							.bounds = *pBounds,
+							.command = indirectCount,
+							.transform = firstInstance + instanceIndex,
+							.object = drawList.data[packetIndex + instanceIndex].objectIndex,
+							.flags = occlusionTested ? FR_CULL_INSTANCE_OCCLUSION_BIT : 0
+						};
+					}
+				}
+				const VkDrawIndexedIndirectCommand command = {
+					.indexCount = pObject->indexCount,
+					.instanceCount = culling.enabled ? 0 : batchInstanceCount,
+					.firstIndex = pObject->firstIndex,
+					.vertexOffset = pObject->vertexOffset,
+					.firstInstance = firstInstance
+				};
+				if(lateCommandOffset)
+				{
+					indirectCommands[indirectCount] = command;
+				}
+				indirectCommands[lateCommandOffset + indirectCount] = command;
+				indirectCommands[lateCommandOffset + indirectCount].firstInstance += lateCommandOffset;
+				++pStatistics->indirectCommandCount;
+				pStatistics->instanceCount += batchInstanceCount;
+			}
+			++indirectCount;
+		}
+		else if(pGeometry)
+		{
+			vkCmdDrawIndexed(commandBuffer, pGeometry->indexCount, pGeometry->instanceCount, 0, 0, 0);
+			pStatistics->instanceCount += pGeometry->instanceCount;
+			++pStatistics->drawCount;
+		}
+		else
+		{
+			vkCmdDrawIndexed(commandBuffer, pObject->indexCount, batchInstanceCount, pObject->firstIndex, pObject->vertexOffset, firstInstance);
+			pStatistics->instanceCount += batchInstanceCount;
+			++pStatistics->drawCount;
+		}
+
+		packetIndex = batchEnd;
+	}
+	if(indirectCount != runStart)
+	{
+		frRecordIndirectDraws(commandBuffer, commandOffset + runStart, indirectCount - runStart, pStatistics);
+	}
+
+	return cullInstanceCount - pRange->cullInstanceOffset;
+}
+
+/*
+ * Record the range of a recorder into its secondary command buffers of the current frame slot.
+ *
+ * Parameters:
+ * - pRecorder: The recorder, its statistics and culled instance count are overwritten.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+static FrResult frRecordDrawRange(FrRecorder* pRecorder)
+{
+	// The frame that last used the slot has completed
+	if(vkResetCommandPool(device, pRecorder->commandPools[frameInFlightIndex], 0) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	pRecorder->statistics = (FrDrawStatistics){0};
+	// The early render pass is only recorded with occlusion culling
+	for(uint32_t passIndex = recording.occlusion ? 0 : 1; passIndex < 2; ++passIndex)
+	{
+		const bool earlyPass = passIndex == 0;
+		const VkCommandBuffer commandBuffer = earlyPass ? pRecorder->earlyCommandBuffers[frameInFlightIndex] : pRecorder->commandBuffers[frameInFlightIndex];
+
+		const VkCommandBufferInheritanceInfo inheritanceInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.renderPass = earlyPass ? earlyRenderPass : renderPass,
+			.subpass = 0,
+			.framebuffer = framebuffers[swapchainImageIndex]
+		};
+		const VkCommandBufferBeginInfo beginInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+			.pInheritanceInfo = &inheritanceInfo
+		};
+		if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		frSetViewport(commandBuffer);
+		const uint32_t cullInstanceCount = frRecordSceneDraws(commandBuffer, earlyPass, &pRecorder->range, recording.lateCommandOffset, recording.pCullInstances, &pRecorder->statistics);
+		if(!earlyPass)
+		{
+			pRecorder->cullInstanceCount = cullInstanceCount;
+		}
+
+		if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Job recording the range of a recorder.
+ *
+ * Parameters:
+ * - pRecorderVoid: The recorder, its result is overwritten.
+ */
+static void frRecordDrawRangeJob(void* pRecorderVoid)
+{
+	FrRecorder* const pRecorder = pRecorderVoid;
+	pRecorder->result = frRecordDrawRange(pRecorder);
+}
+
+/*
+ * Make sure the visibility buffer has an entry per object.
+ * A new buffer is cleared by the current command buffer, so every object is first tested by the late phase.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if the previous buffer could not be retired.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frReserveVisibilityBuffer(void)
+{
+	if(culling.visibilityBuffer != VK_NULL_HANDLE && culling.visibilityCapacity >= frObjects.size)
+	{
+		return FR_SUCCESS;
+	}
+
+	uint32_t capacity = culling.visibilityCapacity ? culling.visibilityCapacity : 64;
+	while(capacity < frObjects.size)
+	{
+		capacity *= 2;
+	}
+
+	// The frames in flight may still use the previous buffer
+	if(culling.visibilityBuffer != VK_NULL_HANDLE)
+	{
+		const FrRetiredResource resources[] = {
+			{.type = FR_RETIRED_RESOURCE_BUFFER, .buffer = culling.visibilityBuffer},
+			{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = culling.visibilityBufferMemory}
+		};
+		if(frRetireResources(FR_LEN(resources), resources) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		culling.visibilityBuffer = VK_NULL_HANDLE;
+		culling.visibilityBufferMemory = VK_NULL_HANDLE;
+		culling.visibilityCapacity = 0;
+	}
+
+	if(frCreateBuffer(
+		capacity * sizeof(uint32_t),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&culling.visibilityBuffer,
+		&culling.visibilityBufferMemory
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	culling.visibilityCapacity = capacity;
+
+	vkCmdFillBuffer(commandBuffers[frameInFlightIndex], culling.visibilityBuffer, 0, VK_WHOLE_SIZE, 0);
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Record a culling dispatch and make its results visible to the draws and the next culling phase.
+ *
+ * Parameters:
+ * - pConstants: The push constants, which hold the phase.
+ */
+static void frDispatchCulling(const FrCullConstants* pConstants)
+{
+	uint32_t groupCounts[3];
+	frGetComputeGroupCounts(&culling.pipeline, (const uint32_t[]){pConstants->instanceCount, 1, 1}, groupCounts);
+
+	vkCmdBindPipeline(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_COMPUTE, culling.pipeline.pipeline);
+	vkCmdBindDescriptorSets(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_COMPUTE, culling.pipeline.pipelineLayout, 0, 1, &culling.descriptorSets[frameInFlightIndex], 0, NULL);
+	vkCmdPushConstants(commandBuffers[frameInFlightIndex], culling.pipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(*pConstants), pConstants);
+	vkCmdDispatch(commandBuffers[frameInFlightIndex], groupCounts[0], groupCounts[1], groupCounts[2]);
+
+	frRecordMemoryBarrier(
+		commandBuffers[frameInFlightIndex],
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_SHADER_WRITE_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	);
+}
+
+/*
+ * Record the reduction of the depth written by the early render pass into the depth pyramid, one dispatch per level.
+ */
+static void frBuildDepthPyramid(void)
+{
+	vkCmdBindPipeline(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_COMPUTE, culling.pyramidPipeline.pipeline);
+
+	for(uint32_t levelIndex = 0; levelIndex < culling.pyramid.levelCount; ++levelIndex)
+	{
+		const uint32_t width = culling.pyramid.width >> levelIndex ? culling.pyramid.width >> levelIndex : 1;
+		const uint32_t height = culling.pyramid.height >> levelIndex ? culling.pyramid.height >> levelIndex : 1;
+		uint32_t groupCounts[3];
+		frGetComputeGroupCounts(&culling.pyramidPipeline, (const uint32_t[]){width, height, 1}, groupCounts);
+
+		vkCmdBindDescriptorSets(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_COMPUTE, culling.pyramidPipeline.pipelineLayout, 0, 1, &culling.pyramid.descriptorSets[levelIndex], 0, NULL);
+		vkCmdDispatch(commandBuffers[frameInFlightIndex], groupCounts[0], groupCounts[1], groupCounts[2]);
+
+		// The next level, or the late culling phase, reads this one
+		frRecordMemoryBarrier(commandBuffers[frameInFlightIndex], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	}
+}
+
+/*
+ * Get the workgroups of a dispatch, enough to cover its invocations.
+ *
+ * Parameters:
+ * - pPipeline: The compute pipeline, which gives the local size.
+ * - invocationCounts: The number of invocations in each dimension.
+ * - groupCounts: The number of workgroups in each dimension.
+ */
+static void frGetComputeGroupCounts(const FrComputePipeline* pPipeline, const uint32_t invocationCounts[3], uint32_t groupCounts[3])
+{
+	for(uint32_t i = 0; i < 3; ++i)
+	{
+		// Shaders without a LocalSize mode have a single invocation per group
+		const uint32_t size = pPipeline->localSize[i] ? pPipeline->localSize[i] : 1;
+		groupCounts[i] = invocationCounts[i] / size + (invocationCounts[i] % size != 0);
+	}
+}
+
+/*
+ * Create the bindless set layout, the sets of every frame slot, and the default resources replacing the retired ones.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+static FrResult frCreateBindless(void)
+{
+	const VkDescriptorType types[] = {
+		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+	};
+	VkDescriptorSetLayoutBinding bindings[FR_LEN(types)];
+	VkDescriptorBindingFlags bindingFlags[FR_LEN(types)];
+	VkDescriptorPoolSize poolSizes[FR_LEN(types)];
+	for(uint32_t i = 0; i < FR_LEN(types); ++i)
+	{
+		bindings[i] = (VkDescriptorSetLayoutBinding){
+			.binding = i,
+			.descriptorType = types[i],
+			.descriptorCount = bindless.capacities[i],
+			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
+		};
+		// Resources are written while frames using the set are in flight, and retired ones stay unused
+		bindingFlags[i] =
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+		poolSizes[i] = (VkDescriptorPoolSize){
+			.type = types[i],
+			.descriptorCount = framesInFlight * bindless.capacities[i]
+		};
+	}
+
+	const VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.bindingCount = FR_LEN(bindingFlags),
+		.pBindingFlags = bindingFlags
+	};
+	const VkDescriptorSetLayoutCreateInfo layoutInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = &bindingFlagsInfo,
+		.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		.bindingCount = FR_LEN(bindings),
+		.pBindings = bindings
+	};
+	if(vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &bindless.descriptorSetLayout) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	const VkDescriptorPoolCreateInfo poolInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+		.maxSets = framesInFlight,
+		.poolSizeCount = FR_LEN(poolSizes),
+		.pPoolSizes = poolSizes
+	};
+	if(vkCreateDescriptorPool(device, &poolInfo, NULL, &bindless.descriptorPool) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	VkDescriptorSetLayout layouts[FR_MAX_FRAMES_IN_FLIGHT];
+	for(uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		layouts[i] = bindless.descriptorSetLayout;
+	}
+	const VkDescriptorSetAllocateInfo allocateInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = bindless.descriptorPool,
+		.descriptorSetCount = framesInFlight,
+		.pSetLayouts = layouts
+	};
+	if(vkAllocateDescriptorSets(device, &allocateInfo, bindless.descriptorSets) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// The default resources replace the retired ones in the set
+	if(frCreateBuffer(16, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &bindless.defaultStorageBuffer, &bindless.defaultStorageBufferMemory) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	if(frCreateImage(
+		1,
+		1,
+		1,
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&bindless.defaultImage,
+		&bindless.defaultImageMemory
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	if(frCreateImageView(bindless.defaultImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 1, &bindless.defaultImageView) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// Clear them once, on the graphics queue as transfer queues cannot clear images
+	FrUploadBatch batch;
+	if(frBeginUploadBatch(&batch) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	vkCmdFillBuffer(batch.commandBuffer, bindless.defaultStorageBuffer, 0, VK_WHOLE_SIZE, 0);
+	frRecordImageBarrier(
+		batch.commandBuffer,
+		bindless.defaultImage,
 		1,
-		&createInfo,
-		NULL,
-		&graphicsPipelines.data[graphicsPipelines.size - 1].pipeline
-	) != VK_SUCCESS)
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		0,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT
+	);
+	const VkClearColorValue clearColor = {
+		.float32 = {0.f, 0.f, 0.f, 0.f}
+	};
+	const VkImageSubresourceRange clearRange = {
+		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.levelCount = 1,
+		.layerCount = 1
+	};
+	vkCmdClearColorImage(batch.commandBuffer, bindless.defaultImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &clearRange);
+	frRecordImageBarrier(
+		batch.commandBuffer,
+		bindless.defaultImage,
+		1,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_ACCESS_SHADER_READ_BIT
+	);
+	const FrResult uploadResult = frSubmitUploadBatch(&batch) == FR_SUCCESS ? frWaitUploadBatch(&batch) : FR_ERROR_UNKNOWN;
+	frDestroyUploadBatch(&batch);
+	if(uploadResult != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
-	free(attributes);
 
 	#ifndef NDEBUG
 	if(debugExtensionAvailable)
 	{
-		char pipelineName[32];
-		snprintf(pipelineName, sizeof(pipelineName), "Fraus graphics pipeline %zu", graphicsPipelines.size - 1);
-
-		const VkDebugUtilsObjectNameInfoEXT nameInfo = {
+		VkDebugUtilsObjectNameInfoEXT nameInfo = {
 			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-			.objectType = VK_OBJECT_TYPE_PIPELINE,
-			.objectHandle = (uint64_t)graphicsPipelines.data[graphicsPipelines.size - 1].pipeline,
-			.pObjectName = pipelineName
+			.objectType = VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+			.objectHandle = (uint64_t)bindless.descriptorSetLayout,
+			.pObjectName = "Fraus bindless descriptor set layout"
 		};
 		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
 		{
 			return FR_ERROR_UNKNOWN;
 		}
+
+		nameInfo.objectType = VK_OBJECT_TYPE_DESCRIPTOR_POOL;
+		nameInfo.objectHandle = (uint64_t)bindless.descriptorPool;
+		nameInfo.pObjectName = "Fraus bindless descriptor pool";
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		nameInfo.objectType = VK_OBJECT_TYPE_BUFFER;
+		nameInfo.objectHandle = (uint64_t)bindless.defaultStorageBuffer;
+		nameInfo.pObjectName = "Fraus bindless default storage buffer";
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		nameInfo.objectType = VK_OBJECT_TYPE_IMAGE;
+		nameInfo.objectHandle = (uint64_t)bindless.defaultImage;
+		nameInfo.pObjectName = "Fraus bindless default image";
+		if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
 	}
 	#endif
 
-	vkDestroyShaderModule(device, vertexModule, NULL);
-	vkDestroyShaderModule(device, fragmentModule, NULL);
-
 	return FR_SUCCESS;
 }
 
-FrResult frCreateUniformBuffer(VkDeviceSize size)
+void frWriteBindlessDescriptor(VkDescriptorType type, uint32_t resourceIndex)
 {
-	if(frPushBackUniformBufferVector(&uniformBuffers, (FrUniformBuffer){0}) != FR_SUCCESS)
-	{
-		return FR_ERROR_UNKNOWN;
+	const uint32_t binding =
+		type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ? 0 :
+		type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ? 1 :
+		2;
+	if(!bindless.available || resourceIndex >= bindless.capacities[binding])
+	{
+		return;
+	}
+
+	// Retired resources are replaced by the defaults, and the camera uniform buffer 0 is never retired
+	const bool retired = !frIsResourceAlive(type, resourceIndex);
+	VkDescriptorBufferInfo bufferInfos[FR_MAX_FRAMES_IN_FLIGHT];
+	VkDescriptorImageInfo imageInfo;
+	VkWriteDescriptorSet writes[FR_MAX_FRAMES_IN_FLIGHT];
+	for(uint32_t frameIndex = 0; frameIndex < framesInFlight; ++frameIndex)
+	{
+		writes[frameIndex] = (VkWriteDescriptorSet){
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = bindless.descriptorSets[frameIndex],
+			.dstBinding = binding,
+			.dstArrayElement = resourceIndex,
+			.descriptorCount = 1,
+			.descriptorType = type
+		};
+		switch(type)
+		{
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+				// Each frame slot reads its own copy
+				bufferInfos[frameIndex] = (VkDescriptorBufferInfo){
+					.buffer = uniformBuffers.data[retired ? 0 : resourceIndex].buffers[frameIndex],
+					.offset = 0,
+					.range = uniformBuffers.data[retired ? 0 : resourceIndex].buffersSize
+				};
+				writes[frameIndex].pBufferInfo = &bufferInfos[frameIndex];
+				break;
+
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+				bufferInfos[frameIndex] = (VkDescriptorBufferInfo){
+					.buffer = retired ? bindless.defaultStorageBuffer : storageBuffers.data[resourceIndex].buffer,
+					.offset = 0,
+					.range = retired ? VK_WHOLE_SIZE : storageBuffers.data[resourceIndex].bufferSize
+				};
+				writes[frameIndex].pBufferInfo = &bufferInfos[frameIndex];
+				break;
+
+			default:
+				imageInfo = (VkDescriptorImageInfo){
+					.sampler = textureSampler,
+					.imageView = retired ? bindless.defaultImageView : textures.data[resourceIndex].imageView,
+					.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+				};
+				writes[frameIndex].pImageInfo = &imageInfo;
+				break;
+		}
 	}
+	vkUpdateDescriptorSets(device, framesInFlight, writes, 0, NULL);
+}
 
-	uniformBuffers.data[uniformBuffers.size - 1].buffersSize = size;
+bool frIsBindlessAvailable(void)
+{
+	return bindless.available;
+}
 
-	// Create uniform buffers
-	for(uint32_t frameIndex = 0; frameIndex < FR_FRAMES_IN_FLIGHT; ++frameIndex)
+bool frIsResourceAlive(VkDescriptorType type, uint32_t resourceIndex)
+{
+	// Retired slots are zeroed
+	switch(type)
 	{
-		if(frCreateBuffer(
-			size,
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			&uniformBuffers.data[uniformBuffers.size - 1].buffers[frameIndex],
-			&uniformBuffers.data[uniformBuffers.size - 1].bufferMemories[frameIndex]
-		) != FR_SUCCESS)
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			return resourceIndex < uniformBuffers.size && uniformBuffers.data[resourceIndex].buffers[0] != VK_NULL_HANDLE;
+
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			return resourceIndex < storageBuffers.size && storageBuffers.data[resourceIndex].buffer != VK_NULL_HANDLE;
+
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			return resourceIndex < textures.size && textures.data[resourceIndex].imageView != VK_NULL_HANDLE && textures.data[resourceIndex].storage;
+
+		default:
+			return resourceIndex < textures.size && textures.data[resourceIndex].imageView != VK_NULL_HANDLE;
+	}
+}
+
+/*
+ * Check that the resources a dispatch binds exist and are not retired.
+ *
+ * Parameters:
+ * - pPipeline: The compute pipeline of the dispatch.
+ * - bindingIndexes: The index of the resource at each binding.
+ *
+ * Returns:
+ * - Whether every resource can be bound.
+ */
+static bool frAreDispatchResourcesAlive(const FrComputePipeline* pPipeline, const uint32_t* bindingIndexes)
+{
+	for(uint32_t bindingIndex = 0; bindingIndex < pPipeline->descriptorTypeCount; ++bindingIndex)
+	{
+		if(!frIsResourceAlive(pPipeline->descriptorTypes[bindingIndex], bindingIndexes[bindingIndex]))
 		{
-			return FR_ERROR_UNKNOWN;
+			return false;
 		}
+	}
 
-		if(vkMapMemory(device, uniformBuffers.data[uniformBuffers.size - 1].bufferMemories[frameIndex], 0, size, 0, &uniformBuffers.data[uniformBuffers.size - 1].bufferDatas[frameIndex]) != VK_SUCCESS)
+	return true;
+}
+
+FrResult frDispatchCompute(uint32_t pipelineIndex, const uint32_t* bindingIndexes, const uint32_t invocationCounts[3], const void* pushConstants)
+{
+	if(pipelineIndex >= computePipelines.size || !invocationCounts)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	const FrComputePipeline* const pPipeline = &computePipelines.data[pipelineIndex];
+	if((pPipeline->descriptorTypeCount && !bindingIndexes) || (pPipeline->pushConstantSize && !pushConstants))
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+	if(!frAreDispatchResourcesAlive(pPipeline, bindingIndexes))
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	// A storage image is in a single layout during the dispatch, so no other binding may use it
+	for(uint32_t bindingIndex = 0; bindingIndex < pPipeline->descriptorTypeCount; ++bindingIndex)
+	{
+		if(pPipeline->descriptorTypes[bindingIndex] != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
 		{
-			return FR_ERROR_UNKNOWN;
+			continue;
 		}
+		for(uint32_t otherIndex = 0; otherIndex < pPipeline->descriptorTypeCount; ++otherIndex)
+		{
+			if(
+				otherIndex != bindingIndex &&
+				(pPipeline->descriptorTypes[otherIndex] == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE || pPipeline->descriptorTypes[otherIndex] == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) &&
+				bindingIndexes[otherIndex] == bindingIndexes[bindingIndex]
+			)
+			{
+				return FR_ERROR_INVALID_ARGUMENT;
+			}
+		}
+	}
+
+	// A frame records at most this many dispatches, so more would pile up over the next frames
+	if(computeDispatches.queued.size >= FR_MAX_DISPATCHES_PER_FRAME)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	FrComputeDispatch dispatch = {.pipelineIndex = pipelineIndex};
+	for(uint32_t bindingIndex = 0; bindingIndex < pPipeline->descriptorTypeCount; ++bindingIndex)
+	{
+		dispatch.bindingIndexes[bindingIndex] = bindingIndexes[bindingIndex];
+	}
+	frGetComputeGroupCounts(pPipeline, invocationCounts, dispatch.groupCounts);
+	if(pPipeline->pushConstantSize)
+	{
+		memcpy(dispatch.pushConstants, pushConstants, pPipeline->pushConstantSize);
+	}
+
+	if(frPushBackComputeDispatchVector(&computeDispatches.queued, dispatch) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
 	}
 
 	return FR_SUCCESS;
 }
 
-FrResult frCreateStorageBuffer(VkDeviceSize size)
+FrResult frComputeBarrier(void)
 {
-	if(frPushBackStorageBufferVector(&storageBuffers, (FrStorageBuffer){0}) != FR_SUCCESS)
+	if(!computeDispatches.queued.size)
 	{
-		return FR_ERROR_UNKNOWN;
+		return FR_ERROR_INVALID_ARGUMENT;
 	}
 
-	storageBuffers.data[storageBuffers.size - 1].bufferSize = size;
+	computeDispatches.queued.data[computeDispatches.queued.size - 1].barrier = true;
 
-	// Create storage buffer
-	if(frCreateBuffer(
-		size,
-		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		&storageBuffers.data[storageBuffers.size - 1].buffer,
-		&storageBuffers.data[storageBuffers.size - 1].bufferMemory
-	) != FR_SUCCESS)
+	return FR_SUCCESS;
+}
+
+/*
+ * Move the queued dispatches after the ones the next frame records.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed, in which case the dispatches stay queued.
+ */
+static FrResult frCaptureComputeDispatches(void)
+{
+	for(size_t dispatchIndex = 0; dispatchIndex < computeDispatches.queued.size; ++dispatchIndex)
 	{
-		return FR_ERROR_UNKNOWN;
+		if(frPushBackComputeDispatchVector(&computeDispatches.captured, computeDispatches.queued.data[dispatchIndex]) != FR_SUCCESS)
+		{
+			// Keep the ones not captured yet
+			memmove(computeDispatches.queued.data, computeDispatches.queued.data + dispatchIndex, (computeDispatches.queued.size - dispatchIndex) * sizeof(computeDispatches.queued.data[0]));
+			computeDispatches.queued.size -= dispatchIndex;
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
 	}
+	computeDispatches.queued.size = 0;
 
 	return FR_SUCCESS;
 }
 
-FrResult frSetStorageBufferData(uint32_t storageBufferIndex, const void* data, VkDeviceSize size)
+/*
+ * Move the storage images of a dispatch between the layout they are sampled in and the general layout they are written in.
+ *
+ * Parameters:
+ * - pPipeline: The compute pipeline of the dispatch.
+ * - bindingIndexes: The index of the resource at each binding.
+ * - write: Whether the dispatch is about to write them, otherwise it wrote them.
+ */
+static void frRecordStorageImageBarriers(const FrComputePipeline* pPipeline, const uint32_t* bindingIndexes, bool write)
 {
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	if(frCreateBuffer(
-		size,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		&stagingBuffer,
-		&stagingBufferMemory
-	) != FR_SUCCESS)
+	const VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	for(uint32_t bindingIndex = 0; bindingIndex < pPipeline->descriptorTypeCount; ++bindingIndex)
 	{
-		return FR_ERROR_UNKNOWN;
+		if(pPipeline->descriptorTypes[bindingIndex] != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+		{
+			continue;
+		}
+
+		frRecordImageBarrier(
+			commandBuffers[frameInFlightIndex],
+			textures.data[bindingIndexes[bindingIndex]].image,
+			1,
+			write ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL,
+			write ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			write ? shaderStages : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			write ? 0 : VK_ACCESS_SHADER_WRITE_BIT,
+			write ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : shaderStages,
+			write ? VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT
+		);
 	}
+}
 
-	void* mappedData;
-	if(vkMapMemory(device, stagingBufferMemory, 0, size, 0, &mappedData) != VK_SUCCESS)
+/*
+ * Record the captured dispatches, up to FR_MAX_DISPATCHES_PER_FRAME, and make their writes visible to the scene.
+ * Their descriptor sets come from the linear allocator of the frame slot, and the ones binding a resource retired since they were queued are skipped.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_UNKNOWN if some error occured.
+ */
+static FrResult frRecordComputeDispatches(void)
+{
+	if(!computeDispatches.captured.size)
 	{
-		vkDestroyBuffer(device, stagingBuffer, NULL);
-		vkFreeMemory(device, stagingBufferMemory, NULL);
-		return FR_ERROR_UNKNOWN;
+		return FR_SUCCESS;
 	}
-	memcpy(mappedData, data, size);
-	vkUnmapMemory(device, stagingBufferMemory);
 
-	if(frCopyBuffer(stagingBuffer, storageBuffers.data[storageBufferIndex].buffer, size) != FR_SUCCESS)
+	const size_t dispatchCount = computeDispatches.captured.size < FR_MAX_DISPATCHES_PER_FRAME ? computeDispatches.captured.size : FR_MAX_DISPATCHES_PER_FRAME;
+	const VkCommandBuffer commandBuffer = commandBuffers[frameInFlightIndex];
+
+	// The dispatches may write what the previous frame still reads or writes
+	frRecordMemoryBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_ACCESS_SHADER_WRITE_BIT,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	);
+
+	for(size_t dispatchIndex = 0; dispatchIndex < dispatchCount; ++dispatchIndex)
 	{
-		vkDestroyBuffer(device, stagingBuffer, NULL);
-		vkFreeMemory(device, stagingBufferMemory, NULL);
-		return FR_ERROR_UNKNOWN;
+		const FrComputeDispatch* const pDispatch = &computeDispatches.captured.data[dispatchIndex];
+		const FrComputePipeline* const pPipeline = &computePipelines.data[pDispatch->pipelineIndex];
+
+		if(dispatchIndex && computeDispatches.captured.data[dispatchIndex - 1].barrier)
+		{
+			frRecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+		}
+
+		// A resource retired since the dispatch was queued cannot be bound anymore
+		if(!frAreDispatchResourcesAlive(pPipeline, pDispatch->bindingIndexes))
+		{
+			continue;
+		}
+
+		VkDescriptorSet descriptorSet;
+		if(frAllocateDescriptorSets(&frameDescriptorAllocators[frameInFlightIndex], 1, &pPipeline->descriptorSetLayout, &descriptorSet) != FR_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		VkDescriptorBufferInfo bufferInfos[FR_MAX_DISPATCH_BINDINGS];
+		VkDescriptorImageInfo imageInfos[FR_MAX_DISPATCH_BINDINGS];
+		VkWriteDescriptorSet writes[FR_MAX_DISPATCH_BINDINGS];
+		for(uint32_t bindingIndex = 0; bindingIndex < pPipeline->descriptorTypeCount; ++bindingIndex)
+		{
+			const uint32_t resourceIndex = pDispatch->bindingIndexes[bindingIndex];
+			writes[bindingIndex] = (VkWriteDescriptorSet){
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = descriptorSet,
+				.dstBinding = bindingIndex,
+				.descriptorCount = 1,
+				.descriptorType = pPipeline->descriptorTypes[bindingIndex]
+			};
+			switch(pPipeline->descriptorTypes[bindingIndex])
+			{
+				case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+					bufferInfos[bindingIndex] = (VkDescriptorBufferInfo){
+						.buffer = uniformBuffers.data[resourceIndex].buffers[frameInFlightIndex],
+						.range = uniformBuffers.data[resourceIndex].buffersSize
+					};
+					writes[bindingIndex].pBufferInfo = &bufferInfos[bindingIndex];
+					break;
+
+				case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+					bufferInfos[bindingIndex] = (VkDescriptorBufferInfo){
+						.buffer = storageBuffers.data[resourceIndex].buffer,
+						.range = storageBuffers.data[resourceIndex].bufferSize
+					};
+					writes[bindingIndex].pBufferInfo = &bufferInfos[bindingIndex];
+					break;
+
+				case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+					imageInfos[bindingIndex] = (VkDescriptorImageInfo){
+						.imageView = textures.data[resourceIndex].imageView,
+						.imageLayout = VK_IMAGE_LAYOUT_GENERAL
+					};
+					writes[bindingIndex].pImageInfo = &imageInfos[bindingIndex];
+					break;
+
+				default:
+					imageInfos[bindingIndex] = (VkDescriptorImageInfo){
+						.sampler = textureSampler,
+						.imageView = textures.data[resourceIndex].imageView,
+						.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+					};
+					writes[bindingIndex].pImageInfo = &imageInfos[bindingIndex];
+					break;
+			}
+		}
+		vkUpdateDescriptorSets(device, pPipeline->descriptorTypeCount, writes, 0, NULL);
+
+		// Storage images are written in the general layout, after the shaders sampling them are done
+		frRecordStorageImageBarriers(pPipeline, pDispatch->bindingIndexes, true);
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pPipeline->pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pPipeline->pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+		if(pPipeline->pushConstantSize)
+		{
+			vkCmdPushConstants(commandBuffer, pPipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pPipeline->pushConstantSize, pDispatch->pushConstants);
+		}
+		vkCmdDispatch(commandBuffer, pDispatch->groupCounts[0], pDispatch->groupCounts[1], pDispatch->groupCounts[2]);
+
+		// And sampled again in their usual layout, by the scene or the next dispatches
+		frRecordStorageImageBarriers(pPipeline, pDispatch->bindingIndexes, false);
 	}
 
-	vkDestroyBuffer(device, stagingBuffer, NULL);
-	vkFreeMemory(device, stagingBufferMemory, NULL);
+	// The scene, and the culling, may read what the dispatches wrote
+	frRecordMemoryBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_SHADER_WRITE_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	);
+
+	// The others go to the next frames, in order
+	memmove(computeDispatches.captured.data, computeDispatches.captured.data + dispatchCount, (computeDispatches.captured.size - dispatchCount) * sizeof(computeDispatches.captured.data[0]));
+	computeDispatches.captured.size -= dispatchCount;
 
 	return FR_SUCCESS;
 }
 
-static FrResult frCreateSampler(void)
+/*
+ * Make sure a captured state can hold the transforms of a number of objects.
+ *
+ * Parameters:
+ * - pState: The state, its object count is overwritten.
+ * - objectCount: The number of objects.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+static FrResult frReserveFrameState(FrFrameState* pState, uint32_t objectCount)
 {
-	VkPhysicalDeviceFeatures features;
-	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
-	VkPhysicalDeviceProperties properties;
-	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-	const VkSamplerCreateInfo samplerCreateInfo = {
-		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-		.magFilter = VK_FILTER_LINEAR,
-		.minFilter = VK_FILTER_LINEAR,
-		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
-		.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.mipLodBias = 0.f,
-		.anisotropyEnable = features.samplerAnisotropy,
-		.maxAnisotropy = properties.limits.maxSamplerAnisotropy,
-		.compareEnable = VK_FALSE,
-		.compareOp = VK_COMPARE_OP_ALWAYS,
-		.minLod = 0.f,
-		.maxLod = VK_LOD_CLAMP_NONE,
-		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
-		.unnormalizedCoordinates = VK_FALSE
-	};
-	if(vkCreateSampler(device, &samplerCreateInfo, NULL, &textureSampler) != VK_SUCCESS)
+	if(pState->transformCapacity < objectCount)
 	{
-		return FR_ERROR_UNKNOWN;
+		// frObjects grows geometrically, so does the state
+		const size_t capacity = frObjects.capacity > objectCount ? frObjects.capacity : objectCount;
+		float (*const newTransforms)[16] = realloc(pState->transforms, capacity * sizeof(newTransforms[0]));
+		if(!newTransforms)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		pState->transforms = newTransforms;
+		pState->transformCapacity = capacity;
 	}
+	pState->objectCount = objectCount;
 
 	return FR_SUCCESS;
 }
 
-static FrResult frCreateColorImage(void)
+/*
+ * Copy the camera and the object transforms into a captured state.
+ *
+ * Parameters:
+ * - pState: The state.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ */
+static FrResult frCaptureState(FrFrameState* pState)
 {
-	if(frCreateImage(swapchainExtent.width, swapchainExtent.height, 1, msaaSamples, swapchainFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &colorImage, &colorImageMemory) != FR_SUCCESS)
+	if(frReserveFrameState(pState, (uint32_t)frObjects.size) != FR_SUCCESS)
 	{
-		return FR_ERROR_UNKNOWN;
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
 	}
-	if(frCreateImageView(colorImage, swapchainFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, &colorImageView) != FR_SUCCESS)
+
+	pState->camera = camera;
+	for(uint32_t objectIndex = 0; objectIndex < pState->objectCount; ++objectIndex)
 	{
-		vkDestroyImage(device, colorImage, NULL);
-		vkFreeMemory(device, colorImageMemory, NULL);
-		return FR_ERROR_UNKNOWN;
+		memcpy(pState->transforms[objectIndex], frObjects.data[objectIndex].transformation, sizeof(pState->transforms[objectIndex]));
 	}
 
 	return FR_SUCCESS;
 }
 
-static FrResult frCreateDepthImage(void)
+FrResult frCaptureFrameState(void)
 {
-	VkFormatProperties properties;
-	vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_D24_UNORM_S8_UINT, &properties);
-	if(!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT))
+	if(frCaptureComputeDispatches() != FR_SUCCESS)
 	{
-		return FR_ERROR_UNKNOWN;
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
 	}
 
-	if(frCreateImage(
-		swapchainExtent.width,
-		swapchainExtent.height,
-		1,
-		msaaSamples,
-		VK_FORMAT_D24_UNORM_S8_UINT,
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		&depthImage,
-		&depthImageMemory
-	) != FR_SUCCESS)
+	return frCaptureState(&frameState);
+}
+
+FrResult frCaptureFrameStep(void)
+{
+	// The older state is overwritten
+	const uint32_t stateIndex = frameSteps.count ? frameSteps.latestIndex ^ 1 : 0;
+	if(frCaptureState(&frameSteps.states[stateIndex]) != FR_SUCCESS)
 	{
-		return FR_ERROR_UNKNOWN;
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
 	}
-
-	if(frCreateImageView(depthImage, VK_FORMAT_D24_UNORM_S8_UINT, VK_IMAGE_ASPECT_DEPTH_BIT, 1, &depthImageView) != FR_SUCCESS)
+	frameSteps.latestIndex = stateIndex;
+	if(frameSteps.count < 2)
 	{
-		vkDestroyImage(device, depthImage, NULL);
-		vkFreeMemory(device, depthImageMemory, NULL);
-		return FR_ERROR_UNKNOWN;
+		++frameSteps.count;
 	}
 
 	return FR_SUCCESS;
 }
 
-static FrResult frCreateCommandPools(void)
+FrResult frInterpolateFrameState(float alpha)
 {
-	frameInFlightIndex = 0;
+	if(frCaptureComputeDispatches() != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
 
-	for(uint32_t i = 0; i < FR_FRAMES_IN_FLIGHT; ++i)
+	if(!frameSteps.count)
 	{
-		const VkCommandPoolCreateInfo createInfo = {
-			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-			.queueFamilyIndex = queueFamily
-		};
-		if(vkCreateCommandPool(device, &createInfo, NULL, &commandPools[i]) != VK_SUCCESS)
-		{
-			return FR_ERROR_UNKNOWN;
-		}
+		return frCaptureState(&frameState);
+	}
 
-		#ifndef NDEBUG
-		if(debugExtensionAvailable)
-		{
-			char commandPoolName[32];
-			snprintf(commandPoolName, sizeof(commandPoolName), "Fraus command pool %"PRIu32, i);
+	const FrFrameState* const pLatest = &frameSteps.states[frameSteps.latestIndex];
+	const FrFrameState* const pPrevious = frameSteps.count > 1 ? &frameSteps.states[frameSteps.latestIndex ^ 1] : pLatest;
+	if(frReserveFrameState(&frameState, pLatest->objectCount) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
 
-			const VkDebugUtilsObjectNameInfoEXT nameInfo = {
-				.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-				.objectType = VK_OBJECT_TYPE_COMMAND_POOL,
-				.objectHandle = (uint64_t)commandPools[i],
-				.pObjectName = commandPoolName
-			};
-			if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
-			{
-				return FR_ERROR_UNKNOWN;
-			}
-		}
-		#endif
+	frameState.camera = pLatest->camera;
+	frameState.camera.position.x = pPrevious->camera.position.x + (pLatest->camera.position.x - pPrevious->camera.position.x) * alpha;
+	frameState.camera.position.y = pPrevious->camera.position.y + (pLatest->camera.position.y - pPrevious->camera.position.y) * alpha;
+	frameState.camera.position.z = pPrevious->camera.position.z + (pLatest->camera.position.z - pPrevious->camera.position.z) * alpha;
+	frameState.camera.pitch = pPrevious->camera.pitch + (pLatest->camera.pitch - pPrevious->camera.pitch) * alpha;
+	// The yaw wraps around, it is blended along the shortest arc
+	float yawDelta = pLatest->camera.yaw - pPrevious->camera.yaw;
+	yawDelta = yawDelta > PI ? yawDelta - 2.f * PI : yawDelta < -PI ? yawDelta + 2.f * PI : yawDelta;
+	frameState.camera.yaw = pPrevious->camera.yaw + yawDelta * alpha;
 
-		const VkCommandBufferAllocateInfo allocateInfo = {
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-			.commandPool = commandPools[i],
-			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-			.commandBufferCount = 1
-		};
-		if(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffers[i]) != VK_SUCCESS)
+	for(uint32_t objectIndex = 0; objectIndex < frameState.objectCount; ++objectIndex)
+	{
+		// Objects created by the last step have nothing to blend with
+		if(objectIndex >= pPrevious->objectCount)
 		{
-			return FR_ERROR_UNKNOWN;
+			memcpy(frameState.transforms[objectIndex], pLatest->transforms[objectIndex], sizeof(frameState.transforms[objectIndex]));
+			continue;
 		}
 
-		#ifndef NDEBUG
-		if(debugExtensionAvailable)
+		for(uint32_t i = 0; i < 16; ++i)
 		{
-			char commandBufferName[32];
-			snprintf(commandBufferName, sizeof(commandBufferName), "Fraus command buffer %"PRIu32, i);
-
-			const VkDebugUtilsObjectNameInfoEXT nameInfo = {
-				.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-				.objectType = VK_OBJECT_TYPE_COMMAND_BUFFER,
-				.objectHandle = (uint64_t)commandBuffers[i],
-				.pObjectName = commandBufferName
-			};
-			if(vkSetDebugUtilsObjectNameEXT(device, &nameInfo) != VK_SUCCESS)
-			{
-				return FR_ERROR_UNKNOWN;
-			}
+			frameState.transforms[objectIndex][i] = pPrevious->transforms[objectIndex][i] + (pLatest->transforms[objectIndex][i] - pPrevious->transforms[objectIndex][i]) * alpha;
 		}
-		#endif
+	}
 
-		const VkSemaphoreCreateInfo semaphoreCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
-		};
-		const VkFenceCreateInfo fenceCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-			.flags = VK_FENCE_CREATE_SIGNALED_BIT
+	return FR_SUCCESS;
+}
+
+FrResult frDrawFrame(void)
+{
+	// Wait for the frame that last used this frame slot
+	// Nothing is reset, so returning early below leaves the slot ready for the next call
+	if(frameCounter >= framesInFlight)
+	{
+		const uint64_t waitValue = frameCounter + 1 - framesInFlight;
+		const VkSemaphoreWaitInfo waitInfo = {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &frameTimelineSemaphore,
+			.pValues = &waitValue
 		};
-		if(vkCreateSemaphore(device, &semaphoreCreateInfo, NULL, &imageAvailableSemaphores[i]) != VK_SUCCESS)
-		{
-			return FR_ERROR_UNKNOWN;
-		}
-		if(vkCreateSemaphore(device, &semaphoreCreateInfo, NULL, &renderFinishedSemaphores[i]) != VK_SUCCESS)
+		if(vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
 		{
 			return FR_ERROR_UNKNOWN;
 		}
-		if(vkCreateFence(device, &fenceCreateInfo, NULL, &frameInFlightFences[i]) != VK_SUCCESS)
+	}
+
+	// Destroy the resources retired before the frames that completed
+	if(retiredResources.size)
+	{
+		uint64_t completedFrame;
+		if(frGetCompletedFrame(&completedFrame) != FR_SUCCESS)
 		{
 			return FR_ERROR_UNKNOWN;
 		}
+		frDestroyRetiredResources(completedFrame);
 	}
 
-	return FR_SUCCESS;
-}
+	frPublishPipelines(false);
 
-FrResult frDrawFrame(void)
-{
-	// Wait for fence
-	if(vkWaitForFences(device, 1, &frameInFlightFences[frameInFlightIndex], VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+	// The slot's post-process descriptor set is no longer in use, point it to the current scene image
+	if(postProcess.enabled && postProcess.descriptorSetsOutdated[frameInFlightIndex])
 	{
-		return FR_ERROR_UNKNOWN;
-	}
-	if(vkResetFences(device, 1, &frameInFlightFences[frameInFlightIndex]) != VK_SUCCESS)
-	{
-		return FR_ERROR_UNKNOWN;
+		const VkDescriptorImageInfo imageInfo = {
+			.sampler = postProcess.sampler,
+			.imageView = postProcess.imageView,
+			.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		};
+		const VkWriteDescriptorSet write = {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = postProcess.descriptorSets[frameInFlightIndex],
+			.dstBinding = 0,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.pImageInfo = &imageInfo
+		};
+		vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+		postProcess.descriptorSetsOutdated[frameInFlightIndex] = false;
 	}
 
 	// Acquire image
@@ -2140,6 +5642,12 @@ FrResult frDrawFrame(void)
 		return FR_ERROR_UNKNOWN;
 	}
 
+	// The transient descriptor sets of the slot are no longer in use
+	if(frResetDescriptorAllocator(&frameDescriptorAllocators[frameInFlightIndex]) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
 	// Begin command buffer and render pass
 	const VkCommandBufferBeginInfo beginInfo = {
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -2150,6 +5658,12 @@ FrResult frDrawFrame(void)
 		return FR_ERROR_UNKNOWN;
 	}
 
+	// The compute dispatches come first, so that the scene sees their results
+	if(frRecordComputeDispatches() != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
 	const VkClearValue clearColor = {
 		.color.float32 = {0.f, 0.f, 0.f, 0.f}
 	};
@@ -2169,86 +5683,271 @@ FrResult frDrawFrame(void)
 		.clearValueCount = FR_LEN(clearValues),
 		.pClearValues = clearValues
 	};
-	vkCmdBeginRenderPass(commandBuffers[frameInFlightIndex], &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
 
 	// Update camera
 	float cameraMatrix[16];
-	frGetCameraMatrix(cameraMatrix);
+	frComputeCameraMatrix(&frameState.camera, cameraMatrix);
 	memcpy(uniformBuffers.data[0].bufferDatas[frameInFlightIndex], cameraMatrix, sizeof(cameraMatrix));
+	FrFrustum frustum;
+	frExtractFrustum(cameraMatrix, &frustum);
 
-	const VkViewport viewport = {
-		.x = 0.f,
-		.y = 0.f,
-		.width = (float)swapchainExtent.width,
-		.height = (float)swapchainExtent.height,
-		.minDepth = 0.f,
-		.maxDepth = 1.f
-	};
-	vkCmdSetViewport(commandBuffers[frameInFlightIndex], 0, 1, &viewport);
+	// Build the draw list, the buffers it fills are written while recording the draws
+	FrDrawStatistics statistics = {0};
+	uint32_t gpuCullCount;
+	if(frBuildDrawList(&frustum, &statistics.culledCount, &gpuCullCount) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
 
-	const VkRect2D scissor = {
-		.offset = {0, 0},
-		.extent = swapchainExtent
-	};
-	vkCmdSetScissor(commandBuffers[frameInFlightIndex], 0, 1, &scissor);
+	// With occlusion culling, the early commands and visible transforms are followed by the late ones
+	const bool occlusion = frIsOcclusionCullingActive();
+	const uint32_t lateCommandOffset = occlusion ? (uint32_t)drawList.size : 0;
+	const size_t commandCount = drawList.size + lateCommandOffset;
+	if(
+		drawList.size &&
+		(
+			frReserveFrameBuffer(&transformBuffer, drawList.size * FR_INSTANCE_TRANSFORM_SIZE) != FR_SUCCESS ||
+			frReserveFrameBuffer(&indirectBuffer, commandCount * sizeof(VkDrawIndexedIndirectCommand)) != FR_SUCCESS ||
+			(
+				culling.enabled &&
+				frReserveFrameBuffer(&culling.visibleTransformBuffer, commandCount * FR_INSTANCE_TRANSFORM_SIZE) != FR_SUCCESS
+			)
+		)
+	)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
 
-	const VkDeviceSize offsets[] = {0};
-	static uint32_t lastPipelineIndex = UINT32_MAX;
-	const uint32_t ordering[] = {2, 0, 1, 3, 4};
-	for(uint32_t objectIndex = 0; objectIndex < frObjects.size - 1; ++objectIndex)
+	// Cull the indirect instances before the render passes read their commands and transforms
+	FrCullInstance* cullInstances = NULL;
+	if(gpuCullCount)
 	{
-		const FrVulkanObject* const pObject = &frObjects.data[ordering[objectIndex]];
+		if(
+			frReserveFrameBuffer(&culling.instanceBuffer, gpuCullCount * sizeof(FrCullInstance)) != FR_SUCCESS ||
+			frReserveVisibilityBuffer() != FR_SUCCESS
+		)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+		cullInstances = culling.instanceBuffer.bufferDatas[frameInFlightIndex];
+
+		// The buffers may have been recreated since the slot's set was last written
+		const VkDescriptorBufferInfo bufferInfos[] = {
+			{.buffer = culling.instanceBuffer.buffers[frameInFlightIndex], .range = VK_WHOLE_SIZE},
+			{.buffer = transformBuffer.buffers[frameInFlightIndex], .range = VK_WHOLE_SIZE},
+			{.buffer = culling.visibleTransformBuffer.buffers[frameInFlightIndex], .range = VK_WHOLE_SIZE},
+			{.buffer = indirectBuffer.buffers[frameInFlightIndex], .range = VK_WHOLE_SIZE},
+			{.buffer = culling.visibilityBuffer, .range = VK_WHOLE_SIZE},
+			{.buffer = uniformBuffers.data[0].buffers[frameInFlightIndex], .range = VK_WHOLE_SIZE}
+		};
+		const VkDescriptorImageInfo pyramidInfo = {
+			.sampler = culling.pyramidSampler,
+			.imageView = culling.pyramid.imageView,
+			.imageLayout = VK_IMAGE_LAYOUT_GENERAL
+		};
+		VkWriteDescriptorSet writes[FR_LEN(bufferInfos) + 1];
+		for(uint32_t bindingIndex = 0; bindingIndex < FR_LEN(writes); ++bindingIndex)
+		{
+			writes[bindingIndex] = (VkWriteDescriptorSet){
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = culling.descriptorSets[frameInFlightIndex],
+				.dstBinding = bindingIndex,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.pBufferInfo = &bufferInfos[bindingIndex < 5 ? bindingIndex : bindingIndex - 1]
+			};
+		}
+		writes[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writes[5].pBufferInfo = NULL;
+		writes[5].pImageInfo = &pyramidInfo;
+		writes[6].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		vkUpdateDescriptorSets(device, FR_LEN(writes), writes, 0, NULL);
+
+		// The previous frame's visibility and the clear of a new visibility buffer come before the culling
+		frRecordMemoryBarrier(
+			commandBuffers[frameInFlightIndex],
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+		);
+		if(!culling.pyramid.initialized)
+		{
+			frRecordImageBarrier(
+				commandBuffers[frameInFlightIndex],
+				culling.pyramid.image,
+				culling.pyramid.levelCount,
+				VK_IMAGE_LAYOUT_UNDEFINED,
+				VK_IMAGE_LAYOUT_GENERAL,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+			);
+			culling.pyramid.initialized = true;
+		}
+	}
 
-		if(pObject->pipelineIndex != lastPipelineIndex)
+	// Large scenes are split between the recorders, the main thread records the first range
+	FrDrawRange ranges[FR_MAX_RECORDERS] = {{.packetEnd = drawList.size}};
+	const size_t maxRangeCount = drawList.size / FR_MIN_PACKETS_PER_RECORDER;
+	const uint32_t rangeCount = maxRangeCount > 1 && recording.recorderCount > 1 ? frSplitDrawList(maxRangeCount < recording.recorderCount ? (uint32_t)maxRangeCount : recording.recorderCount, ranges) : 1;
+	statistics.recorderCount = rangeCount;
+	if(rangeCount > 1)
+	{
+		recording.occlusion = occlusion;
+		recording.lateCommandOffset = lateCommandOffset;
+		recording.pCullInstances = cullInstances;
+		FrJob jobs[FR_MAX_RECORDERS];
+		for(uint32_t rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
 		{
-			vkCmdBindPipeline(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines.data[pObject->pipelineIndex].pipeline);
-			lastPipelineIndex = pObject->pipelineIndex;
+			recording.recorders[rangeIndex].range = ranges[rangeIndex];
+			jobs[rangeIndex] = (FrJob){
+				.function = frRecordDrawRangeJob,
+				.pData = &recording.recorders[rangeIndex]
+			};
 		}
 
-		vkCmdBindDescriptorSets(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines.data[pObject->pipelineIndex].pipelineLayout, 0, 1, &pObject->descriptorSets[frameInFlightIndex], 0, NULL);
-		if(graphicsPipelines.data[pObject->pipelineIndex].hasPushConstants)
+		// The first range is recorded here while the others are stolen
+		FrJobCounter counter = {0};
+		frRunJobs(rangeCount - 1, jobs + 1, &counter);
+		frRecordDrawRangeJob(&recording.recorders[0]);
+		frFinishJobs(&counter);
+
+		uint32_t cullInstanceCount = 0;
+		for(uint32_t rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
 		{
-			vkCmdPushConstants(commandBuffers[frameInFlightIndex], graphicsPipelines.data[pObject->pipelineIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pObject->transformation), pObject->transformation);
+			const FrRecorder* const pRecorder = &recording.recorders[rangeIndex];
+			if(pRecorder->result != FR_SUCCESS)
+			{
+				return pRecorder->result;
+			}
+			frAddDrawStatistics(&statistics, &pRecorder->statistics);
+			cullInstanceCount += pRecorder->cullInstanceCount;
 		}
+		assert(cullInstanceCount == gpuCullCount);
+		(void)cullInstanceCount;
+	}
+
+	FrCullConstants cullConstants = {
+		.frustum = frustum,
+		.instanceCount = gpuCullCount,
+		.phase = occlusion ? FR_CULL_PHASE_EARLY : FR_CULL_PHASE_FRUSTUM,
+		.lateCommandOffset = lateCommandOffset,
+		.pyramidWidth = culling.pyramid.width,
+		.pyramidHeight = culling.pyramid.height,
+		.pyramidLevelCount = culling.pyramid.levelCount
+	};
+	if(gpuCullCount)
+	{
+		frDispatchCulling(&cullConstants);
+	}
 
-		vkCmdBindVertexBuffers(commandBuffers[frameInFlightIndex], 0, 1, &pObject->buffer, offsets);
-		vkCmdBindIndexBuffer(commandBuffers[frameInFlightIndex], pObject->buffer, pObject->vertexCount * sizeof(pObject->vertices[0]), VK_INDEX_TYPE_UINT32);
+	// Draw the instances visible in the previous frame, build the depth pyramid from them and test the others
+	if(occlusion)
+	{
+		VkRenderPassBeginInfo earlyRenderPassBegin = renderPassBegin;
+		earlyRenderPassBegin.renderPass = earlyRenderPass;
+		if(rangeCount > 1)
+		{
+			VkCommandBuffer secondaryCommandBuffers[FR_MAX_RECORDERS];
+			for(uint32_t rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
+			{
+				secondaryCommandBuffers[rangeIndex] = recording.recorders[rangeIndex].earlyCommandBuffers[frameInFlightIndex];
+			}
+			vkCmdBeginRenderPass(commandBuffers[frameInFlightIndex], &earlyRenderPassBegin, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+			vkCmdExecuteCommands(commandBuffers[frameInFlightIndex], rangeCount, secondaryCommandBuffers);
+		}
+		else
+		{
+			vkCmdBeginRenderPass(commandBuffers[frameInFlightIndex], &earlyRenderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+			frSetViewport(commandBuffers[frameInFlightIndex]);
+			frRecordSceneDraws(commandBuffers[frameInFlightIndex], true, &ranges[0], lateCommandOffset, NULL, &statistics);
+		}
+		vkCmdEndRenderPass(commandBuffers[frameInFlightIndex]);
 
-		vkCmdDrawIndexed(commandBuffers[frameInFlightIndex], pObject->indexCount, 1, 0, 0, 0);
+		if(gpuCullCount)
+		{
+			frBuildDepthPyramid();
+			cullConstants.phase = FR_CULL_PHASE_LATE;
+			frDispatchCulling(&cullConstants);
+		}
 	}
 
-	// Draw text
-	vkCmdBindPipeline(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines.data[2].pipeline);
-	vkCmdBindDescriptorSets(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines.data[2].pipelineLayout, 0, 1, &frObjects.data[5].descriptorSets[frameInFlightIndex], 0, NULL);
-	const VkDeviceSize offsetss[] = {0, 4 * 8 + 2 * 6};
-	const VkBuffer buffers[] = {instanceBuffer, instanceBuffer};
-	vkCmdBindVertexBuffers(commandBuffers[frameInFlightIndex], 0, 2, buffers, offsetss);
-	vkCmdBindIndexBuffer(commandBuffers[frameInFlightIndex], instanceBuffer, 4 * 8, VK_INDEX_TYPE_UINT16);
-	vkCmdDrawIndexed(commandBuffers[frameInFlightIndex], 6, instanceCount, 0, 0, 0);
+	if(rangeCount > 1)
+	{
+		VkCommandBuffer secondaryCommandBuffers[FR_MAX_RECORDERS];
+		for(uint32_t rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
+		{
+			secondaryCommandBuffers[rangeIndex] = recording.recorders[rangeIndex].commandBuffers[frameInFlightIndex];
+		}
+		vkCmdBeginRenderPass(commandBuffers[frameInFlightIndex], &renderPassBegin, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		vkCmdExecuteCommands(commandBuffers[frameInFlightIndex], rangeCount, secondaryCommandBuffers);
+	}
+	else
+	{
+		vkCmdBeginRenderPass(commandBuffers[frameInFlightIndex], &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+		frSetViewport(commandBuffers[frameInFlightIndex]);
+		const uint32_t cullInstanceCount = frRecordSceneDraws(commandBuffers[frameInFlightIndex], false, &ranges[0], lateCommandOffset, cullInstances, &statistics);
+		assert(cullInstanceCount == gpuCullCount);
+		(void)cullInstanceCount;
+	}
+	drawStatistics = statistics;
 
 	// End render pass and command buffer
 	vkCmdEndRenderPass(commandBuffers[frameInFlightIndex]);
 
+	// Post-process anti-aliasing, from the scene image to the swapchain image
+	if(postProcess.enabled)
+	{
+		const VkRenderPassBeginInfo postProcessBegin = {
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+			.renderPass = postProcess.renderPass,
+			.framebuffer = postProcess.framebuffers[swapchainImageIndex],
+			.renderArea.offset = {0, 0},
+			.renderArea.extent = swapchainExtent
+		};
+		vkCmdBeginRenderPass(commandBuffers[frameInFlightIndex], &postProcessBegin, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBindPipeline(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, postProcess.pipeline);
+		frSetViewport(commandBuffers[frameInFlightIndex]);
+		vkCmdBindDescriptorSets(commandBuffers[frameInFlightIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, postProcess.pipelineLayout, 0, 1, &postProcess.descriptorSets[frameInFlightIndex], 0, NULL);
+		vkCmdDraw(commandBuffers[frameInFlightIndex], 3, 1, 0, 0);
+		vkCmdEndRenderPass(commandBuffers[frameInFlightIndex]);
+	}
+
 	if(vkEndCommandBuffer(commandBuffers[frameInFlightIndex]) != VK_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
 
+	// Signal the timeline with this frame's number, binary semaphore values are ignored
+	const uint64_t waitValues[] = {0};
+	const uint64_t signalValues[] = {0, frameCounter + 1};
+	const VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.waitSemaphoreValueCount = FR_LEN(waitValues),
+		.pWaitSemaphoreValues = waitValues,
+		.signalSemaphoreValueCount = FR_LEN(signalValues),
+		.pSignalSemaphoreValues = signalValues
+	};
 	const VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+	const VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[frameInFlightIndex], frameTimelineSemaphore};
 	const VkSubmitInfo submitInfo = {
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineSubmitInfo,
 		.waitSemaphoreCount = 1,
 		.pWaitSemaphores = &imageAvailableSemaphores[frameInFlightIndex],
 		.pWaitDstStageMask = waitStages,
 		.commandBufferCount = 1,
 		.pCommandBuffers = &commandBuffers[frameInFlightIndex],
-		.signalSemaphoreCount = 1,
-		.pSignalSemaphores = &renderFinishedSemaphores[frameInFlightIndex]
+		.signalSemaphoreCount = FR_LEN(signalSemaphores),
+		.pSignalSemaphores = signalSemaphores
 	};
-	if(vkQueueSubmit(queue, 1, &submitInfo, frameInFlightFences[frameInFlightIndex]) != VK_SUCCESS)
+	if(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
+	++frameCounter;
 
 	VkResult presentResult;
 	const VkPresentInfoKHR presentInfo = {
@@ -2270,36 +5969,163 @@ FrResult frDrawFrame(void)
 		return FR_ERROR_UNKNOWN;
 	}
 
-	frameInFlightIndex = (frameInFlightIndex + 1) % FR_FRAMES_IN_FLIGHT;
+	frameInFlightIndex = (uint32_t)(frameCounter % framesInFlight);
 
 	return FR_SUCCESS;
 }
 
-FrResult frRecreateSwapchain(void)
+FrResult frSetPresentMode(FrPresentMode presentMode)
+{
+	if(presentMode > FR_PRESENT_MODE_IMMEDIATE)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	if(presentMode != presentModePreference)
+	{
+		presentModePreference = presentMode;
+
+		// Recreate the swapchain before the next frame
+		windowResized = true;
+	}
+
+	return FR_SUCCESS;
+}
+
+VkPresentModeKHR frGetPresentMode(void)
+{
+	return swapchainPresentMode;
+}
+
+FrResult frSetMsaaSamples(VkSampleCountFlagBits samples)
+{
+	if(!frIsSampleCountValid(samples))
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	if(samples != msaaSamplesPreference)
+	{
+		msaaSamplesPreference = samples;
+
+		// Recreate the render targets before the next frame
+		windowResized = true;
+	}
+
+	return FR_SUCCESS;
+}
+
+VkSampleCountFlagBits frGetMsaaSamples(void)
 {
-	if(vkDeviceWaitIdle(device) != VK_SUCCESS)
+	return msaaSamples;
+}
+
+FrResult frSetPostProcessAntiAliasing(bool enable)
+{
+	if(enable && !postProcess.pipeline)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	if(enable != postProcessPreference)
+	{
+		postProcessPreference = enable;
+
+		// Recreate the render targets before the next frame
+		windowResized = true;
+	}
+
+	return FR_SUCCESS;
+}
+
+FrResult frGetCompletedFrame(uint64_t* pFrame)
+{
+	assert(pFrame != NULL);
+
+	if(vkGetSemaphoreCounterValue(device, frameTimelineSemaphore, pFrame) != VK_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
 
-	const VkSwapchainKHR oldSwapchain = swapchain;
+	return FR_SUCCESS;
+}
+
+void frGetDrawStatistics(FrDrawStatistics* pStatistics)
+{
+	assert(pStatistics != NULL);
+
+	*pStatistics = drawStatistics;
+}
 
+FrResult frRecreateSwapchain(void)
+{
+	// Nothing is destroyed here: the resources in use by frames in flight are retired
+	// and destroyed by frDrawFrame once these frames completed
+	if(frRetireRenderTargets() != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
 	for(uint32_t imageIndex = 0; imageIndex < swapchainImageCount; ++imageIndex)
 	{
-		vkDestroyFramebuffer(device, framebuffers[imageIndex], NULL);
-		vkDestroyImageView(device, swapchainImageViews[imageIndex], NULL);
+		if(frRetireResource((FrRetiredResource){.type = FR_RETIRED_RESOURCE_IMAGE_VIEW, .imageView = swapchainImageViews[imageIndex]}) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
 	}
-	vkDestroyImageView(device, depthImageView, NULL);
-	vkDestroyImage(device, depthImage, NULL);
-	vkFreeMemory(device, depthImageMemory, NULL);
-	vkDestroyImageView(device, colorImageView, NULL);
-	vkDestroyImage(device, colorImage, NULL);
-	vkFreeMemory(device, colorImageMemory, NULL);
 
+	// The old swapchain is passed to the new one so presentation can continue during the transition
+	const VkSwapchainKHR oldSwapchain = swapchain;
 	if(frCreateSwapchain() != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
+	if(frRetireResource((FrRetiredResource){.type = FR_RETIRED_RESOURCE_SWAPCHAIN, .swapchain = oldSwapchain}) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	// Anti-aliasing settings changed, the render pass and the pipelines using it must be rebuilt
+	const VkSampleCountFlagBits samples = frChooseSampleCount(msaaSamplesPreference);
+	if(samples != msaaSamples || postProcessPreference != postProcess.enabled)
+	{
+		// The background builds read both
+		frPublishPipelines(true);
+
+		msaaSamples = samples;
+		postProcess.enabled = postProcessPreference;
+
+		const FrRetiredResource renderPasses[] = {
+			{.type = FR_RETIRED_RESOURCE_RENDER_PASS, .renderPass = renderPass},
+			{.type = FR_RETIRED_RESOURCE_RENDER_PASS, .renderPass = earlyRenderPass}
+		};
+		if(frRetireResources(FR_LEN(renderPasses), renderPasses) != FR_SUCCESS)
+		{
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		if(frCreateRenderPass() != FR_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		for(uint32_t pipelineIndex = 0; pipelineIndex < graphicsPipelines.size; ++pipelineIndex)
+		{
+			FrPipeline* const pPipeline = &graphicsPipelines.data[pipelineIndex];
+			// Failed background build
+			if(pPipeline->pipeline == VK_NULL_HANDLE)
+			{
+				continue;
+			}
+
+			if(frRetireResource((FrRetiredResource){.type = FR_RETIRED_RESOURCE_PIPELINE, .pipeline = pPipeline->pipeline}) != FR_SUCCESS)
+			{
+				return FR_ERROR_OUT_OF_HOST_MEMORY;
+			}
+			if(frBuildGraphicsPipeline(pPipeline, pipelineIndex, &pPipeline->pipeline) != FR_SUCCESS)
+			{
+				return FR_ERROR_UNKNOWN;
+			}
+		}
+	}
 	if(frCreateColorImage() != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
@@ -2308,13 +6134,15 @@ FrResult frRecreateSwapchain(void)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
+	if(culling.enabled && frCreateDepthPyramid() != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
 	if(frCreateFramebuffers() != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
 	}
 
-	vkDestroySwapchainKHR(device, oldSwapchain, NULL);
-
 	windowResized = false;
 
 	return FR_SUCCESS;
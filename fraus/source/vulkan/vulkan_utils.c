@@ -3,10 +3,359 @@
 #include "../../include/fraus/images/images.h"
 #include "./functions.h"
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+FrResult frRetireResource(FrRetiredResource resource)
+{
+	return frRetireResources(1, &resource);
+}
+
+FrResult frRetireResources(uint32_t resourceCount, const FrRetiredResource* pResources)
+{
+	const size_t previousSize = retiredResources.size;
+	for(uint32_t resourceIndex = 0; resourceIndex < resourceCount; ++resourceIndex)
+	{
+		FrRetiredResource resource = pResources[resourceIndex];
+		// Every frame that could use the resource has been submitted
+		resource.frame = frameCounter;
+
+		if(frPushBackRetiredResourceVector(&retiredResources, resource) != FR_SUCCESS)
+		{
+			retiredResources.size = previousSize;
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Destroy a retired resource, or give it back to its owner.
+ *
+ * Parameters:
+ * - pResource: The resource.
+ *
+ * Returns:
+ * - true if the resource is gone.
+ * - false if it must stay retired, when a descriptor set cannot be given back for lack of memory.
+ */
+static bool frDestroyRetiredResource(const FrRetiredResource* pResource)
+{
+	switch(pResource->type)
+	{
+		case FR_RETIRED_RESOURCE_IMAGE:
+			vkDestroyImage(device, pResource->image, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_IMAGE_VIEW:
+			vkDestroyImageView(device, pResource->imageView, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_MEMORY:
+			vkFreeMemory(device, pResource->memory, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_FRAMEBUFFER:
+			vkDestroyFramebuffer(device, pResource->framebuffer, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_RENDER_PASS:
+			vkDestroyRenderPass(device, pResource->renderPass, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_PIPELINE:
+			vkDestroyPipeline(device, pResource->pipeline, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_SWAPCHAIN:
+			vkDestroySwapchainKHR(device, pResource->swapchain, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_BUFFER:
+			vkDestroyBuffer(device, pResource->buffer, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_DESCRIPTOR_POOL:
+			vkDestroyDescriptorPool(device, pResource->descriptorPool, NULL);
+			break;
+		case FR_RETIRED_RESOURCE_DESCRIPTOR_SET:
+			return frPushBackFreeDescriptorSetVector(
+				&pResource->pDescriptorAllocator->freeSets,
+				(FrFreeDescriptorSet){.layout = pResource->descriptorSetLayout, .set = pResource->descriptorSet}
+			) == FR_SUCCESS;
+		case FR_RETIRED_RESOURCE_BINDLESS_DESCRIPTOR:
+			// The slot was zeroed, so it gets the default resource
+			frWriteBindlessDescriptor(pResource->bindlessType, pResource->bindlessIndex);
+			break;
+	}
+
+	return true;
+}
+
+void frDestroyRetiredResources(uint64_t completedFrame)
+{
+	size_t keptCount = 0;
+	for(size_t resourceIndex = 0; resourceIndex < retiredResources.size; ++resourceIndex)
+	{
+		// A set that cannot be given back yet stays retired, and is given back by a later call
+		const FrRetiredResource* const pResource = &retiredResources.data[resourceIndex];
+		if(pResource->frame > completedFrame || !frDestroyRetiredResource(pResource))
+		{
+			retiredResources.data[keptCount] = *pResource;
+			++keptCount;
+		}
+	}
+	retiredResources.size = keptCount;
+}
+
+FrResult frReserveFrameBuffer(FrFrameBuffer* pBuffer, VkDeviceSize size)
+{
+	assert(pBuffer != NULL);
+
+	if(pBuffer->sizes[frameInFlightIndex] >= size)
+	{
+		return FR_SUCCESS;
+	}
+
+	VkDeviceSize newSize = 4096;
+	while(newSize < size)
+	{
+		newSize *= 2;
+	}
+
+	vkDestroyBuffer(device, pBuffer->buffers[frameInFlightIndex], NULL);
+	vkFreeMemory(device, pBuffer->bufferMemories[frameInFlightIndex], NULL);
+	pBuffer->buffers[frameInFlightIndex] = VK_NULL_HANDLE;
+	pBuffer->bufferMemories[frameInFlightIndex] = VK_NULL_HANDLE;
+	pBuffer->bufferDatas[frameInFlightIndex] = NULL;
+	pBuffer->sizes[frameInFlightIndex] = 0;
+
+	if(frCreateBuffer(
+		newSize,
+		pBuffer->usage,
+		pBuffer->deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		&pBuffer->buffers[frameInFlightIndex],
+		&pBuffer->bufferMemories[frameInFlightIndex]
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	if(!pBuffer->deviceLocal && vkMapMemory(device, pBuffer->bufferMemories[frameInFlightIndex], 0, VK_WHOLE_SIZE, 0, &pBuffer->bufferDatas[frameInFlightIndex]) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+	pBuffer->sizes[frameInFlightIndex] = newSize;
+
+	return FR_SUCCESS;
+}
+
+void frDestroyFrameBuffer(FrFrameBuffer* pBuffer)
+{
+	assert(pBuffer != NULL);
+
+	for(uint32_t frameIndex = 0; frameIndex < FR_MAX_FRAMES_IN_FLIGHT; ++frameIndex)
+	{
+		vkDestroyBuffer(device, pBuffer->buffers[frameIndex], NULL);
+		vkFreeMemory(device, pBuffer->bufferMemories[frameIndex], NULL);
+	}
+	*pBuffer = (FrFrameBuffer){0};
+}
+
+FR_DEFINE_VECTOR(VkDescriptorPool, DescriptorPool)
+FR_DEFINE_VECTOR(FrFreeDescriptorSet, FreeDescriptorSet)
+
+/*
+ * Create the next pool of an allocator, twice as large as the previous one up to FR_DESCRIPTOR_POOL_MAX_SETS.
+ *
+ * Parameters:
+ * - pAllocator: The allocator.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frAddDescriptorPool(FrDescriptorAllocator* pAllocator)
+{
+	uint32_t setCount = FR_DESCRIPTOR_POOL_MIN_SETS;
+	for(size_t poolIndex = 0; poolIndex < pAllocator->pools.size && setCount < FR_DESCRIPTOR_POOL_MAX_SETS; ++poolIndex)
+	{
+		setCount *= 2;
+	}
+
+	const VkDescriptorPoolSize poolSizes[] = {
+		{
+			.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+			.descriptorCount = setCount * FR_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET
+		},
+		{
+			.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = setCount * FR_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET
+		},
+		{
+			.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.descriptorCount = setCount * FR_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET
+		},
+		{
+			.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			.descriptorCount = setCount * FR_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET
+		}
+	};
+	const VkDescriptorPoolCreateInfo poolInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.maxSets = setCount,
+		.poolSizeCount = FR_LEN(poolSizes),
+		.pPoolSizes = poolSizes
+	};
+	VkDescriptorPool pool;
+	if(vkCreateDescriptorPool(device, &poolInfo, NULL, &pool) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	if(frPushBackDescriptorPoolVector(&pAllocator->pools, pool) != FR_SUCCESS)
+	{
+		vkDestroyDescriptorPool(device, pool, NULL);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	return FR_SUCCESS;
+}
+
+/*
+ * Allocate a descriptor set from the current pool of an allocator, moving to the next pools when it is full.
+ *
+ * Parameters:
+ * - pAllocator: The allocator.
+ * - layout: The layout of the set.
+ * - pSet: The allocated set.
+ *
+ * Returns:
+ * - FR_SUCCESS if everything went well.
+ * - FR_ERROR_OUT_OF_HOST_MEMORY if a memory allocation failed.
+ * - FR_ERROR_UNKNOWN if some other error occured.
+ */
+static FrResult frAllocateDescriptorSet(FrDescriptorAllocator* pAllocator, VkDescriptorSetLayout layout, VkDescriptorSet* pSet)
+{
+	while(true)
+	{
+		const bool newPool = pAllocator->currentPoolIndex == pAllocator->pools.size;
+		if(newPool)
+		{
+			const FrResult result = frAddDescriptorPool(pAllocator);
+			if(result != FR_SUCCESS)
+			{
+				return result;
+			}
+		}
+
+		const VkDescriptorSetAllocateInfo allocateInfo = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool = pAllocator->pools.data[pAllocator->currentPoolIndex],
+			.descriptorSetCount = 1,
+			.pSetLayouts = &layout
+		};
+		const VkResult result = vkAllocateDescriptorSets(device, &allocateInfo, pSet);
+		if(result == VK_SUCCESS)
+		{
+			return FR_SUCCESS;
+		}
+
+		// A set that does not fit in a new pool never will
+		if((result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) || newPool)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+		++pAllocator->currentPoolIndex;
+	}
+}
+
+FrResult frAllocateDescriptorSets(FrDescriptorAllocator* pAllocator, uint32_t setCount, const VkDescriptorSetLayout* layouts, VkDescriptorSet* pSets)
+{
+	assert(pAllocator != NULL);
+
+	for(uint32_t setIndex = 0; setIndex < setCount; ++setIndex)
+	{
+		// Latest set given back with the same layout
+		size_t freeIndex = pAllocator->freeSets.size;
+		while(freeIndex > 0 && pAllocator->freeSets.data[freeIndex - 1].layout != layouts[setIndex])
+		{
+			--freeIndex;
+		}
+		if(freeIndex > 0)
+		{
+			pSets[setIndex] = pAllocator->freeSets.data[freeIndex - 1].set;
+			pAllocator->freeSets.data[freeIndex - 1] = pAllocator->freeSets.data[pAllocator->freeSets.size - 1];
+			--pAllocator->freeSets.size;
+			continue;
+		}
+
+		const FrResult result = frAllocateDescriptorSet(pAllocator, layouts[setIndex], &pSets[setIndex]);
+		if(result != FR_SUCCESS)
+		{
+			// Keep the sets already allocated for the next allocations
+			for(uint32_t allocatedIndex = 0; allocatedIndex < setIndex; ++allocatedIndex)
+			{
+				frPushBackFreeDescriptorSetVector(&pAllocator->freeSets, (FrFreeDescriptorSet){.layout = layouts[allocatedIndex], .set = pSets[allocatedIndex]});
+			}
+			return result;
+		}
+	}
+
+	return FR_SUCCESS;
+}
+
+FrResult frRetireDescriptorSets(FrDescriptorAllocator* pAllocator, uint32_t setCount, const VkDescriptorSetLayout* layouts, const VkDescriptorSet* pSets)
+{
+	assert(pAllocator != NULL);
+
+	// Queued one by one, and all removed on failure like frRetireResources does
+	const size_t previousSize = retiredResources.size;
+	for(uint32_t setIndex = 0; setIndex < setCount; ++setIndex)
+	{
+		const FrRetiredResource resource = {
+			.type = FR_RETIRED_RESOURCE_DESCRIPTOR_SET,
+			.pDescriptorAllocator = pAllocator,
+			.descriptorSetLayout = layouts[setIndex],
+			.descriptorSet = pSets[setIndex]
+		};
+		if(frRetireResource(resource) != FR_SUCCESS)
+		{
+			retiredResources.size = previousSize;
+			return FR_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+
+	return FR_SUCCESS;
+}
+
+FrResult frResetDescriptorAllocator(FrDescriptorAllocator* pAllocator)
+{
+	assert(pAllocator != NULL);
+
+	// The pools after the current one are still empty
+	for(size_t poolIndex = 0; poolIndex <= pAllocator->currentPoolIndex && poolIndex < pAllocator->pools.size; ++poolIndex)
+	{
+		if(vkResetDescriptorPool(device, pAllocator->pools.data[poolIndex], 0) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	pAllocator->currentPoolIndex = 0;
+	pAllocator->freeSets.size = 0;
+
+	return FR_SUCCESS;
+}
+
+void frDestroyDescriptorAllocator(FrDescriptorAllocator* pAllocator)
+{
+	assert(pAllocator != NULL);
+
+	for(size_t poolIndex = 0; poolIndex < pAllocator->pools.size; ++poolIndex)
+	{
+		vkDestroyDescriptorPool(device, pAllocator->pools.data[poolIndex], NULL);
+	}
+	frDestroyDescriptorPoolVector(&pAllocator->pools);
+	frDestroyFreeDescriptorSetVector(&pAllocator->freeSets);
+	*pAllocator = (FrDescriptorAllocator){0};
+}
+
 FrResult frFindMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t* pIndex)
 {
 	VkPhysicalDeviceMemoryProperties memoryProperties;
@@ -33,17 +382,31 @@ FrResult frFindMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properti
 	return FR_SUCCESS;
 }
 
-FrResult frBeginCommandBuffer(VkCommandBuffer* pCommandBuffer)
+FR_DEFINE_VECTOR(FrStagingBuffer, StagingBuffer)
+
+static FrResult frBeginUploadCommandBuffer(uint32_t family, VkCommandPool* pCommandPool, VkCommandBuffer* pCommandBuffer)
 {
+	// Create command pool
+	const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = family
+	};
+	if(vkCreateCommandPool(device, &commandPoolCreateInfo, NULL, pCommandPool) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
 	// Create command buffer
 	const VkCommandBufferAllocateInfo allocateInfo = {
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-		.commandPool = commandPools[frameInFlightIndex],
+		.commandPool = *pCommandPool,
 		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
 		.commandBufferCount = 1
 	};
 	if(vkAllocateCommandBuffers(device, &allocateInfo, pCommandBuffer) != VK_SUCCESS)
 	{
+		vkDestroyCommandPool(device, *pCommandPool, NULL);
 		return FR_ERROR_UNKNOWN;
 	}
 
@@ -54,47 +417,211 @@ FrResult frBeginCommandBuffer(VkCommandBuffer* pCommandBuffer)
 	};
 	if(vkBeginCommandBuffer(*pCommandBuffer, &beginInfo) != VK_SUCCESS)
 	{
-		vkFreeCommandBuffers(device, commandPools[frameInFlightIndex], 1, pCommandBuffer);
+		vkDestroyCommandPool(device, *pCommandPool, NULL);
+		return FR_ERROR_UNKNOWN;
+	}
+
+	return FR_SUCCESS;
+}
+
+FrResult frBeginUploadBatch(FrUploadBatch* pBatch)
+{
+	*pBatch = (FrUploadBatch){0};
+
+	// Create graphics command buffer
+	if(frBeginUploadCommandBuffer(queueFamily, &pBatch->commandPool, &pBatch->commandBuffer) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	// Create transfer command buffer and the semaphore ordering it before the graphics one
+	if(transferQueueFamily != queueFamily)
+	{
+		if(frBeginUploadCommandBuffer(transferQueueFamily, &pBatch->transferCommandPool, &pBatch->transferCommandBuffer) != FR_SUCCESS)
+		{
+			vkDestroyCommandPool(device, pBatch->commandPool, NULL);
+			return FR_ERROR_UNKNOWN;
+		}
+
+		const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+		};
+		if(vkCreateSemaphore(device, &semaphoreCreateInfo, NULL, &pBatch->transferSemaphore) != VK_SUCCESS)
+		{
+			vkDestroyCommandPool(device, pBatch->transferCommandPool, NULL);
+			vkDestroyCommandPool(device, pBatch->commandPool, NULL);
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+	else
+	{
+		pBatch->transferCommandBuffer = pBatch->commandBuffer;
+	}
+
+	// Create fence
+	const VkFenceCreateInfo fenceCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
+	};
+	if(vkCreateFence(device, &fenceCreateInfo, NULL, &pBatch->fence) != VK_SUCCESS)
+	{
+		vkDestroySemaphore(device, pBatch->transferSemaphore, NULL);
+		vkDestroyCommandPool(device, pBatch->transferCommandPool, NULL);
+		vkDestroyCommandPool(device, pBatch->commandPool, NULL);
+		return FR_ERROR_UNKNOWN;
+	}
+
+	frCreateStagingBufferVector(&pBatch->stagingBuffers);
+	frCreateRetiredResourceVector(&pBatch->retiredResources);
+
+	return FR_SUCCESS;
+}
+
+FrResult frCreateStagingBuffer(FrUploadBatch* pBatch, VkDeviceSize size, VkBuffer* pBuffer, void** ppData)
+{
+	if(pBatch->submitted)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	FrStagingBuffer stagingBuffer;
+	if(frCreateBuffer(
+		size,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		&stagingBuffer.buffer,
+		&stagingBuffer.memory
+	) != FR_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
+
+	if(vkMapMemory(device, stagingBuffer.memory, 0, size, 0, ppData) != VK_SUCCESS)
+	{
+		vkDestroyBuffer(device, stagingBuffer.buffer, NULL);
+		vkFreeMemory(device, stagingBuffer.memory, NULL);
 		return FR_ERROR_UNKNOWN;
 	}
 
+	if(frPushBackStagingBufferVector(&pBatch->stagingBuffers, stagingBuffer) != FR_SUCCESS)
+	{
+		vkDestroyBuffer(device, stagingBuffer.buffer, NULL);
+		vkFreeMemory(device, stagingBuffer.memory, NULL);
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	*pBuffer = stagingBuffer.buffer;
+
 	return FR_SUCCESS;
 }
 
-FrResult frEndCommandBuffer(VkCommandBuffer commandBuffer)
+FrResult frSubmitUploadBatch(FrUploadBatch* pBatch)
 {
+	if(pBatch->submitted)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Submit the copies to the transfer queue
+	if(pBatch->transferCommandBuffer != pBatch->commandBuffer)
+	{
+		if(vkEndCommandBuffer(pBatch->transferCommandBuffer) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+
+		const VkSubmitInfo submitInfo = {
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &pBatch->transferCommandBuffer,
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores = &pBatch->transferSemaphore
+		};
+		if(vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			return FR_ERROR_UNKNOWN;
+		}
+	}
+
+	// Make transfer writes visible to any later use of the uploaded resources
+	const VkMemoryBarrier barrier = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT
+	};
+	vkCmdPipelineBarrier(pBatch->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+
 	// End command buffer
-	if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+	if(vkEndCommandBuffer(pBatch->commandBuffer) != VK_SUCCESS)
 	{
-		vkFreeCommandBuffers(device, commandPools[frameInFlightIndex], 1, &commandBuffer);
 		return FR_ERROR_UNKNOWN;
 	}
 
-	// Submit to queue
+	// Submit the ownership acquisitions and graphics work, after the copies
+	const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 	const VkSubmitInfo submitInfo = {
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.waitSemaphoreCount = pBatch->transferSemaphore ? 1 : 0,
+		.pWaitSemaphores = &pBatch->transferSemaphore,
+		.pWaitDstStageMask = &waitStage,
 		.commandBufferCount = 1,
-		.pCommandBuffers = &commandBuffer
+		.pCommandBuffers = &pBatch->commandBuffer
 	};
-	if(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+	if(vkQueueSubmit(queue, 1, &submitInfo, pBatch->fence) != VK_SUCCESS)
 	{
-		vkFreeCommandBuffers(device, commandPools[frameInFlightIndex], 1, &commandBuffer);
 		return FR_ERROR_UNKNOWN;
 	}
 
-	// Wait idle
-	if(vkQueueWaitIdle(queue) != VK_SUCCESS)
+	pBatch->submitted = true;
+
+	return FR_SUCCESS;
+}
+
+bool frIsUploadBatchComplete(const FrUploadBatch* pBatch)
+{
+	return pBatch->submitted && vkGetFenceStatus(device, pBatch->fence) == VK_SUCCESS;
+}
+
+FrResult frWaitUploadBatch(const FrUploadBatch* pBatch)
+{
+	if(!pBatch->submitted)
 	{
-		vkFreeCommandBuffers(device, commandPools[frameInFlightIndex], 1, &commandBuffer);
-		return FR_ERROR_UNKNOWN;
+		return FR_ERROR_INVALID_ARGUMENT;
 	}
 
-	// Free command buffer
-	vkFreeCommandBuffers(device, commandPools[frameInFlightIndex], 1, &commandBuffer);
+	if(vkWaitForFences(device, 1, &pBatch->fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+	{
+		return FR_ERROR_UNKNOWN;
+	}
 
 	return FR_SUCCESS;
 }
 
+void frDestroyUploadBatch(FrUploadBatch* pBatch)
+{
+	if(pBatch->submitted)
+	{
+		frWaitUploadBatch(pBatch);
+	}
+
+	for(size_t i = 0; i < pBatch->stagingBuffers.size; ++i)
+	{
+		vkDestroyBuffer(device, pBatch->stagingBuffers.data[i].buffer, NULL);
+		vkFreeMemory(device, pBatch->stagingBuffers.data[i].memory, NULL);
+	}
+	frDestroyStagingBufferVector(&pBatch->stagingBuffers);
+
+	for(size_t i = 0; i < pBatch->retiredResources.size; ++i)
+	{
+		frDestroyRetiredResource(&pBatch->retiredResources.data[i]);
+	}
+	frDestroyRetiredResourceVector(&pBatch->retiredResources);
+
+	vkDestroyFence(device, pBatch->fence, NULL);
+	vkDestroySemaphore(device, pBatch->transferSemaphore, NULL);
+	vkDestroyCommandPool(device, pBatch->transferCommandPool, NULL);
+	vkDestroyCommandPool(device, pBatch->commandPool, NULL);
+}
+
 FrResult frCreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer* pBuffer, VkDeviceMemory* pBufferMemory)
 {
 	// Create buffer
@@ -143,38 +670,45 @@ FrResult frCreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPro
 	return FR_SUCCESS;
 }
 
-FrResult frCopyBuffer(VkBuffer sourceBuffer, VkBuffer destinationBuffer, VkDeviceSize size)
+FrResult frCopyBuffer(FrUploadBatch* pBatch, VkBuffer sourceBuffer, VkBuffer destinationBuffer, VkDeviceSize destinationOffset, VkDeviceSize size)
 {
-	// Create command buffer
-	VkCommandBuffer commandBuffer;
-	if(frBeginCommandBuffer(&commandBuffer) != FR_SUCCESS)
+	if(pBatch->submitted)
 	{
-		return FR_ERROR_UNKNOWN;
+		return FR_ERROR_INVALID_ARGUMENT;
 	}
 
 	// Copy buffer
 	const VkBufferCopy region = {
+		.dstOffset = destinationOffset,
 		.size = size
 	};
-	vkCmdCopyBuffer(commandBuffer, sourceBuffer, destinationBuffer, 1, &region);
+	vkCmdCopyBuffer(pBatch->transferCommandBuffer, sourceBuffer, destinationBuffer, 1, &region);
 
-	// End command buffer
-	if(frEndCommandBuffer(commandBuffer) != FR_SUCCESS)
+	// Hand the buffer over to the graphics queue family
+	if(pBatch->transferCommandBuffer != pBatch->commandBuffer)
 	{
-		return FR_ERROR_UNKNOWN;
+		VkBufferMemoryBarrier barrier = {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = 0,
+			.srcQueueFamilyIndex = transferQueueFamily,
+			.dstQueueFamilyIndex = queueFamily,
+			.buffer = destinationBuffer,
+			.offset = destinationOffset,
+			.size = size
+		};
+		vkCmdPipelineBarrier(pBatch->transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		vkCmdPipelineBarrier(pBatch->commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
 	}
 
 	return FR_SUCCESS;
 }
 
-static FrResult frTransitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
+static FrResult frTransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
 {
-	VkCommandBuffer commandBuffer;
-	if(frBeginCommandBuffer(&commandBuffer) != FR_SUCCESS)
-	{
-		return FR_ERROR_UNKNOWN;
-	}
-
 	VkPipelineStageFlags sourceStage, destinationStage;
 
 	VkImageMemoryBarrier barrier = {
@@ -209,25 +743,16 @@ static FrResult frTransitionImageLayout(VkImage image, VkImageLayout oldLayout,
 	}
 	else
 	{
-		vkFreeCommandBuffers(device, commandPools[frameInFlightIndex], 1, &commandBuffer);
 		return FR_ERROR_INVALID_ARGUMENT;
 	}
 
 	vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, NULL, 0, NULL, 1, &barrier);
 
-	if(frEndCommandBuffer(commandBuffer) != FR_SUCCESS)
-	{
-		return FR_ERROR_UNKNOWN;
-	}
-
 	return FR_SUCCESS;
 }
 
-static FrResult frCopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+static void frCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
 {
-	VkCommandBuffer commandBuffer;
-	if(frBeginCommandBuffer(&commandBuffer) != FR_SUCCESS) return FR_ERROR_UNKNOWN;
-
 	const VkBufferImageCopy region = {
 		.bufferOffset = 0,
 		.bufferRowLength = 0,
@@ -240,13 +765,36 @@ static FrResult frCopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t wid
 		.imageExtent = {width, height, 1}
 	};
 	vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
 
-	if(frEndCommandBuffer(commandBuffer) != FR_SUCCESS)
+static void frTransferImageOwnership(FrUploadBatch* pBatch, VkImage image, uint32_t mipLevels)
+{
+	if(pBatch->transferCommandBuffer == pBatch->commandBuffer)
 	{
-		return FR_ERROR_UNKNOWN;
+		return;
 	}
 
-	return FR_SUCCESS;
+	// Hand the image over to the graphics queue family, keeping its layout
+	VkImageMemoryBarrier barrier = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = 0,
+		.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		.srcQueueFamilyIndex = transferQueueFamily,
+		.dstQueueFamilyIndex = queueFamily,
+		.image = image,
+		.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.subresourceRange.baseMipLevel = 0,
+		.subresourceRange.levelCount = mipLevels,
+		.subresourceRange.baseArrayLayer = 0,
+		.subresourceRange.layerCount = 1
+	};
+	vkCmdPipelineBarrier(pBatch->transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	vkCmdPipelineBarrier(pBatch->commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
 }
 
 FrResult frCreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage* pImage, VkDeviceMemory* pImageMemory)
@@ -276,11 +824,18 @@ FrResult frCreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSa
 	VkMemoryRequirements memoryRequirements;
 	vkGetImageMemoryRequirements(device, *pImage, &memoryRequirements);
 
+	// Transient attachments never leave the render pass, so tile-based GPUs may not need to back them with memory
 	uint32_t memoryTypeIndex;
-	if(frFindMemoryTypeIndex(memoryRequirements.memoryTypeBits, properties, &memoryTypeIndex) != FR_SUCCESS)
+	if(
+		!(usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) ||
+		frFindMemoryTypeIndex(memoryRequirements.memoryTypeBits, properties | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &memoryTypeIndex) != FR_SUCCESS
+	)
 	{
-		vkDestroyImage(device, *pImage, NULL);
-		return FR_ERROR_UNKNOWN;
+		if(frFindMemoryTypeIndex(memoryRequirements.memoryTypeBits, properties, &memoryTypeIndex) != FR_SUCCESS)
+		{
+			vkDestroyImage(device, *pImage, NULL);
+			return FR_ERROR_UNKNOWN;
+		}
 	}
 
 	const VkMemoryAllocateInfo allocateInfo = {
@@ -331,20 +886,42 @@ FrResult frCreateImageView(VkImage image, VkFormat format, VkImageAspectFlags as
 	return FR_SUCCESS;
 }
 
-static FrResult frGenerateMipmap(VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels)
+void frRecordMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags sourceStage, VkAccessFlags sourceAccess, VkPipelineStageFlags destinationStage, VkAccessFlags destinationAccess)
 {
-	VkFormatProperties formatProperties;
-	vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
-	if(!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
-	{
-		return FR_ERROR_UNKNOWN;
-	}
+	const VkMemoryBarrier barrier = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask = sourceAccess,
+		.dstAccessMask = destinationAccess
+	};
+	vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 1, &barrier, 0, NULL, 0, NULL);
+}
 
-	VkCommandBuffer commandBuffer;
-	if(frBeginCommandBuffer(&commandBuffer) != FR_SUCCESS)
-	{
-		return FR_ERROR_UNKNOWN;
-	}
+void frRecordImageBarrier(VkCommandBuffer commandBuffer, VkImage image, uint32_t mipLevels, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags sourceStage, VkAccessFlags sourceAccess, VkPipelineStageFlags destinationStage, VkAccessFlags destinationAccess)
+{
+	const VkImageMemoryBarrier barrier = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcAccessMask = sourceAccess,
+		.dstAccessMask = destinationAccess,
+		.oldLayout = oldLayout,
+		.newLayout = newLayout,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.image = image,
+		.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.subresourceRange.baseMipLevel = 0,
+		.subresourceRange.levelCount = mipLevels,
+		.subresourceRange.baseArrayLayer = 0,
+		.subresourceRange.layerCount = 1
+	};
+	vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+/*
+ * Record the blits generating the mip levels of an image, whose format must support linear filtering.
+ */
+static void frGenerateMipmap(FrUploadBatch* pBatch, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+	const VkCommandBuffer commandBuffer = pBatch->commandBuffer;
 
 	VkImageMemoryBarrier barrier = {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -409,17 +986,18 @@ static FrResult frGenerateMipmap(VkImage image, VkFormat format, uint32_t width,
 	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
 	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
 
-	if(frEndCommandBuffer(commandBuffer) != FR_SUCCESS)
+FrResult frCreateTexture(FrUploadBatch* pBatch, const char* path)
+{
+	// The mipmap blits need linear filtering, checked before anything is recorded
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProperties);
+	if(!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
 	{
 		return FR_ERROR_UNKNOWN;
 	}
 
-	return FR_SUCCESS;
-}
-
-FrResult frCreateTexture(const char* path)
-{
 	if(frPushBackTextureVector(&textures, (FrTexture){0}) != FR_SUCCESS)
 	{
 		return FR_ERROR_UNKNOWN;
@@ -465,30 +1043,15 @@ FrResult frCreateTexture(const char* path)
 	// Compute size
 	const VkDeviceSize size = image.width * image.height * 4;
 
-	// Create staging buffer
+	// Create staging buffer and upload data to it
 	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	if(frCreateBuffer(
-		size,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		&stagingBuffer,
-		&stagingBufferMemory
-	) != FR_SUCCESS)
-	{
-		free(image.data);
-		return FR_ERROR_UNKNOWN;
-	}
-
-	// Upload data to the device
 	void* data;
-	if(vkMapMemory(device, stagingBufferMemory, 0, size, 0, &data) != VK_SUCCESS)
+	if(frCreateStagingBuffer(pBatch, size, &stagingBuffer, &data) != FR_SUCCESS)
 	{
 		free(image.data);
 		return FR_ERROR_UNKNOWN;
 	}
 	memcpy(data, image.data, size);
-	vkUnmapMemory(device, stagingBufferMemory);
 
 	// Free image
 	free(image.data);
@@ -507,43 +1070,30 @@ FrResult frCreateTexture(const char* path)
 		&textures.data[textures.size - 1].imageMemory
 	) != FR_SUCCESS)
 	{
-		vkDestroyBuffer(device, stagingBuffer, NULL);
-		vkFreeMemory(device, stagingBufferMemory, NULL);
+		textures.data[textures.size - 1] = (FrTexture){0};
 		return FR_ERROR_UNKNOWN;
 	}
 
-	// Copy data to image
-	if(frTransitionImageLayout(textures.data[textures.size - 1].image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, textureMipLevels) != FR_SUCCESS)
-	{
-		vkDestroyImage(device, textures.data[textures.size - 1].image, NULL);
-		vkFreeMemory(device, textures.data[textures.size - 1].imageMemory, NULL);
-		vkDestroyBuffer(device, stagingBuffer, NULL);
-		vkFreeMemory(device, stagingBufferMemory, NULL);
-		return FR_ERROR_UNKNOWN;
-	}
+	// Record the copy and the mipmap generation in the batch
+	// Copies of whole mip levels are legal on any queue whatever its image transfer granularity
 
-	if(frCopyBufferToImage(stagingBuffer, textures.data[textures.size - 1].image, image.width, image.height) != FR_SUCCESS)
+	// Nothing is recorded when the transition fails
+	if(frTransitionImageLayout(pBatch->transferCommandBuffer, textures.data[textures.size - 1].image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, textureMipLevels) != FR_SUCCESS)
 	{
 		vkDestroyImage(device, textures.data[textures.size - 1].image, NULL);
 		vkFreeMemory(device, textures.data[textures.size - 1].imageMemory, NULL);
-		vkDestroyBuffer(device, stagingBuffer, NULL);
-		vkFreeMemory(device, stagingBufferMemory, NULL);
+		textures.data[textures.size - 1] = (FrTexture){0};
 		return FR_ERROR_UNKNOWN;
 	}
 
-	vkDestroyBuffer(device, stagingBuffer, NULL);
-	vkFreeMemory(device, stagingBufferMemory, NULL);
+	frCopyBufferToImage(pBatch->transferCommandBuffer, stagingBuffer, textures.data[textures.size - 1].image, image.width, image.height);
+	frTransferImageOwnership(pBatch, textures.data[textures.size - 1].image, textureMipLevels);
 
 	// Mipmap
-	if(frGenerateMipmap(textures.data[textures.size - 1].image, VK_FORMAT_R8G8B8A8_SRGB, image.width, image.height, textureMipLevels) != FR_SUCCESS)
-	{
-		vkDestroyImage(device, textures.data[textures.size - 1].image, NULL);
-		vkFreeMemory(device, textures.data[textures.size - 1].imageMemory, NULL);
-		return FR_ERROR_UNKNOWN;
-	}
+	frGenerateMipmap(pBatch, textures.data[textures.size - 1].image, image.width, image.height, textureMipLevels);
 
 	// If no mipmap
-	/* if(frTransitionImageLayout(textures.data[textures.size - 1].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textureMipLevels) != FR_SUCCESS)
+	/* if(frTransitionImageLayout(pBatch, textures.data[textures.size - 1].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textureMipLevels) != FR_SUCCESS)
 	{
 		vkDestroyImage(device, textures.data[textures.size - 1].image, NULL);
 		vkFreeMemory(device, textures.data[textures.size - 1].imageMemory, NULL);
@@ -553,10 +1103,125 @@ FrResult frCreateTexture(const char* path)
 	// Create image view
 	if(frCreateImageView(textures.data[textures.size - 1].image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, textureMipLevels, &textures.data[textures.size - 1].imageView) != FR_SUCCESS)
 	{
-		vkDestroyImage(device, textures.data[textures.size - 1].image, NULL);
-		vkFreeMemory(device, textures.data[textures.size - 1].imageMemory, NULL);
+		// The batch uses the image, so it goes with the batch, and the slot reads as retired
+		const FrRetiredResource resources[] = {
+			{.type = FR_RETIRED_RESOURCE_IMAGE, .image = textures.data[textures.size - 1].image},
+			{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = textures.data[textures.size - 1].imageMemory}
+		};
+		textures.data[textures.size - 1] = (FrTexture){0};
+		for(uint32_t i = 0; i < FR_LEN(resources); ++i)
+		{
+			if(frPushBackRetiredResourceVector(&pBatch->retiredResources, resources[i]) != FR_SUCCESS)
+			{
+				return FR_ERROR_OUT_OF_HOST_MEMORY;
+			}
+		}
 		return FR_ERROR_UNKNOWN;
 	}
 
+	frWriteBindlessDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (uint32_t)textures.size - 1);
+
+	return FR_SUCCESS;
+}
+
+FrResult frCreateStorageTexture(FrUploadBatch* pBatch, uint32_t width, uint32_t height)
+{
+	if(!width || !height)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	if(frPushBackTextureVector(&textures, (FrTexture){0}) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	FrTexture* const pTexture = &textures.data[textures.size - 1];
+
+	// Every device supports storage images of this format, unlike sRGB ones
+	if(frCreateImage(
+		width,
+		height,
+		1,
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&pTexture->image,
+		&pTexture->imageMemory
+	) != FR_SUCCESS)
+	{
+		*pTexture = (FrTexture){0};
+		return FR_ERROR_UNKNOWN;
+	}
+	if(frCreateImageView(pTexture->image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 1, &pTexture->imageView) != FR_SUCCESS)
+	{
+		vkDestroyImage(device, pTexture->image, NULL);
+		vkFreeMemory(device, pTexture->imageMemory, NULL);
+		*pTexture = (FrTexture){0};
+		return FR_ERROR_UNKNOWN;
+	}
+	pTexture->storage = true;
+
+	// Clear it on the graphics queue, as transfer queues cannot clear images, and leave it ready for sampling
+	frRecordImageBarrier(
+		pBatch->commandBuffer,
+		pTexture->image,
+		1,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		0,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT
+	);
+	const VkClearColorValue clearColor = {
+		.float32 = {0.f, 0.f, 0.f, 0.f}
+	};
+	const VkImageSubresourceRange clearRange = {
+		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.levelCount = 1,
+		.layerCount = 1
+	};
+	vkCmdClearColorImage(pBatch->commandBuffer, pTexture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &clearRange);
+	frRecordImageBarrier(
+		pBatch->commandBuffer,
+		pTexture->image,
+		1,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	);
+
+	frWriteBindlessDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (uint32_t)textures.size - 1);
+
+	return FR_SUCCESS;
+}
+
+FrResult frRetireTexture(uint32_t textureIndex)
+{
+	if(textureIndex >= textures.size || textures.data[textureIndex].image == VK_NULL_HANDLE)
+	{
+		return FR_ERROR_INVALID_ARGUMENT;
+	}
+
+	FrTexture* const pTexture = &textures.data[textureIndex];
+	const FrRetiredResource resources[] = {
+		{.type = FR_RETIRED_RESOURCE_IMAGE_VIEW, .imageView = pTexture->imageView},
+		{.type = FR_RETIRED_RESOURCE_IMAGE, .image = pTexture->image},
+		{.type = FR_RETIRED_RESOURCE_MEMORY, .memory = pTexture->imageMemory},
+		{.type = FR_RETIRED_RESOURCE_BINDLESS_DESCRIPTOR, .bindlessType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .bindlessIndex = textureIndex}
+	};
+	if(frRetireResources(FR_LEN(resources), resources) != FR_SUCCESS)
+	{
+		return FR_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	// Keep the slot so the other texture indexes stay valid
+	*pTexture = (FrTexture){0};
+
 	return FR_SUCCESS;
 }
@@ -8,6 +8,9 @@
 #include <tgmath.h>
 
 #include <fraus/fraus.h>
+#include <spirv-headers/spirv.h>
+
+#include "../fraus/source/vulkan/spirv.h"
 
 int compareInts(const void* pFirstVoid, const void* pSecondVoid)
 {
@@ -39,6 +42,115 @@ typedef struct FrF2d14
 	float floating;
 } FrF2d14;
 
+// Each job increments the total, and the first ones wait for jobs of their own
+typedef struct FrJobTest
+{
+	FrAtomic* pTotal;
+	uint32_t childCount;
+} FrJobTest;
+
+void runTestJob(void* pDataVoid)
+{
+	const FrJobTest* const pData = pDataVoid;
+	frAtomicAdd(pData->pTotal, 1);
+
+	if(pData->childCount)
+	{
+		FrJobTest children[16];
+		FrJob jobs[16];
+		for(uint32_t i = 0; i < pData->childCount; ++i)
+		{
+			children[i] = (FrJobTest){.pTotal = pData->pTotal};
+			jobs[i] = (FrJob){.function = runTestJob, .pData = &children[i]};
+		}
+		FrJobCounter counter = {0};
+		frRunJobs(pData->childCount, jobs, &counter);
+		frWaitJobCounter(&counter);
+	}
+}
+
+void runMainThreadTestJob(void* pDataVoid)
+{
+	bool* const pOnMainThread = pDataVoid;
+	*pOnMainThread = frGetJobThreadIndex() == 0;
+}
+
+void runForeignTestThread(void* pDataVoid)
+{
+	uint32_t* const pThreadIndex = pDataVoid;
+	*pThreadIndex = frGetJobThreadIndex();
+}
+
+// Stand in for the device when retiring resources, counting what is destroyed
+static uint32_t destroyedCount;
+
+VKAPI_ATTR void VKAPI_CALL destroyTestBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator)
+{
+	(void)device;
+	(void)buffer;
+	(void)pAllocator;
+	++destroyedCount;
+}
+
+VKAPI_ATTR void VKAPI_CALL freeTestMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+{
+	(void)device;
+	(void)memory;
+	(void)pAllocator;
+	++destroyedCount;
+}
+
+VKAPI_ATTR void VKAPI_CALL destroyTestImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+{
+	(void)device;
+	(void)image;
+	(void)pAllocator;
+	++destroyedCount;
+}
+
+VKAPI_ATTR void VKAPI_CALL destroyTestImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks* pAllocator)
+{
+	(void)device;
+	(void)imageView;
+	(void)pAllocator;
+	++destroyedCount;
+}
+
+// The retired sets must be reused, so nothing is allocated
+VKAPI_ATTR VkResult VKAPI_CALL allocateTestDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+	(void)device;
+	(void)pAllocateInfo;
+	(void)pDescriptorSets;
+	return VK_ERROR_OUT_OF_POOL_MEMORY;
+}
+
+// Stand in for the bindless set, keeping the last writes
+static VkWriteDescriptorSet bindlessWrites[FR_MAX_FRAMES_IN_FLIGHT];
+static VkDescriptorBufferInfo bindlessBufferInfos[FR_MAX_FRAMES_IN_FLIGHT];
+static VkDescriptorImageInfo bindlessImageInfos[FR_MAX_FRAMES_IN_FLIGHT];
+static uint32_t bindlessWriteCount;
+
+VKAPI_ATTR void VKAPI_CALL updateTestDescriptorSets(VkDevice device, uint32_t writeCount, const VkWriteDescriptorSet* pWrites, uint32_t copyCount, const VkCopyDescriptorSet* pCopies)
+{
+	(void)device;
+	(void)copyCount;
+	(void)pCopies;
+	bindlessWriteCount = writeCount < FR_MAX_FRAMES_IN_FLIGHT ? writeCount : FR_MAX_FRAMES_IN_FLIGHT;
+	for(uint32_t i = 0; i < bindlessWriteCount; ++i)
+	{
+		bindlessWrites[i] = pWrites[i];
+		if(pWrites[i].pBufferInfo)
+		{
+			bindlessBufferInfos[i] = *pWrites[i].pBufferInfo;
+		}
+		if(pWrites[i].pImageInfo)
+		{
+			bindlessImageInfos[i] = *pWrites[i].pImageInfo;
+		}
+	}
+}
+
 #define FR_FATAL(...) \
 fprintf(stderr, "[FRAUS|FATAL]\n\terrno %d: %s\n\tFraus: ", errno, strerror(errno)); \
 fprintf(stderr, __VA_ARGS__); \
@@ -112,5 +224,494 @@ int main(void)
 		}
 	}
 
+	// Test 3: frSortDrawPackets and frMakeDrawKey
+	FrDrawPacket packets[300];
+	FrDrawPacket scratch[FR_LEN(packets)];
+	uint64_t seed = 0x9E3779B97F4A7C15;
+	for(uint32_t i = 0; i < FR_LEN(packets); ++i)
+	{
+		seed = seed * 6364136223846793005 + 1442695040888963407;
+		// Few distinct keys to check stability
+		packets[i].key = (seed >> 60) << 48 | (seed >> 8 & 0x3);
+		packets[i].objectIndex = i;
+	}
+	frSortDrawPackets(FR_LEN(packets), packets, scratch);
+	for(uint32_t i = 1; i < FR_LEN(packets); ++i)
+	{
+		if(packets[i - 1].key > packets[i].key || (packets[i - 1].key == packets[i].key && packets[i - 1].objectIndex > packets[i].objectIndex))
+		{
+			FR_FATAL("frSortDrawPackets test failed at packet %"PRIu32".", i);
+		}
+	}
+
+	const FrDrawPacket orderedPackets[] = {
+		{frMakeDrawKey(FR_DRAW_PASS_OPAQUE, 0, 7, 0, 1.f), 0},
+		{frMakeDrawKey(FR_DRAW_PASS_OPAQUE, 0, 7, 0, 20.f), 1},
+		{frMakeDrawKey(FR_DRAW_PASS_OPAQUE, 0, 7, 1, 0.5f), 2},
+		{frMakeDrawKey(FR_DRAW_PASS_OPAQUE, 0, 8, 0, 0.5f), 3},
+		{frMakeDrawKey(FR_DRAW_PASS_OPAQUE, 3, 0, 0, -1.f), 4},
+		{frMakeDrawKey(FR_DRAW_PASS_OPAQUE, 3, 0, 0, 0.f), 5},
+		{frMakeDrawKey(FR_DRAW_PASS_TRANSPARENT, 5, 0, 0, 30.f), 6},
+		{frMakeDrawKey(FR_DRAW_PASS_TRANSPARENT, 1, 0, 0, 2.f), 7},
+		{frMakeDrawKey(FR_DRAW_PASS_OVERLAY, 0, 0, 0, 100.f), 8}
+	};
+	FrDrawPacket shuffledPackets[FR_LEN(orderedPackets)];
+	for(uint32_t i = 0; i < FR_LEN(orderedPackets); ++i)
+	{
+		shuffledPackets[i] = orderedPackets[(i * 5 + 3) % FR_LEN(orderedPackets)];
+	}
+	frSortDrawPackets(FR_LEN(shuffledPackets), shuffledPackets, scratch);
+	for(uint32_t i = 0; i < FR_LEN(orderedPackets); ++i)
+	{
+		if(shuffledPackets[i].objectIndex != i)
+		{
+			FR_FATAL("frMakeDrawKey test failed: packet %"PRIu32" is %"PRIu32".", i, shuffledPackets[i].objectIndex);
+		}
+	}
+
+	// Test 4: frExtractFrustum and frCullDrawPackets
+	const FrVec3 eye = {.x = 0.f, .y = 0.f, .z = 0.f};
+	const FrVec3 objective = {.x = 0.f, .y = 1.f, .z = 0.f};
+	float viewMatrix[16];
+	frLookAt(viewMatrix, &eye, &objective);
+	float perspectiveMatrix[16];
+	frPerspective(perspectiveMatrix, PI / 2.f, 1.f, 0.1f, 100.f);
+	float cameraMatrix[16];
+	frMultiply(viewMatrix, perspectiveMatrix, cameraMatrix);
+	FrFrustum frustum;
+	frExtractFrustum(cameraMatrix, &frustum);
+
+	// More than a block, with the 45 degrees side planes at x = +-y and z = +-y
+	const struct
+	{
+		FrSphere sphere;
+		bool visible;
+	} cullCases[] = {
+		{{{.x =   0.f, .y =  10.f, .z =  0.f}, 1.f}, true},
+		{{{.x =   0.f, .y = -10.f, .z =  0.f}, 1.f}, false},
+		{{{.x =  20.f, .y =  10.f, .z =  0.f}, 1.f}, false},
+		{{{.x =  10.5f, .y = 10.f, .z =  0.f}, 1.f}, true},
+		{{{.x =   0.f, .y = 200.f, .z =  0.f}, 5.f}, false},
+		{{{.x =   0.f, .y = 102.f, .z =  0.f}, 5.f}, true},
+		{{{.x =   0.f, .y =  10.f, .z = 12.f}, 1.f}, false},
+		{{{.x =   0.f, .y =  10.f, .z = -10.f}, 1.f}, true},
+		{{{.x =  -5.f, .y =   5.f, .z =  5.f}, 0.5f}, true},
+		{{{.x =   0.f, .y =  0.05f, .z = 0.f}, 0.01f}, false}
+	};
+	FrSphere cullSpheres[FR_LEN(cullCases)];
+	FrDrawPacket cullPackets[FR_LEN(cullCases)];
+	for(uint32_t i = 0; i < FR_LEN(cullCases); ++i)
+	{
+		cullSpheres[i] = cullCases[i].sphere;
+		cullPackets[i] = (FrDrawPacket){.key = i, .objectIndex = i};
+	}
+	const size_t visibleCount = frCullDrawPackets(&frustum, FR_LEN(cullPackets), cullSpheres, cullPackets);
+	size_t expectedIndex = 0;
+	for(uint32_t i = 0; i < FR_LEN(cullCases); ++i)
+	{
+		if(!cullCases[i].visible)
+		{
+			continue;
+		}
+		if(expectedIndex >= visibleCount || cullPackets[expectedIndex].objectIndex != i)
+		{
+			FR_FATAL("frCullDrawPackets test failed: sphere %"PRIu32" was culled.", i);
+		}
+		++expectedIndex;
+	}
+	if(expectedIndex != visibleCount)
+	{
+		FR_FATAL("frCullDrawPackets test failed: %zu spheres kept, expected %zu.", visibleCount, expectedIndex);
+	}
+
+	// Test 5: frRunJobs, frWaitJobCounter and frFinishJobs
+	if(frCreateJobSystem() != FR_SUCCESS)
+	{
+		FR_FATAL("frCreateJobSystem test failed.");
+	}
+	FrAtomic jobTotal = {0};
+	FrJobTest jobTests[64];
+	FrJob jobs[FR_LEN(jobTests)];
+	for(uint32_t i = 0; i < FR_LEN(jobTests); ++i)
+	{
+		jobTests[i] = (FrJobTest){.pTotal = &jobTotal, .childCount = i < 16 ? 16 : 0};
+		jobs[i] = (FrJob){.function = runTestJob, .pData = &jobTests[i]};
+	}
+	FrJobCounter jobCounter = {0};
+	frRunJobs(FR_LEN(jobs), jobs, &jobCounter);
+	frWaitJobCounter(&jobCounter);
+	if(frAtomicLoad(&jobTotal) != FR_LEN(jobTests) + 16 * 16)
+	{
+		FR_FATAL("frRunJobs test failed: %"PRIu32" jobs ran, expected %"PRIu32".", frAtomicLoad(&jobTotal), (uint32_t)(FR_LEN(jobTests) + 16 * 16));
+	}
+
+	bool onMainThread = false;
+	const FrJob mainThreadJob = {.function = runMainThreadTestJob, .pData = &onMainThread};
+	frRunMainThreadJobs(1, &mainThreadJob, &jobCounter);
+	frWaitJobCounter(&jobCounter);
+	if(!onMainThread)
+	{
+		FR_FATAL("frRunMainThreadJobs test failed: the job did not run on the main thread.");
+	}
+
+	// A thread the job system did not start is not mistaken for the main thread
+	uint32_t foreignThreadIndex = 0;
+	FrThread foreignThread;
+	if(frCreateThread(runForeignTestThread, &foreignThreadIndex, &foreignThread) != FR_SUCCESS)
+	{
+		FR_FATAL("frCreateThread test failed.");
+	}
+	frJoinThread(foreignThread);
+	if(foreignThreadIndex != FR_JOB_THREAD_INDEX_NONE)
+	{
+		FR_FATAL("frGetJobThreadIndex test failed: %"PRIu32" on a foreign thread.", foreignThreadIndex);
+	}
+
+	// The job of the first counter is buried under the one of the second
+	FrAtomic finishTotal = {0};
+	FrJobTest finishTests[2] = {{.pTotal = &finishTotal}, {.pTotal = &finishTotal}};
+	FrJobCounter finishCounters[2] = {0};
+	for(uint32_t i = 0; i < FR_LEN(finishTests); ++i)
+	{
+		const FrJob finishJob = {.function = runTestJob, .pData = &finishTests[i]};
+		frRunJobs(1, &finishJob, &finishCounters[i]);
+	}
+	frFinishJobs(&finishCounters[0]);
+	if(!frIsJobCounterDone(&finishCounters[0]))
+	{
+		FR_FATAL("frFinishJobs test failed.");
+	}
+	frFinishJobs(&finishCounters[1]);
+	if(frAtomicLoad(&finishTotal) != FR_LEN(finishTests))
+	{
+		FR_FATAL("frFinishJobs test failed: %"PRIu32" jobs ran, expected %"PRIu32".", frAtomicLoad(&finishTotal), (uint32_t)FR_LEN(finishTests));
+	}
+	frDestroyJobSystem();
+
+	// Test 6: frRetireUniformBuffer, frRetireStorageBuffer, frRetireTexture and frRetireObject
+	vkDestroyBuffer = destroyTestBuffer;
+	vkFreeMemory = freeTestMemory;
+	vkDestroyImage = destroyTestImage;
+	vkDestroyImageView = destroyTestImageView;
+	vkAllocateDescriptorSets = allocateTestDescriptorSets;
+	framesInFlight = 2;
+	frameCounter = 1;
+
+	const VkDescriptorSetLayout testLayout = (VkDescriptorSetLayout)(uintptr_t)1;
+	const VkDescriptorSet testSets[] = {(VkDescriptorSet)(uintptr_t)2, (VkDescriptorSet)(uintptr_t)3};
+	const FrUniformBuffer testUniformBuffer = {
+		.buffers = {(VkBuffer)(uintptr_t)4, (VkBuffer)(uintptr_t)5},
+		.bufferMemories = {(VkDeviceMemory)(uintptr_t)6, (VkDeviceMemory)(uintptr_t)7}
+	};
+	const FrStorageBuffer testStorageBuffer = {.buffer = (VkBuffer)(uintptr_t)8, .bufferMemory = (VkDeviceMemory)(uintptr_t)9};
+	const FrTexture testTexture = {.image = (VkImage)(uintptr_t)10, .imageMemory = (VkDeviceMemory)(uintptr_t)11, .imageView = (VkImageView)(uintptr_t)12};
+	FrVulkanObject testObject = {.pipelineIndex = 0, .alive = true};
+	memcpy(testObject.descriptorSets, testSets, sizeof(testSets));
+	if(
+		frPushBackUniformBufferVector(&uniformBuffers, testUniformBuffer) != FR_SUCCESS ||
+		frPushBackUniformBufferVector(&uniformBuffers, testUniformBuffer) != FR_SUCCESS ||
+		frPushBackStorageBufferVector(&storageBuffers, testStorageBuffer) != FR_SUCCESS ||
+		frPushBackTextureVector(&textures, testTexture) != FR_SUCCESS ||
+		frPushBackPipelineVector(&graphicsPipelines, (FrPipeline){.descriptorSetLayout = testLayout}) != FR_SUCCESS ||
+		frPushBackVulkanObjectVector(&frObjects, testObject) != FR_SUCCESS
+	)
+	{
+		FR_FATAL("Retire test setup failed.");
+	}
+
+	// The camera uniform buffer cannot be retired, and every resource only once
+	if(frRetireUniformBuffer(0) != FR_ERROR_INVALID_ARGUMENT || frRetireUniformBuffer(2) != FR_ERROR_INVALID_ARGUMENT)
+	{
+		FR_FATAL("frRetireUniformBuffer test failed: an invalid index was accepted.");
+	}
+	if(
+		frRetireUniformBuffer(1) != FR_SUCCESS ||
+		frRetireStorageBuffer(0) != FR_SUCCESS ||
+		frRetireTexture(0) != FR_SUCCESS ||
+		frRetireObject(0) != FR_SUCCESS
+	)
+	{
+		FR_FATAL("Retire test failed.");
+	}
+	if(
+		frRetireUniformBuffer(1) != FR_ERROR_INVALID_ARGUMENT ||
+		frRetireStorageBuffer(0) != FR_ERROR_INVALID_ARGUMENT ||
+		frRetireTexture(0) != FR_ERROR_INVALID_ARGUMENT ||
+		frRetireObject(0) != FR_ERROR_INVALID_ARGUMENT
+	)
+	{
+		FR_FATAL("Retire test failed: a resource was retired twice.");
+	}
+
+	// Nothing is destroyed before the frames using the resources are done
+	frDestroyRetiredResources(frameCounter - 1);
+	if(destroyedCount != 0)
+	{
+		FR_FATAL("frDestroyRetiredResources test failed: %"PRIu32" resources destroyed early.", destroyedCount);
+	}
+	frDestroyRetiredResources(frameCounter);
+	if(destroyedCount != 9 || retiredResources.size != 0)
+	{
+		FR_FATAL("frDestroyRetiredResources test failed: %"PRIu32" resources destroyed, expected 9.", destroyedCount);
+	}
+
+	// The sets of the retired object are reused by the next object with the same layout
+	const VkDescriptorSetLayout testLayouts[] = {testLayout, testLayout};
+	VkDescriptorSet reusedSets[FR_LEN(testLayouts)];
+	if(frAllocateDescriptorSets(&descriptorAllocator, FR_LEN(testLayouts), testLayouts, reusedSets) != FR_SUCCESS)
+	{
+		FR_FATAL("frAllocateDescriptorSets test failed: the retired sets were not reused.");
+	}
+	if(
+		!(reusedSets[0] == testSets[0] && reusedSets[1] == testSets[1]) &&
+		!(reusedSets[0] == testSets[1] && reusedSets[1] == testSets[0])
+	)
+	{
+		FR_FATAL("frAllocateDescriptorSets test failed: unexpected sets.");
+	}
+	if(descriptorAllocator.freeSets.size != 0)
+	{
+		FR_FATAL("frAllocateDescriptorSets test failed: %zu sets left to reuse.", descriptorAllocator.freeSets.size);
+	}
+
+	// Test 7: frOpenFileWriter, frWriteFileData and frCloseFileWriter
+	const char testFilePath[] = "fraus_test_file.bin";
+	const uint32_t testFileData[] = {1, 2, 3};
+	FrFileWriter writer;
+	if(frOpenFileWriter(testFilePath, &writer) != FR_SUCCESS)
+	{
+		FR_FATAL("frOpenFileWriter test failed.");
+	}
+	frWriteFileData(&writer, testFileData, sizeof(testFileData));
+	if(frCloseFileWriter(&writer) != FR_SUCCESS)
+	{
+		FR_FATAL("frCloseFileWriter test failed.");
+	}
+
+	// A failed write keeps the previous file
+	if(frOpenFileWriter(testFilePath, &writer) != FR_SUCCESS)
+	{
+		FR_FATAL("frOpenFileWriter test failed.");
+	}
+	frWriteFileData(&writer, testFileData, 1);
+	writer.failed = true;
+	if(frCloseFileWriter(&writer) != FR_ERROR_UNKNOWN)
+	{
+		FR_FATAL("frCloseFileWriter test failed: a failed write replaced the file.");
+	}
+
+	FILE* const testFile = fopen(testFilePath, "rb");
+	uint32_t readData[FR_LEN(testFileData) + 1];
+	const size_t readCount = testFile ? fread(readData, sizeof(readData[0]), FR_LEN(readData), testFile) : 0;
+	if(testFile)
+	{
+		fclose(testFile);
+	}
+	remove(testFilePath);
+	if(readCount != FR_LEN(testFileData) || memcmp(readData, testFileData, sizeof(testFileData)) != 0)
+	{
+		FR_FATAL("frCloseFileWriter test failed: %zu values read, expected %zu.", readCount, FR_LEN(testFileData));
+	}
+
+	// Test 8: frParseSpirv specialization constants
+	// A float, a 64 bits integer and a boolean with SpecId 7, 2 and 4, then constants without SpecId
+	const uint32_t spirvCode[] = {
+		SpvMagicNumber, 0x00010000, 0, 11, 0,
+		4 << SpvWordCountShift | SpvOpDecorate, 5, SpvDecorationSpecId, 7,
+		4 << SpvWordCountShift | SpvOpDecorate, 6, SpvDecorationSpecId, 2,
+		4 << SpvWordCountShift | SpvOpDecorate, 7, SpvDecorationSpecId, 4,
+		3 << SpvWordCountShift | SpvOpTypeFloat, 1, 32,
+		4 << SpvWordCountShift | SpvOpTypeInt, 2, 64, 0,
+		2 << SpvWordCountShift | SpvOpTypeBool, 3,
+		4 << SpvWordCountShift | SpvOpSpecConstant, 1, 5, 0x3F800000,
+		5 << SpvWordCountShift | SpvOpSpecConstant, 2, 6, 0, 0,
+		3 << SpvWordCountShift | SpvOpSpecConstantTrue, 3, 7,
+		4 << SpvWordCountShift | SpvOpConstant, 1, 8, 0x3F800000,
+		4 << SpvWordCountShift | SpvOpSpecConstant, 1, 9, 0x3F800000,
+		3 << SpvWordCountShift | SpvOpSpecConstantFalse, 3, 10
+	};
+	const FrShaderSpecializationConstant expectedConstants[] = {{.id = 2, .size = 8}, {.id = 4, .size = sizeof(VkBool32)}, {.id = 7, .size = 4}};
+	FrShaderInfo shaderInfo;
+	if(frParseSpirv(spirvCode, FR_LEN(spirvCode), &shaderInfo) != FR_SUCCESS)
+	{
+		FR_FATAL("frParseSpirv test failed.");
+	}
+	if(shaderInfo.specializationConstantCount != FR_LEN(expectedConstants))
+	{
+		FR_FATAL("frParseSpirv test failed: %"PRIu32" specialization constants, expected %zu.", shaderInfo.specializationConstantCount, FR_LEN(expectedConstants));
+	}
+	for(uint32_t i = 0; i < FR_LEN(expectedConstants); ++i)
+	{
+		if(shaderInfo.specializationConstants[i].id != expectedConstants[i].id || shaderInfo.specializationConstants[i].size != expectedConstants[i].size)
+		{
+			FR_FATAL(
+				"frParseSpirv test failed: constant %"PRIu32" has id %"PRIu32" and size %"PRIu32", expected %"PRIu32" and %"PRIu32".",
+				i,
+				shaderInfo.specializationConstants[i].id,
+				shaderInfo.specializationConstants[i].size,
+				expectedConstants[i].id,
+				expectedConstants[i].size
+			);
+		}
+	}
+	free(shaderInfo.inputs);
+	free(shaderInfo.outputs);
+	free(shaderInfo.bindings);
+	free(shaderInfo.pushConstants);
+	free(shaderInfo.specializationConstants);
+
+	// Test 9: frDispatchCompute and frComputeBarrier
+	// A pipeline with 8x1x1 workgroups reading the storage buffer at binding 0, the first storage buffer was retired by test 6
+	VkDescriptorType testDescriptorTypes[] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+	const FrComputePipeline testComputePipeline = {
+		.descriptorTypes = testDescriptorTypes,
+		.descriptorTypeCount = FR_LEN(testDescriptorTypes),
+		.localSize = {8, 1, 1}
+	};
+	if(
+		frPushBackComputePipelineVector(&computePipelines, testComputePipeline) != FR_SUCCESS ||
+		frPushBackStorageBufferVector(&storageBuffers, testStorageBuffer) != FR_SUCCESS
+	)
+	{
+		FR_FATAL("Dispatch test setup failed.");
+	}
+
+	const uint32_t testInvocationCounts[] = {20, 1, 1};
+	const uint32_t retiredBindingIndexes[] = {0};
+	const uint32_t liveBindingIndexes[] = {1};
+	if(frComputeBarrier() != FR_ERROR_INVALID_ARGUMENT)
+	{
+		FR_FATAL("frComputeBarrier test failed: a barrier was set without any dispatch.");
+	}
+	if(
+		frDispatchCompute(1, liveBindingIndexes, testInvocationCounts, NULL) != FR_ERROR_INVALID_ARGUMENT ||
+		frDispatchCompute(0, retiredBindingIndexes, testInvocationCounts, NULL) != FR_ERROR_INVALID_ARGUMENT
+	)
+	{
+		FR_FATAL("frDispatchCompute test failed: an invalid dispatch was queued.");
+	}
+	if(frDispatchCompute(0, liveBindingIndexes, testInvocationCounts, NULL) != FR_SUCCESS || frComputeBarrier() != FR_SUCCESS)
+	{
+		FR_FATAL("frDispatchCompute test failed.");
+	}
+	const FrComputeDispatch* const pTestDispatch = &computeDispatches.queued.data[0];
+	if(pTestDispatch->bindingIndexes[0] != 1 || pTestDispatch->groupCounts[0] != 3 || pTestDispatch->groupCounts[1] != 1 || !pTestDispatch->barrier)
+	{
+		FR_FATAL("frDispatchCompute test failed: unexpected dispatch.");
+	}
+
+	// A full queue is reported instead of growing past what a frame records
+	for(uint32_t i = 1; i < FR_MAX_DISPATCHES_PER_FRAME; ++i)
+	{
+		if(frDispatchCompute(0, liveBindingIndexes, testInvocationCounts, NULL) != FR_SUCCESS)
+		{
+			FR_FATAL("frDispatchCompute test failed at dispatch %"PRIu32".", i);
+		}
+	}
+	if(frDispatchCompute(0, liveBindingIndexes, testInvocationCounts, NULL) != FR_ERROR_OUT_OF_HOST_MEMORY || computeDispatches.queued.size != FR_MAX_DISPATCHES_PER_FRAME)
+	{
+		FR_FATAL("frDispatchCompute test failed: a dispatch was queued past FR_MAX_DISPATCHES_PER_FRAME.");
+	}
+
+	// Test 10: retired resources in the bindless set and in new objects
+	vkUpdateDescriptorSets = updateTestDescriptorSets;
+	bindless.available = true;
+	bindless.capacities[0] = bindless.capacities[1] = bindless.capacities[2] = 4;
+	bindless.descriptorSets[0] = (VkDescriptorSet)(uintptr_t)14;
+	bindless.descriptorSets[1] = (VkDescriptorSet)(uintptr_t)15;
+	bindless.defaultStorageBuffer = (VkBuffer)(uintptr_t)16;
+	bindless.defaultImageView = (VkImageView)(uintptr_t)17;
+	VkDescriptorType testObjectDescriptorTypes[] = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER};
+	const FrPipeline testObjectPipeline = {
+		.descriptorTypes = testObjectDescriptorTypes,
+		.descriptorTypeCount = FR_LEN(testObjectDescriptorTypes)
+	};
+	if(
+		frPushBackTextureVector(&textures, testTexture) != FR_SUCCESS ||
+		frPushBackPipelineVector(&graphicsPipelines, testObjectPipeline) != FR_SUCCESS
+	)
+	{
+		FR_FATAL("Bindless retire test setup failed.");
+	}
+
+	// The descriptors stay until the frames using the resources are done, then point to the defaults
+	if(frRetireTexture(1) != FR_SUCCESS || frRetireStorageBuffer(1) != FR_SUCCESS)
+	{
+		FR_FATAL("Bindless retire test failed.");
+	}
+	bindlessWriteCount = 0;
+	frDestroyRetiredResources(frameCounter - 1);
+	if(bindlessWriteCount != 0)
+	{
+		FR_FATAL("frDestroyRetiredResources test failed: a bindless descriptor was written early.");
+	}
+	frDestroyRetiredResources(frameCounter);
+	if(bindlessWriteCount != framesInFlight)
+	{
+		FR_FATAL("frDestroyRetiredResources test failed: %"PRIu32" bindless descriptors written, expected %"PRIu32".", bindlessWriteCount, framesInFlight);
+	}
+	for(uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		if(
+			bindlessWrites[i].dstSet != bindless.descriptorSets[i] ||
+			bindlessWrites[i].dstBinding != 1 ||
+			bindlessWrites[i].dstArrayElement != 1 ||
+			bindlessBufferInfos[i].buffer != bindless.defaultStorageBuffer
+		)
+		{
+			FR_FATAL("frRetireStorageBuffer test failed: the bindless descriptor does not point to the default storage buffer.");
+		}
+	}
+
+	// The texture was written first, so check it alone
+	if(frRetireTexture(1) != FR_ERROR_INVALID_ARGUMENT)
+	{
+		FR_FATAL("frRetireTexture test failed: a texture was retired twice.");
+	}
+	frWriteBindlessDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
+	if(bindlessWriteCount != framesInFlight || bindlessWrites[0].dstBinding != 2 || bindlessImageInfos[0].imageView != bindless.defaultImageView)
+	{
+		FR_FATAL("frWriteBindlessDescriptor test failed: the retired texture does not point to the default texture.");
+	}
+
+	// Objects cannot bind a retired texture
+	if(frCreateObject(NULL, "assets/model_0.obj", 1, (uint32_t[]){1}) != FR_ERROR_INVALID_ARGUMENT)
+	{
+		FR_FATAL("frCreateObject test failed: a retired texture was bound.");
+	}
+	bindless.available = false;
+
+	// Test 11: storage images bound by frDispatchCompute
+	// Texture 2 can only be sampled, texture 3 is a storage texture
+	VkDescriptorType testStorageDescriptorTypes[] = {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER};
+	const FrComputePipeline testStoragePipeline = {
+		.descriptorTypes = testStorageDescriptorTypes,
+		.descriptorTypeCount = FR_LEN(testStorageDescriptorTypes),
+		.localSize = {8, 8, 1}
+	};
+	FrTexture testStorageTexture = testTexture;
+	testStorageTexture.storage = true;
+	computeDispatches.queued.size = 0;
+	if(
+		frPushBackComputePipelineVector(&computePipelines, testStoragePipeline) != FR_SUCCESS ||
+		frPushBackTextureVector(&textures, testTexture) != FR_SUCCESS ||
+		frPushBackTextureVector(&textures, testStorageTexture) != FR_SUCCESS
+	)
+	{
+		FR_FATAL("Storage image test setup failed.");
+	}
+
+	if(
+		frDispatchCompute(1, (uint32_t[]){2, 3}, testInvocationCounts, NULL) != FR_ERROR_INVALID_ARGUMENT ||
+		frDispatchCompute(1, (uint32_t[]){3, 3}, testInvocationCounts, NULL) != FR_ERROR_INVALID_ARGUMENT
+	)
+	{
+		FR_FATAL("frDispatchCompute test failed: an invalid storage image was bound.");
+	}
+	if(frDispatchCompute(1, (uint32_t[]){3, 2}, testInvocationCounts, NULL) != FR_SUCCESS || computeDispatches.queued.size != 1)
+	{
+		FR_FATAL("frDispatchCompute test failed: the storage image was not bound.");
+	}
+
 	return EXIT_SUCCESS;
 }